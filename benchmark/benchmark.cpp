@@ -0,0 +1,316 @@
+#include "benchmark.h"
+#include "primesearch.h"
+#include "primalitytester.h"
+#include "encryptionengine.h"
+#include "decryptionengine.h"
+#include "exponentiationcontext.h"
+#include "hybridengine.h"
+#include "multibuffermodexp.h"
+#include <gmpxx.h>
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+void Benchmark::primeGeneration(std::ostream &output, int sizeOfPrimes, int numberOfPrimes, int numberOfChecks, bool useLucasTest){
+/***********************************************************************
+* Generates numberOfPrimes primes on a single thread and writes one line to output
+* with the cost of each accepted prime: how many numbers went through the sieve,
+* how many reached the primality tester, and how many modular exponentiations
+* (Miller-Rabin checks) were needed.
+*
+* Arguments:
+* @ output: The stream the results are written to.
+* @ sizeOfPrimes: The size of the primes to generate in bits.
+* @ numberOfPrimes: The number of primes to generate.
+* @ numberOfChecks: The number of Miller-Rabin checks each candidate has to pass.
+* @ useLucasTest: Whether the candidates also have to pass a strong Lucas test.
+***********************************************************************/
+    PrimeSearch primeSearch(sizeOfPrimes, numberOfChecks, 1, useLucasTest);
+    mpz_t prime; mpz_init(prime);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numberOfPrimes; i++){
+        primeSearch.findPrime(prime);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    mpz_clear(prime);
+
+    primalityStatistics statistics = primeSearch.getStatistics();
+    double primes = static_cast<double>(numberOfPrimes);
+    output << std::fixed << std::setprecision(1)
+           << std::setw(6) << sizeOfPrimes
+           << std::setw(8) << numberOfChecks
+           << std::setw(7) << (useLucasTest ? "yes" : "no")
+           << std::setw(12) << primeSearch.getCandidatesSieved() / primes
+           << std::setw(12) << statistics.candidatesTested / primes
+           << std::setw(14) << statistics.modularExponentiations / primes
+           << std::setw(12) << elapsed.count() / primes
+           << std::endl;
+}
+
+void Benchmark::blockScaling(std::ostream &output, int sizeOfKey, int numberOfBlocks){
+/***********************************************************************
+* Encrypts and decrypts the same message with 1, 2, 4, ... threads up to the number
+* of cores, and writes one line per thread count with the time taken, the decryption
+* throughput and the speed up over a single thread.
+*
+* Arguments:
+* @ output: The stream the results are written to.
+* @ sizeOfKey: The size of the key to generate in bits.
+* @ numberOfBlocks: The number of blocks in the message.
+***********************************************************************/
+    mpz_t prime1; mpz_init(prime1);
+    mpz_t prime2; mpz_init(prime2);
+    mpz_t modulus; mpz_init(modulus);
+    mpz_t publicExponent; mpz_init_set_ui(publicExponent, 65537);
+    mpz_t privateExponent; mpz_init(privateExponent);
+    mpz_t exponent1; mpz_init(exponent1);
+    mpz_t exponent2; mpz_init(exponent2);
+    mpz_t coefficient; mpz_init(coefficient);
+    mpz_t phi; mpz_init(phi);
+    mpz_t temp; mpz_init(temp);
+
+    // Search until e is invertible, which is almost always the first pair.
+    int sizeOfPrimes = sizeOfKey / 2;
+    PrimeSearch primeSearch(sizeOfPrimes, PrimalityTester::getNumberOfChecks(sizeOfPrimes, true, false), 0, true);
+    do{
+        primeSearch.findPrimePair(prime1, prime2);
+        mpz_sub_ui(phi, prime1, 1);
+        mpz_sub_ui(temp, prime2, 1);
+        mpz_mul(phi, phi, temp);
+    } while(mpz_invert(privateExponent, publicExponent, phi) == 0);
+    mpz_mul(modulus, prime1, prime2);
+    mpz_sub_ui(temp, prime1, 1);
+    mpz_mod(exponent1, privateExponent, temp);
+    mpz_sub_ui(temp, prime2, 1);
+    mpz_mod(exponent2, privateExponent, temp);
+    mpz_invert(coefficient, prime2, prime1);
+
+    size_t blockSize = (mpz_sizeinbase(modulus, 2) + 7) / 8 - 1;
+    std::string plaintext(blockSize * numberOfBlocks, '\0');
+    std::mt19937 generator(12345);
+    for(size_t i = 0; i < plaintext.length(); i++){
+        plaintext[i] = static_cast<char>(generator() & 0xFF);
+    }
+
+    unsigned int numberOfCores = std::thread::hardware_concurrency();
+    numberOfCores = (numberOfCores == 0) ? 1 : numberOfCores;
+    std::vector<unsigned int> threadCounts;
+    for(unsigned int threads = 1; threads < numberOfCores; threads *= 2){
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(numberOfCores);
+
+    double singleThreadEncryption = 0;
+    double singleThreadDecryption = 0;
+    for(unsigned int i = 0; i < threadCounts.size(); i++){
+        EncryptionEngine encryptionEngine(modulus, publicExponent, threadCounts[i]);
+        DecryptionEngine decryptionEngine(modulus, privateExponent, prime1, prime2, exponent1, exponent2, coefficient, threadCounts[i]);
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::string ciphertext;
+        encryptionEngine.encryptBlocks(plaintext, blockSize, ciphertext);
+        std::chrono::duration<double, std::milli> encryptionTime = std::chrono::steady_clock::now() - startTime;
+
+        startTime = std::chrono::steady_clock::now();
+        std::string decrypted;
+        bool decryptedCorrectly = decryptionEngine.decryptFixedBlocks(ciphertext, 0, numberOfBlocks, blockSize, decrypted)
+                && decrypted == plaintext;
+        std::chrono::duration<double, std::milli> decryptionTime = std::chrono::steady_clock::now() - startTime;
+
+        if(i == 0){
+            singleThreadEncryption = encryptionTime.count();
+            singleThreadDecryption = decryptionTime.count();
+        }
+        output << std::fixed << std::setprecision(1)
+               << std::setw(6) << sizeOfKey
+               << std::setw(9) << threadCounts[i]
+               << std::setw(12) << encryptionTime.count()
+               << std::setw(9) << singleThreadEncryption / encryptionTime.count() << "x"
+               << std::setw(12) << decryptionTime.count()
+               << std::setw(9) << singleThreadDecryption / decryptionTime.count() << "x"
+               << std::setw(10) << std::setprecision(3) << plaintext.length() / (decryptionTime.count() * 1000.0)
+               << (decryptedCorrectly ? "" : "  MISMATCH")
+               << std::endl;
+    }
+
+    mpz_clear(prime1);
+    mpz_clear(prime2);
+    mpz_clear(modulus);
+    mpz_clear(publicExponent);
+    mpz_clear(privateExponent);
+    mpz_clear(exponent1);
+    mpz_clear(exponent2);
+    mpz_clear(coefficient);
+    mpz_clear(phi);
+    mpz_clear(temp);
+}
+
+void Benchmark::publicExponentiation(std::ostream &output, int sizeOfModulus, int numberOfExponentiations){
+/***********************************************************************
+* Raises the same random bases to the power of 65537 with mpz_powm and with an
+* ExponentiationContext, which takes the 16 squarings and one multiplication path,
+* and writes one line to output with the time per exponentiation of each.
+* The modulus only has to be odd, so a random one is used rather than making a key.
+*
+* Arguments:
+* @ output: The stream the results are written to.
+* @ sizeOfModulus: The size of the modulus in bits.
+* @ numberOfExponentiations: The number of bases each method is timed on.
+***********************************************************************/
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(12345);
+    mpz_class modulus = random.get_z_bits(sizeOfModulus);
+    mpz_setbit(modulus.get_mpz_t(), sizeOfModulus - 1);
+    mpz_setbit(modulus.get_mpz_t(), 0);
+    mpz_class publicExponent(static_cast<unsigned long>(ExponentiationContext::FERMAT_EXPONENT));
+    std::vector<mpz_class> bases(numberOfExponentiations);
+    for(int i = 0; i < numberOfExponentiations; i++){
+        bases[i] = random.get_z_range(modulus);
+    }
+    mpz_class powmResult;
+    mpz_class contextResult;
+    mpz_class checksum;
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numberOfExponentiations; i++){
+        mpz_powm(powmResult.get_mpz_t(), bases[i].get_mpz_t(), publicExponent.get_mpz_t(), modulus.get_mpz_t());
+        checksum += powmResult;
+    }
+    std::chrono::duration<double, std::micro> powmTime = std::chrono::steady_clock::now() - startTime;
+
+    ExponentiationContext context(modulus.get_mpz_t(), publicExponent.get_mpz_t());
+    std::vector<mp_limb_t> scratch(context.getScratchSize());
+    startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numberOfExponentiations; i++){
+        context.exponentiate(contextResult.get_mpz_t(), bases[i].get_mpz_t(), scratch);
+        checksum -= contextResult;
+    }
+    std::chrono::duration<double, std::micro> contextTime = std::chrono::steady_clock::now() - startTime;
+
+    double exponentiations = static_cast<double>(numberOfExponentiations);
+    output << std::fixed << std::setprecision(2)
+           << std::setw(6) << sizeOfModulus
+           << std::setw(13) << powmTime.count() / exponentiations
+           << std::setw(13) << contextTime.count() / exponentiations
+           << std::setw(9) << powmTime.count() / contextTime.count() << "x"
+           << (checksum == 0 ? "" : "  MISMATCH")
+           << std::endl;
+}
+
+void Benchmark::multiBufferThroughput(std::ostream &output, int sizeOfModulus, int numberOfExponentiations){
+/***********************************************************************
+* Raises the same random bases to the power of a random full size exponent (like d, dP
+* or dQ) one at a time with mpz_powm, and MultiBufferModExp::LANES at a time with
+* MultiBufferModExp, and writes one line to output with the number of exponentiations
+* per second of each.
+*
+* Arguments:
+* @ output: The stream the results are written to.
+* @ sizeOfModulus: The size of the modulus in bits.
+* @ numberOfExponentiations: The number of bases each method is timed on, a multiple of MultiBufferModExp::LANES.
+***********************************************************************/
+    output << std::fixed << std::setprecision(1) << std::setw(6) << sizeOfModulus;
+    if(MultiBufferModExp::isSupported() == false){
+        output << "  not supported by this processor (needs AVX-512 IFMA)" << std::endl;
+        return;
+    }
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(12345);
+    mpz_class modulus = random.get_z_bits(sizeOfModulus);
+    mpz_setbit(modulus.get_mpz_t(), sizeOfModulus - 1);
+    mpz_setbit(modulus.get_mpz_t(), 0);
+    mpz_class exponent = random.get_z_bits(sizeOfModulus);
+    std::vector<mpz_class> bases(numberOfExponentiations);
+    std::vector<mpz_class> results(numberOfExponentiations);
+    std::vector<mpz_srcptr> basePointers(numberOfExponentiations);
+    std::vector<mpz_ptr> resultPointers(numberOfExponentiations);
+    for(int i = 0; i < numberOfExponentiations; i++){
+        bases[i] = random.get_z_range(modulus);
+        basePointers[i] = bases[i].get_mpz_t();
+        resultPointers[i] = results[i].get_mpz_t();
+    }
+    mpz_class powmResult;
+    mpz_class checksum;
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numberOfExponentiations; i++){
+        mpz_powm(powmResult.get_mpz_t(), bases[i].get_mpz_t(), exponent.get_mpz_t(), modulus.get_mpz_t());
+        checksum += powmResult;
+    }
+    std::chrono::duration<double> powmTime = std::chrono::steady_clock::now() - startTime;
+
+    MultiBufferModExp multiBuffer;
+    multiBuffer.setModulus(modulus.get_mpz_t());
+    std::vector<mp_limb_t> scratch(multiBuffer.getScratchSize(exponent.get_mpz_t()));
+    startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numberOfExponentiations; i += MultiBufferModExp::LANES){
+        multiBuffer.exponentiate(&resultPointers[i], &basePointers[i], MultiBufferModExp::LANES, exponent.get_mpz_t(), scratch);
+    }
+    std::chrono::duration<double> multiBufferTime = std::chrono::steady_clock::now() - startTime;
+    for(int i = 0; i < numberOfExponentiations; i++){
+        checksum -= results[i];
+    }
+
+    output << std::setw(13) << numberOfExponentiations / powmTime.count()
+           << std::setw(13) << numberOfExponentiations / multiBufferTime.count()
+           << std::setw(9) << std::setprecision(2) << powmTime.count() / multiBufferTime.count() << "x"
+           << (checksum == 0 ? "" : "  MISMATCH")
+           << std::endl;
+}
+
+void Benchmark::hybridThroughput(std::ostream &output, unsigned int cipher, int sizeOfPayload){
+/***********************************************************************
+* Encrypts and decrypts a payload with the HybridEngine, using 1, 2, 4, ... threads up to
+* the number of cores, and writes one line per thread count with the throughput. The RSA
+* step of the hybrid mode is a single block per file, so it is left out.
+*
+* Arguments:
+* @ output: The stream the results are written to.
+* @ cipher: HybridEngine::AES_GCM or HybridEngine::CHACHA20_POLY1305.
+* @ sizeOfPayload: The size of the payload in MiB.
+***********************************************************************/
+    std::string plaintext(static_cast<size_t>(sizeOfPayload) << 20, '\0');
+    std::mt19937 generator(12345);
+    for(size_t i = 0; i < plaintext.length(); i++){
+        plaintext[i] = static_cast<char>(generator() & 0xFF);
+    }
+    std::string sharedSecret(255, '\x5A');
+    std::string associatedData(32, '\0');
+
+    unsigned int numberOfCores = std::thread::hardware_concurrency();
+    numberOfCores = (numberOfCores == 0) ? 1 : numberOfCores;
+    std::vector<unsigned int> threadCounts;
+    for(unsigned int threads = 1; threads < numberOfCores; threads *= 2){
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(numberOfCores);
+
+    for(unsigned int i = 0; i < threadCounts.size(); i++){
+        HybridEngine hybridEngine(cipher, sharedSecret, associatedData, HybridEngine::CHUNK_SIZE, threadCounts[i]);
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::string ciphertext;
+        hybridEngine.encryptChunks(plaintext, 0, true, ciphertext);
+        std::chrono::duration<double> encryptionTime = std::chrono::steady_clock::now() - startTime;
+
+        startTime = std::chrono::steady_clock::now();
+        std::string decrypted;
+        bool decryptedCorrectly = hybridEngine.decryptChunks(ciphertext, 0, ciphertext.length(), 0, true, decrypted)
+                && decrypted == plaintext;
+        std::chrono::duration<double> decryptionTime = std::chrono::steady_clock::now() - startTime;
+
+        output << std::fixed << std::setprecision(1)
+               << std::setw(19) << (cipher == HybridEngine::AES_GCM ? "AES-256-GCM" : "ChaCha20-Poly1305")
+               << std::setw(9) << threadCounts[i]
+               << std::setw(12) << sizeOfPayload / encryptionTime.count()
+               << std::setw(12) << sizeOfPayload / decryptionTime.count()
+               << (decryptedCorrectly ? "" : "  MISMATCH")
+               << std::endl;
+    }
+}
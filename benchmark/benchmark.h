@@ -0,0 +1,16 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <ostream>
+
+class Benchmark
+{
+public:
+    static void primeGeneration(std::ostream &output, int sizeOfPrimes, int numberOfPrimes, int numberOfChecks, bool useLucasTest);
+    static void blockScaling(std::ostream &output, int sizeOfKey, int numberOfBlocks);
+    static void publicExponentiation(std::ostream &output, int sizeOfModulus, int numberOfExponentiations);
+    static void multiBufferThroughput(std::ostream &output, int sizeOfModulus, int numberOfExponentiations);
+    static void hybridThroughput(std::ostream &output, unsigned int cipher, int sizeOfPayload);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,57 @@
+#include "benchmark.h"
+#include "primalitytester.h"
+#include "hybridengine.h"
+
+#include <iostream>
+
+int main(){
+/***********************************************************************
+* Runs the prime generation benchmark for each prime size used by the key
+* sizes in the key generation window. Each size is run with the old fixed
+* 20 Miller-Rabin rounds, and with the key size schedule (with and without
+* the Lucas test).
+* Then the block encryption and decryption engines are run with an increasing
+* number of threads, to show how they scale with the number of cores, followed by
+* the e = 65537 public key operation and the AVX-512 IFMA multi-buffer kernel
+* against mpz_powm, and the symmetric ciphers the hybrid mode encrypts the payload with.
+***********************************************************************/
+    int primeSizes[] = {256, 512, 1024, 2048};
+    int primesPerSize[] = {50, 20, 10, 4};
+
+    std::cout << "Prime generation, per accepted prime:" << std::endl;
+    std::cout << "  bits  rounds  lucas      sieved      tested       modexps          ms" << std::endl;
+    for(int i = 0; i < 4; i++){
+        Benchmark::primeGeneration(std::cout, primeSizes[i], primesPerSize[i], 20, false);
+        Benchmark::primeGeneration(std::cout, primeSizes[i], primesPerSize[i], PrimalityTester::getNumberOfChecks(primeSizes[i], false, false), false);
+        Benchmark::primeGeneration(std::cout, primeSizes[i], primesPerSize[i], PrimalityTester::getNumberOfChecks(primeSizes[i], true, false), true);
+    }
+
+    int keySizes[] = {1024, 2048, 4096};
+    int blocksPerSize[] = {2000, 1000, 200};
+    std::cout << std::endl << "Block encryption / decryption scaling:" << std::endl;
+    std::cout << "  bits  threads  encrypt ms  speedup  decrypt ms  speedup  dec MB/s" << std::endl;
+    for(int i = 0; i < 3; i++){
+        Benchmark::blockScaling(std::cout, keySizes[i], blocksPerSize[i]);
+    }
+
+    int exponentiationsPerSize[] = {20000, 10000, 2000};
+    std::cout << std::endl << "Public key operation (e = 65537), per exponentiation:" << std::endl;
+    std::cout << "  bits  mpz_powm us   context us  speedup" << std::endl;
+    for(int i = 0; i < 3; i++){
+        Benchmark::publicExponentiation(std::cout, keySizes[i], exponentiationsPerSize[i]);
+    }
+
+    int multiBufferSizes[] = {1024, 2048, 4096};
+    int multiBufferExponentiations[] = {800, 160, 24};
+    std::cout << std::endl << "Multi-buffer kernel, full size exponent, exponentiations per second:" << std::endl;
+    std::cout << "  bits     mpz_powm   multi-buffer  speedup" << std::endl;
+    for(int i = 0; i < 3; i++){
+        Benchmark::multiBufferThroughput(std::cout, multiBufferSizes[i], multiBufferExponentiations[i]);
+    }
+
+    std::cout << std::endl << "Hybrid payload encryption / decryption, 256 MiB:" << std::endl;
+    std::cout << "             cipher  threads  enc MiB/s   dec MiB/s" << std::endl;
+    Benchmark::hybridThroughput(std::cout, HybridEngine::AES_GCM, 256);
+    Benchmark::hybridThroughput(std::cout, HybridEngine::CHACHA20_POLY1305, 256);
+    return 0;
+}
@@ -0,0 +1,764 @@
+#include "commandline.h"
+#include "keyfile.h"
+#include "keygenerator.h"
+#include "fileencryptor.h"
+#include "filedecryptor.h"
+#include "workscheduler.h"
+#include <gmpxx.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const std::string MODE_NAMES[] = {"aes-gcm", "chacha20-poly1305", "rsa-blocks"}; // The --mode names, indexed by FileEncryptor mode.
+static const int NUMBER_OF_MODES = 3; // The number of entries in MODE_NAMES.
+static const int MINIMUM_SIZE_OF_KEY = 128; // The smallest key size, the same as the key generation window.
+static const int RSA_BLOCKS_PAYLOAD_DIVISOR = 64; // bench encrypts this many times less data with RSA blocks, which is far slower.
+static const double BYTES_PER_MIB = 1024.0 * 1024.0; // The number of bytes in a MiB.
+static const size_t SPOOL_CHUNK_SIZE = 1 << 20; // The number of bytes of stdin copied to the spool file at a time.
+
+int CommandLine::run(const std::vector<std::string> &arguments){
+/***********************************************************************
+* Runs one command, which is the first argument, with the options after it:
+* - keygen: Generates keypairs into a folder.
+* - encrypt: Encrypts files (or stdin) for a public key.
+* - decrypt: Decrypts files (or stdin) with a private key.
+* - bench: Times key generation, and encryption and decryption in every mode.
+* The engines and streams are the same ones the GUI uses, from rsacore.
+*
+* Arguments:
+* @ arguments: The command line arguments, without the name of the program.
+*
+* Returns:
+* @ exitCode: 0 if everything succeeded, 1 if a key or file failed, 2 if the arguments are not valid.
+***********************************************************************/
+    commandOptions options;
+    std::string error;
+    if(CommandLine::parseArguments(arguments, options, error) == false){
+        std::cerr << "rsacli: " << error << std::endl << std::endl;
+        CommandLine::printUsage(std::cerr);
+        return 2;
+    }
+    if(options.command == "keygen"){
+        return CommandLine::generateKeys(options);
+    }
+    if(options.command == "encrypt"){
+        return CommandLine::encryptFiles(options);
+    }
+    if(options.command == "decrypt"){
+        return CommandLine::decryptFiles(options);
+    }
+    if(options.command == "bench"){
+        return CommandLine::benchmark(options);
+    }
+    CommandLine::printUsage(std::cout);
+    return 0;
+}
+
+bool CommandLine::parseArguments(const std::vector<std::string> &arguments, commandOptions &options, std::string &error){
+/***********************************************************************
+* Reads the command and its options into a commandOptions structure. Every argument
+* which does not start with "--" is an input file, "-" stands for stdin and stdout.
+*
+* Arguments:
+* @ arguments: The command line arguments, without the name of the program.
+* @ options: The structure the command and options are written to.
+* @ error: Set to a description of the problem if the arguments are not valid.
+*
+* Returns:
+*  True: If the arguments are valid.
+*  False: If they are not.
+***********************************************************************/
+    if(arguments.empty() == true){
+        error = "no command given";
+        return false;
+    }
+    options.command = arguments[0];
+    if(options.command == "help" || options.command == "--help" || options.command == "-h"){
+        options.command = "help";
+        return true;
+    }
+    if(options.command != "keygen" && options.command != "encrypt" && options.command != "decrypt" && options.command != "bench"){
+        error = "unknown command \"" + options.command + "\"";
+        return false;
+    }
+
+    for(size_t i = 1; i < arguments.size(); i++){
+        const std::string &argument = arguments[i];
+        if(argument.compare(0, 2, "--") != 0){
+            options.inputFilepaths.push_back(argument);
+            continue;
+        }
+        if(argument == "--armour"){
+            options.armoured = true;
+            continue;
+        }
+        if(argument == "--paranoid"){
+            options.paranoidChecks = true;
+            continue;
+        }
+        if(argument == "--fingerprint-names"){
+            options.fingerprintNames = true;
+            continue;
+        }
+        if(argument == "--force"){
+            options.overwrite = true;
+            continue;
+        }
+        if(i + 1 >= arguments.size()){
+            error = argument + " needs a value";
+            return false;
+        }
+        const std::string &value = arguments[++i];
+        int number = 0;
+        if(argument == "--key"){
+            options.keyFilepath = value;
+        }
+        else if(argument == "--output"){
+            options.outputFolder = value;
+        }
+        else if(argument == "--mode"){
+            options.encryptionMode = -1;
+            for(int mode = 0; mode < NUMBER_OF_MODES; mode++){
+                if(value == MODE_NAMES[mode]){
+                    options.encryptionMode = mode;
+                }
+            }
+            if(options.encryptionMode == -1){
+                error = "unknown mode \"" + value + "\"";
+                return false;
+            }
+        }
+        else if(argument == "--bits" && CommandLine::parseNumber(value, MINIMUM_SIZE_OF_KEY, number) == true){
+            options.sizeOfKey = number;
+        }
+        else if(argument == "--count" && CommandLine::parseNumber(value, 1, number) == true){
+            options.numberOfKeys = number;
+        }
+        else if(argument == "--jobs" && CommandLine::parseNumber(value, 1, number) == true){
+            options.numberOfJobs = static_cast<unsigned int>(number);
+        }
+        else if(argument == "--size" && CommandLine::parseNumber(value, 1, number) == true){
+            options.sizeOfPayload = number;
+        }
+        else{
+            error = "not a valid option: " + argument + " " + value;
+            return false;
+        }
+    }
+
+    if((options.command == "encrypt" || options.command == "decrypt") && options.keyFilepath.empty() == true){
+        error = options.command + " needs a --key";
+        return false;
+    }
+    if(options.inputFilepaths.size() > 1 && std::find(options.inputFilepaths.begin(), options.inputFilepaths.end(), "-") != options.inputFilepaths.end()){
+        error = "\"-\" (stdin) cannot be mixed with other files";
+        return false;
+    }
+    return true;
+}
+
+bool CommandLine::parseNumber(const std::string &text, int minimum, int &value){
+/***********************************************************************
+* Arguments:
+* @ text: The text of the number.
+* @ minimum: The smallest value which is allowed.
+* @ value: Set to the number if it is valid.
+*
+* Returns:
+*  True: If the text is a whole number of at least minimum.
+*  False: If it is not.
+***********************************************************************/
+    if(text.empty() == true || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos){
+        return false;
+    }
+    value = std::stoi(text);
+    return value >= minimum;
+}
+
+int CommandLine::generateKeys(const commandOptions &options){
+/***********************************************************************
+* Generates options.numberOfKeys keypairs into options.outputFolder (the current folder by default).
+* A single keypair is searched for on every core and saved as PublicKey.pem and PrivateKey.pem,
+* a batch is generated a key per core with KeyGenerator::generateKeyBatch() and named by number
+* or fingerprint, the same as the batch mode of the key generation window.
+* Key files which already exist are never written over unless --force is given, and the
+* names which are known up front are checked before any keys are generated.
+*
+* Arguments:
+* @ options: The command line options.
+*
+* Returns:
+* @ exitCode: 0 if every key has been saved, 1 if not.
+***********************************************************************/
+    keyGenerationConfig config;
+    config.sizeOfKey = options.sizeOfKey;
+    config.paranoidChecks = options.paranoidChecks;
+    KeyGenerator keyGenerator(config);
+    std::string outputFolder = options.outputFolder.empty() ? "." : options.outputFolder;
+    if(options.overwrite == false){
+        std::string existingFilepath = KeyFile::findExistingBatchKeyFile(outputFolder, options.numberOfKeys, options.fingerprintNames);
+        if(existingFilepath.empty() == false){
+            std::cerr << "rsacli: " << existingFilepath << " already exists (use --force to overwrite it)" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<privateKey> privateKeyStructs(options.numberOfKeys);
+    for(int i = 0; i < options.numberOfKeys; i++){
+        privateKeyStructs[i] = KeyFile::initializePrivateKey();
+    }
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    unsigned int numberOfThreads = 0;
+    if(options.numberOfKeys == 1){
+        keyGenerator.generatePrivateKey(&privateKeyStructs[0]);
+    }
+    else{
+        numberOfThreads = keyGenerator.generateKeyBatch(privateKeyStructs, options.numberOfJobs);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    int failures = 0;
+    for(int i = 0; i < options.numberOfKeys; i++){
+        publicKey publicKeyStruct = KeyFile::initializePublicKey();
+        KeyFile::getPublicKey(&publicKeyStruct, &privateKeyStructs[i]);
+        std::string keyName = "";
+        if(options.numberOfKeys > 1){
+            keyName = "_" + KeyFile::batchKeyName(&publicKeyStruct, i + 1, options.numberOfKeys, options.fingerprintNames);
+        }
+        std::string publicKeyFilepath = outputFolder + "/PublicKey" + keyName + ".pem";
+        std::string privateKeyFilepath = outputFolder + "/PrivateKey" + keyName + ".pem";
+        std::string existingFilepath = (options.overwrite == true) ? "" : KeyFile::findExistingKeyFile(outputFolder, keyName);
+        if(existingFilepath.empty() == false){
+            std::cerr << "rsacli: " << existingFilepath << " already exists (use --force to overwrite it)" << std::endl;
+            failures++;
+        }
+        else if(KeyFile::savePublicKey(publicKeyFilepath, &publicKeyStruct) == true
+                && KeyFile::savePrivateKey(privateKeyFilepath, &privateKeyStructs[i]) == true){
+            std::cout << publicKeyFilepath << "  " << privateKeyFilepath << std::endl;
+        }
+        else{
+            std::cerr << "rsacli: could not write " << publicKeyFilepath << " or " << privateKeyFilepath << std::endl;
+            failures++;
+        }
+        KeyFile::clearPublicKey(&publicKeyStruct);
+        KeyFile::clearPrivateKey(&privateKeyStructs[i]);
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << options.numberOfKeys << " x " << options.sizeOfKey
+              << " bit keypairs in " << elapsed.count() << " s (" << options.numberOfKeys * 60.0 / elapsed.count()
+              << " keys per minute";
+    if(numberOfThreads != 0){
+        std::cout << " on " << numberOfThreads << " threads";
+    }
+    std::cout << ")" << std::endl << keyGenerator.describePrimeChecks() << std::endl;
+    return (failures == 0) ? 0 : 1;
+}
+
+int CommandLine::encryptFiles(const commandOptions &options){
+/***********************************************************************
+* Loads the public key and encrypts every input file, or stdin to stdout if there are none.
+*
+* Arguments:
+* @ options: The command line options.
+*
+* Returns:
+* @ exitCode: 0 if every file has been encrypted, 1 if not.
+***********************************************************************/
+    publicKey publicKeyStruct = KeyFile::initializePublicKey();
+    int exitCode = 1;
+    if(KeyFile::loadPublicKey(options.keyFilepath, &publicKeyStruct) == false){
+        std::cerr << "rsacli: could not read the public key " << options.keyFilepath << std::endl;
+    }
+    else if(options.inputFilepaths.empty() == true || options.inputFilepaths[0] == "-"){
+        exitCode = CommandLine::processStandardStreams(options, &publicKeyStruct, nullptr);
+    }
+    else{
+        exitCode = CommandLine::runFileJobs(options, &publicKeyStruct, nullptr);
+    }
+    KeyFile::clearPublicKey(&publicKeyStruct);
+    return exitCode;
+}
+
+int CommandLine::decryptFiles(const commandOptions &options){
+/***********************************************************************
+* Loads the private key and decrypts every input file, or stdin to stdout if there are none.
+*
+* Arguments:
+* @ options: The command line options.
+*
+* Returns:
+* @ exitCode: 0 if every file has been decrypted, 1 if not.
+***********************************************************************/
+    privateKey privateKeyStruct = KeyFile::initializePrivateKey();
+    int exitCode = 1;
+    if(KeyFile::loadPrivateKey(options.keyFilepath, &privateKeyStruct) == false){
+        std::cerr << "rsacli: could not read the private key " << options.keyFilepath << std::endl;
+    }
+    else if(options.inputFilepaths.empty() == true || options.inputFilepaths[0] == "-"){
+        exitCode = CommandLine::processStandardStreams(options, nullptr, &privateKeyStruct);
+    }
+    else{
+        exitCode = CommandLine::runFileJobs(options, nullptr, &privateKeyStruct);
+    }
+    KeyFile::clearPrivateKey(&privateKeyStruct);
+    return exitCode;
+}
+
+int CommandLine::runFileJobs(const commandOptions &options, const publicKey* publicKeyStruct, const privateKey* privateKeyStruct){
+/***********************************************************************
+* Encrypts (if publicKeyStruct is given) or decrypts every input file, several at once.
+* options.numberOfJobs worker threads (by default one per core, but no more than there are files)
+* each take the next file which hasn't been started yet. The blocks of every file being worked
+* on are shared out on one WorkScheduler, so a core which has nothing left to do on one file
+* helps with another's, and a big file gets every core once the small files around it are done.
+* A line with the time taken is written for each file as soon as it has finished, and a total at the end.
+* If two inputs would be written to the same output file, no file is processed.
+*
+* Arguments:
+* @ options: The command line options.
+* @ publicKeyStruct: The public key to encrypt with, or nullptr to decrypt.
+* @ privateKeyStruct: The private key to decrypt with, or nullptr to encrypt.
+*
+* Returns:
+* @ exitCode: 0 if every file has been processed, 1 if not.
+***********************************************************************/
+    // --output keeps only the file names, so two inputs can have the same output. Both would be
+    // written at once, so the batch is refused before any file is started.
+    std::map<std::string, std::string> outputInputs;
+    for(unsigned int i = 0; i < options.inputFilepaths.size(); i++){
+        std::string outputFilepath = CommandLine::getOutputFilepath(options.inputFilepaths[i], options);
+        std::map<std::string, std::string>::iterator existing = outputInputs.find(outputFilepath);
+        if(existing != outputInputs.end()){
+            std::cerr << "rsacli: " << existing->second << " and " << options.inputFilepaths[i]
+                      << " would both be written to " << outputFilepath << std::endl;
+            return 1;
+        }
+        outputInputs[outputFilepath] = options.inputFilepaths[i];
+    }
+
+    unsigned int numberOfFiles = static_cast<unsigned int>(options.inputFilepaths.size());
+    unsigned int numberOfCores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int numberOfJobs = options.numberOfJobs;
+    if(numberOfJobs == 0){
+        numberOfJobs = numberOfCores;
+    }
+    numberOfJobs = std::min(numberOfJobs, numberOfFiles);
+    WorkScheduler scheduler(numberOfCores);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::atomic<unsigned int> nextFile(0);
+    std::atomic<unsigned long long> totalBytes(0);
+    std::atomic<unsigned int> failures(0);
+    std::mutex outputMutex;
+    std::vector<std::thread> workers;
+    for(unsigned int i = 0; i < numberOfJobs; i++){
+        workers.emplace_back([&](){
+            for(unsigned int fileIndex = nextFile++; fileIndex < numberOfFiles; fileIndex = nextFile++){
+                const std::string &inputFilepath = options.inputFilepaths[fileIndex];
+                fileResult result = CommandLine::processFile(inputFilepath, options, &scheduler, publicKeyStruct, privateKeyStruct);
+                if(result.succeeded == true){
+                    totalBytes += result.inputSize;
+                }
+                else{
+                    failures++;
+                }
+                std::lock_guard<std::mutex> lock(outputMutex);
+                CommandLine::writeResult(std::cout, inputFilepath, result);
+            }
+        });
+    }
+    for(unsigned int i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    fileResult total;
+    total.succeeded = (failures == 0);
+    total.inputSize = totalBytes;
+    total.seconds = elapsed.count();
+    total.message = std::to_string(numberOfFiles - failures) + " of " + std::to_string(numberOfFiles) + " files, "
+            + std::to_string(numberOfJobs) + " at once";
+    CommandLine::writeResult(std::cout, "total", total);
+    return (failures == 0) ? 0 : 1;
+}
+
+fileResult CommandLine::processFile(const std::string &inputFilepath, const commandOptions &options, WorkScheduler *scheduler,
+                                    const publicKey* publicKeyStruct, const privateKey* privateKeyStruct){
+/***********************************************************************
+* Encrypts or decrypts one file, with its own FileEncryptor or FileDecryptor so that several
+* files can be worked on at the same time.
+*
+* Arguments:
+* @ inputFilepath: The file to encrypt or decrypt.
+* @ options: The command line options.
+* @ scheduler: The WorkScheduler the blocks of every file are shared out on.
+* @ publicKeyStruct: The public key to encrypt with, or nullptr to decrypt.
+* @ privateKeyStruct: The private key to decrypt with, or nullptr to encrypt.
+*
+* Returns:
+* @ result: Whether the file succeeded, its size, the time it took and where the output went (or why it failed).
+***********************************************************************/
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    fileResult result;
+    result.succeeded = false;
+    result.inputSize = 0;
+    result.seconds = 0;
+
+    std::ifstream inputFileStream(inputFilepath, std::ios::binary | std::ios::ate);
+    if(inputFileStream.is_open() == false){
+        result.message = "could not be read";
+        return result;
+    }
+    result.inputSize = static_cast<unsigned long long>(inputFileStream.tellg());
+    inputFileStream.close();
+    std::string outputFilepath = CommandLine::getOutputFilepath(inputFilepath, options);
+    if(options.overwrite == false && CommandLine::createOutputFile(outputFilepath) == false){
+        result.message = (errno == EEXIST) ? outputFilepath + " already exists (use --force to overwrite it)" : outputFilepath + " could not be created";
+        return result;
+    }
+
+    if(publicKeyStruct != nullptr){
+        encryptionConfig config;
+        config.encryptionMode = options.encryptionMode;
+        config.armoured = options.armoured;
+        config.scheduler = scheduler;
+        FileEncryptor fileEncryptor(publicKeyStruct, config);
+        result.succeeded = fileEncryptor.encryptFile(inputFilepath, outputFilepath);
+        result.message = result.succeeded ? outputFilepath : "could not be encrypted to " + outputFilepath;
+    }
+    else{
+        FileDecryptor fileDecryptor(privateKeyStruct, 0, nullptr, scheduler);
+        result.succeeded = fileDecryptor.decryptFile(inputFilepath, outputFilepath);
+        if(result.succeeded == true){
+            result.message = outputFilepath;
+        }
+        else if(fileDecryptor.couldNotReadInput() == true){
+            result.message = "could not be read";
+        }
+        else if(fileDecryptor.wasEncryptedForDifferentKey() == true){
+            result.message = "was encrypted for a different key";
+        }
+        else{
+            result.message = "was not encrypted with this key, has been damaged, or " + outputFilepath + " could not be written";
+        }
+    }
+    if(result.succeeded == false && options.overwrite == false){
+        std::remove(outputFilepath.c_str());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+int CommandLine::processStandardStreams(const commandOptions &options, const publicKey* publicKeyStruct, const privateKey* privateKeyStruct){
+/***********************************************************************
+* Encrypts or decrypts stdin to stdout, the timing is written to stderr.
+* Decryption streams a chunk at a time. The container header records the length of the
+* plaintext, so stdin is first copied to a spool file (see spoolStandardInput()) and then
+* encrypted from there, which keeps the memory used the same whatever the size of the input.
+*
+* Arguments:
+* @ options: The command line options.
+* @ publicKeyStruct: The public key to encrypt with, or nullptr to decrypt.
+* @ privateKeyStruct: The private key to decrypt with, or nullptr to encrypt.
+*
+* Returns:
+* @ exitCode: 0 if all of stdin has been processed, 1 if not.
+***********************************************************************/
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    fileResult result;
+    if(publicKeyStruct != nullptr){
+        std::string spoolFilepath;
+        result.inputSize = 0;
+        result.succeeded = CommandLine::spoolStandardInput(spoolFilepath, result.inputSize);
+        result.message = "could not be copied to a temporary file";
+        if(result.succeeded == true){
+            std::ifstream plaintextStream(spoolFilepath, std::ios::binary);
+            encryptionConfig config;
+            config.encryptionMode = options.encryptionMode;
+            config.armoured = options.armoured;
+            FileEncryptor fileEncryptor(publicKeyStruct, config);
+            result.succeeded = plaintextStream.is_open() && fileEncryptor.encrypt(plaintextStream, result.inputSize, std::cout);
+            result.message = result.succeeded ? "encrypted to stdout" : "could not be encrypted";
+        }
+        if(spoolFilepath.empty() == false){
+            std::remove(spoolFilepath.c_str());
+        }
+    }
+    else{
+        FileDecryptor fileDecryptor(privateKeyStruct);
+        result.inputSize = 0;
+        result.succeeded = fileDecryptor.decrypt(std::cin, std::cout);
+        if(result.succeeded == true){
+            result.message = "decrypted to stdout";
+        }
+        else if(fileDecryptor.wasEncryptedForDifferentKey() == true){
+            result.message = "was encrypted for a different key";
+        }
+        else{
+            result.message = "was not encrypted with this key, or has been damaged";
+        }
+    }
+    std::cout.flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.seconds = elapsed.count();
+    CommandLine::writeResult(std::cerr, "stdin", result);
+    return (result.succeeded == true) ? 0 : 1;
+}
+
+bool CommandLine::spoolStandardInput(std::string &spoolFilepath, unsigned long long &inputSize){
+/***********************************************************************
+* Copies stdin, SPOOL_CHUNK_SIZE bytes at a time, into a new file in the temporary folder
+* which only the current user can read or write. The file is created with those permissions,
+* and fails if the name is already taken, so the plaintext is never readable by anyone else.
+*
+* Arguments:
+* @ spoolFilepath: Set to the path of the spool file, or "" if it could not be created.
+*                  The caller removes the file once it is done with it.
+* @ inputSize: Set to the number of bytes copied.
+*
+* Returns:
+*  True: If all of stdin has been copied to the spool file.
+*  False: If the file could not be created or written, or stdin could not be read.
+***********************************************************************/
+    spoolFilepath = "";
+    inputSize = 0;
+#ifdef _WIN32
+    char temporaryFolder[MAX_PATH + 1];
+    char temporaryFilepath[MAX_PATH + 1];
+    // GetTempFileNameA creates the file, which is under the user's own temporary folder.
+    if(GetTempPathA(MAX_PATH + 1, temporaryFolder) == 0 || GetTempFileNameA(temporaryFolder, "rsa", 0, temporaryFilepath) == 0){
+        return false;
+    }
+    spoolFilepath = temporaryFilepath;
+    int descriptor = _open(temporaryFilepath, _O_WRONLY | _O_TRUNC | _O_BINARY);
+#else
+    const char *temporaryFolder = std::getenv("TMPDIR");
+    std::string spoolTemplate = std::string((temporaryFolder != nullptr && temporaryFolder[0] != '\0') ? temporaryFolder : "/tmp") + "/rsacli-XXXXXX";
+    std::vector<char> temporaryFilepath(spoolTemplate.begin(), spoolTemplate.end());
+    temporaryFilepath.push_back('\0');
+    // mkstemp creates the file with O_EXCL and only the user's read and write permissions.
+    int descriptor = mkstemp(temporaryFilepath.data());
+    if(descriptor >= 0){
+        spoolFilepath = temporaryFilepath.data();
+    }
+#endif
+    if(descriptor < 0){
+        return false;
+    }
+
+    std::vector<char> chunk(SPOOL_CHUNK_SIZE);
+    bool succeeded = true;
+    while(succeeded == true && std::cin.read(chunk.data(), chunk.size()).gcount() > 0){
+        size_t chunkSize = static_cast<size_t>(std::cin.gcount());
+        size_t written = 0;
+        while(succeeded == true && written < chunkSize){
+#ifdef _WIN32
+            int result = _write(descriptor, chunk.data() + written, static_cast<unsigned int>(chunkSize - written));
+#else
+            ssize_t result = write(descriptor, chunk.data() + written, chunkSize - written);
+#endif
+            succeeded = (result > 0);
+            if(succeeded == true){
+                written += static_cast<size_t>(result);
+            }
+        }
+        inputSize += written;
+    }
+    succeeded = succeeded && std::cin.bad() == false;
+#ifdef _WIN32
+    succeeded = (_close(descriptor) == 0) && succeeded;
+#else
+    succeeded = (close(descriptor) == 0) && succeeded;
+#endif
+    return succeeded;
+}
+
+bool CommandLine::createOutputFile(const std::string &outputFilepath){
+/***********************************************************************
+* Creates an empty output file, failing if a file of that name already exists. The check and
+* the creation are one step, so a file made by another job or program in between is never
+* written over. FileEncryptor or FileDecryptor then write the output into the new file.
+*
+* Arguments:
+* @ outputFilepath: The filepath of the output file.
+*
+* Returns:
+*  True: If the file has been created.
+*  False: If it could not be, errno is EEXIST if the file already exists.
+***********************************************************************/
+#ifdef _WIN32
+    int descriptor = _open(outputFilepath.c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+    return descriptor >= 0 && _close(descriptor) == 0;
+#else
+    int descriptor = open(outputFilepath.c_str(), O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+    return descriptor >= 0 && close(descriptor) == 0;
+#endif
+}
+
+int CommandLine::benchmark(const commandOptions &options){
+/***********************************************************************
+* Generates a key of options.sizeOfKey bits, then encrypts and decrypts random data in memory
+* in every mode and checks it comes back the same. The hybrid modes use options.sizeOfPayload MiB,
+* RSA blocks RSA_BLOCKS_PAYLOAD_DIVISOR times less as every block is an RSA operation.
+*
+* Arguments:
+* @ options: The command line options.
+*
+* Returns:
+* @ exitCode: 0 if every mode decrypted its data correctly, 1 if not.
+***********************************************************************/
+    keyGenerationConfig config;
+    config.sizeOfKey = options.sizeOfKey;
+    KeyGenerator keyGenerator(config);
+    privateKey privateKeyStruct = KeyFile::initializePrivateKey();
+    publicKey publicKeyStruct = KeyFile::initializePublicKey();
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    keyGenerator.generatePrivateKey(&privateKeyStruct);
+    std::chrono::duration<double> keyTime = std::chrono::steady_clock::now() - startTime;
+    KeyFile::getPublicKey(&publicKeyStruct, &privateKeyStruct);
+    std::cout << std::fixed << std::setprecision(2) << options.sizeOfKey << " bit keypair generated in "
+              << keyTime.count() << " s" << std::endl << std::endl;
+
+    std::cout << "              mode        MiB   enc MiB/s   dec MiB/s" << std::endl;
+    std::mt19937_64 random(12345);
+    int failures = 0;
+    for(int mode = 0; mode < NUMBER_OF_MODES; mode++){
+        size_t payloadBytes = static_cast<size_t>(options.sizeOfPayload * BYTES_PER_MIB);
+        if(mode == FileEncryptor::MODE_RSA_BLOCKS){
+            payloadBytes = std::max<size_t>(1, payloadBytes / RSA_BLOCKS_PAYLOAD_DIVISOR);
+        }
+        std::string plaintext(payloadBytes, '\0');
+        for(size_t i = 0; i < payloadBytes; i++){
+            plaintext[i] = static_cast<char>(random());
+        }
+
+        encryptionConfig encryptionOptions;
+        encryptionOptions.encryptionMode = mode;
+        FileEncryptor fileEncryptor(&publicKeyStruct, encryptionOptions);
+        FileDecryptor fileDecryptor(&privateKeyStruct);
+        std::istringstream plaintextStream(plaintext);
+        std::ostringstream ciphertextStream;
+        startTime = std::chrono::steady_clock::now();
+        bool succeeded = fileEncryptor.encrypt(plaintextStream, payloadBytes, ciphertextStream);
+        std::chrono::duration<double> encryptTime = std::chrono::steady_clock::now() - startTime;
+
+        std::istringstream ciphertextInput(ciphertextStream.str());
+        std::ostringstream decryptedStream;
+        startTime = std::chrono::steady_clock::now();
+        succeeded = succeeded && fileDecryptor.decrypt(ciphertextInput, decryptedStream);
+        std::chrono::duration<double> decryptTime = std::chrono::steady_clock::now() - startTime;
+        succeeded = succeeded && decryptedStream.str() == plaintext;
+        if(succeeded == false){
+            failures++;
+        }
+
+        std::cout << std::setw(18) << MODE_NAMES[mode] << std::setw(11) << payloadBytes / BYTES_PER_MIB
+                  << std::setw(12) << payloadBytes / BYTES_PER_MIB / encryptTime.count()
+                  << std::setw(12) << payloadBytes / BYTES_PER_MIB / decryptTime.count()
+                  << (succeeded ? "" : "  MISMATCH") << std::endl;
+    }
+    KeyFile::clearPublicKey(&publicKeyStruct);
+    KeyFile::clearPrivateKey(&privateKeyStruct);
+    return (failures == 0) ? 0 : 1;
+}
+
+std::string CommandLine::getOutputFilepath(const std::string &inputFilepath, const commandOptions &options){
+/***********************************************************************
+* Works out where the output of a file goes. Encrypted files get the extension of the
+* container (.rsa, or .txt when armoured) added. Decrypted files have a .rsa or .txt
+* extension taken off, or .decrypted added if they have neither.
+* The output goes in options.outputFolder if one was given, otherwise next to the input.
+*
+* Arguments:
+* @ inputFilepath: The file being encrypted or decrypted.
+* @ options: The command line options.
+*
+* Returns:
+* @ outputFilepath: The filepath the output is written to.
+***********************************************************************/
+    std::string outputFilepath = inputFilepath;
+    if(options.command == "encrypt"){
+        outputFilepath += FileEncryptor::getExtension(options.armoured);
+    }
+    else{
+        std::string extension = (outputFilepath.size() > 4) ? outputFilepath.substr(outputFilepath.size() - 4) : "";
+        if(extension == FileEncryptor::getExtension(false) || extension == FileEncryptor::getExtension(true)){
+            outputFilepath.resize(outputFilepath.size() - 4);
+        }
+        else{
+            outputFilepath += ".decrypted";
+        }
+    }
+    if(options.outputFolder.empty() == false){
+        size_t nameStart = outputFilepath.find_last_of("/\\");
+        outputFilepath = options.outputFolder + "/" + ((nameStart == std::string::npos) ? outputFilepath : outputFilepath.substr(nameStart + 1));
+    }
+    return outputFilepath;
+}
+
+void CommandLine::writeResult(std::ostream &output, const std::string &name, const fileResult &result){
+/***********************************************************************
+* Writes one line with the time a file (or the whole run) took and its throughput.
+*
+* Arguments:
+* @ output: The stream the line is written to.
+* @ name: The name of the file.
+* @ result: The result of the file.
+***********************************************************************/
+    output << std::fixed << std::setprecision(1) << (result.succeeded ? "ok      " : "FAILED  ") << name
+           << "  " << result.inputSize << " bytes  " << result.seconds * 1000 << " ms";
+    if(result.succeeded == true && result.seconds > 0 && result.inputSize > 0){
+        output << "  " << std::setprecision(2) << result.inputSize / BYTES_PER_MIB / result.seconds << " MiB/s";
+    }
+    output << "  " << result.message << std::endl;
+}
+
+void CommandLine::printUsage(std::ostream &output){
+/***********************************************************************
+* Writes the commands and their options.
+*
+* Arguments:
+* @ output: The stream the usage is written to.
+***********************************************************************/
+    output << "Usage:" << std::endl
+           << "  rsacli keygen  [--bits 4096] [--count 1] [--jobs N] [--paranoid] [--fingerprint-names] [--output FOLDER]" << std::endl
+           << "                 [--force]" << std::endl
+           << "  rsacli encrypt --key PublicKey.pem [--mode aes-gcm|chacha20-poly1305|rsa-blocks] [--armour]" << std::endl
+           << "                 [--jobs N] [--output FOLDER] [--force] [FILE...]" << std::endl
+           << "  rsacli decrypt --key PrivateKey.pem [--jobs N] [--output FOLDER] [--force] [FILE...]" << std::endl
+           << "  rsacli bench   [--bits 4096] [--size 64]" << std::endl
+           << std::endl
+           << "encrypt and decrypt work on --jobs files at once (one per core by default), sharing every core" << std::endl
+           << "between their blocks, and report the throughput of each file and of the whole run. With no FILE, or FILE \"-\", stdin is processed to stdout." << std::endl
+           << "Encrypted files are saved as FILE.rsa (FILE.txt with --armour), decrypted files without that extension." << std::endl;
+}
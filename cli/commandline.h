@@ -0,0 +1,56 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include "keyfile.h"
+#include "workscheduler.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct commandOptions{
+    std::string command; // keygen, encrypt, decrypt or bench.
+    std::string keyFilepath; // The .pem file of the key used by encrypt and decrypt.
+    std::string outputFolder; // The folder the output files are written to, "" writes them next to the inputs.
+    std::vector<std::string> inputFilepaths; // The files to encrypt or decrypt, none (or "-") uses stdin and stdout.
+    int sizeOfKey = 4096; // The size of the keys made by keygen and bench, in bits.
+    int numberOfKeys = 1; // The number of keypairs made by keygen.
+    int encryptionMode = 0; // One of the FileEncryptor modes.
+    int sizeOfPayload = 64; // The size of the data bench encrypts with the hybrid modes, in MiB.
+    unsigned int numberOfJobs = 0; // The number of files processed at once, 0 picks from the number of files and cores.
+    bool armoured = false; // Whether encrypt writes ASCII armour instead of binary.
+    bool paranoidChecks = false; // Whether keygen uses the maximum number of Miller-Rabin rounds.
+    bool fingerprintNames = false; // Whether keygen names a batch of keys by fingerprint instead of by number.
+    bool overwrite = false; // Whether keygen, encrypt and decrypt replace output files which already exist.
+};
+
+struct fileResult{
+    bool succeeded; // Whether the file was encrypted or decrypted.
+    unsigned long long inputSize; // The size of the input, in bytes.
+    double seconds; // The time the file took.
+    std::string message; // Where the output was written, or why the file failed.
+};
+
+class CommandLine
+{
+public:
+    static int run(const std::vector<std::string> &arguments);
+
+private:
+    static bool parseArguments(const std::vector<std::string> &arguments, commandOptions &options, std::string &error);
+    static bool parseNumber(const std::string &text, int minimum, int &value);
+    static int generateKeys(const commandOptions &options);
+    static int encryptFiles(const commandOptions &options);
+    static int decryptFiles(const commandOptions &options);
+    static int benchmark(const commandOptions &options);
+    static int runFileJobs(const commandOptions &options, const publicKey* publicKeyStruct, const privateKey* privateKeyStruct);
+    static fileResult processFile(const std::string &inputFilepath, const commandOptions &options, WorkScheduler *scheduler,
+                                  const publicKey* publicKeyStruct, const privateKey* privateKeyStruct);
+    static int processStandardStreams(const commandOptions &options, const publicKey* publicKeyStruct, const privateKey* privateKeyStruct);
+    static bool spoolStandardInput(std::string &spoolFilepath, unsigned long long &inputSize);
+    static bool createOutputFile(const std::string &outputFilepath);
+    static std::string getOutputFilepath(const std::string &inputFilepath, const commandOptions &options);
+    static void writeResult(std::ostream &output, const std::string &name, const fileResult &result);
+    static void printUsage(std::ostream &output);
+};
+
+#endif // COMMANDLINE_H
@@ -0,0 +1,15 @@
+#include "commandline.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[]){
+/***********************************************************************
+* The command-line frontend, which generates keys and encrypts and decrypts files with
+* the same rsacore library as the GUI, without needing a display. See CommandLine::run().
+***********************************************************************/
+    std::ios::sync_with_stdio(false);
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    return CommandLine::run(arguments);
+}
@@ -0,0 +1,78 @@
+#include "backgroundjob.h"
+#include "jobprogress.h"
+
+#include <chrono>
+#include <string>
+#include <QString>
+
+BackgroundJob::BackgroundJob(std::function<bool(JobProgress *progress, std::string &message)> work)
+    : progress([this](const JobProgress &){ emit progressChanged(); }){
+/***********************************************************************
+* Constructor for the BackgroundJob class, which runs one long operation (encrypting
+* or decrypting a file, or generating keys) on a QThreadPool instead of the GUI thread.
+* The work is given a JobProgress to pass to the engines, and whenever that changes the
+* progressChanged signal is emitted from the worker, so a connection to a window is queued
+* onto the GUI thread. The work must not touch the user interface, everything it needs
+* is copied into it before it starts.
+* The job is not deleted by the pool, as the window still needs it for its finished signal,
+* the JobRunner which started it deletes it once that has been handled.
+*
+* Arguments:
+* @ work: The operation, which returns whether it succeeded and sets the message to show the user.
+***********************************************************************/
+    this->work = work;
+    this->seconds = 0;
+    setAutoDelete(false);
+}
+
+void BackgroundJob::run(){
+/***********************************************************************
+* Runs the work on the pool's thread, then emits finished with its result.
+* A job which was cancelled while it was still waiting in the pool's queue
+* finishes straight away, without running the work.
+***********************************************************************/
+    if(progress.isCancelled() == true){
+        emit finished(false, "Cancelled before it started.");
+        return;
+    }
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::string message;
+    bool succeeded = work(&progress, message);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    seconds = elapsed.count();
+    emit finished(succeeded, QString::fromStdString(message));
+}
+
+void BackgroundJob::cancel(){
+/***********************************************************************
+* Cancels the job from the GUI thread. The engines check the JobProgress after every
+* range of blocks (or prime candidate), so the work returns soon after.
+***********************************************************************/
+    progress.cancel();
+}
+
+bool BackgroundJob::wasCancelled() const{
+/***********************************************************************
+* Returns:
+*  True: If cancel() has been called.
+*  False: If it has not.
+***********************************************************************/
+    return progress.isCancelled();
+}
+
+const JobProgress* BackgroundJob::getProgress() const{
+/***********************************************************************
+* Returns:
+* @ progress: The job's progress, its counters can be read from any thread.
+***********************************************************************/
+    return &progress;
+}
+
+double BackgroundJob::getSeconds() const{
+/***********************************************************************
+* Returns:
+* @ seconds: The time the work ran for, not counting the time the job waited in the
+*            pool's queue, 0 until it has finished.
+***********************************************************************/
+    return seconds;
+}
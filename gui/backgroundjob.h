@@ -0,0 +1,33 @@
+#ifndef BACKGROUNDJOB_H
+#define BACKGROUNDJOB_H
+
+#include "jobprogress.h"
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <functional>
+#include <string>
+
+class BackgroundJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundJob(std::function<bool(JobProgress *progress, std::string &message)> work);
+    void run() override;
+    void cancel();
+    bool wasCancelled() const;
+    const JobProgress* getProgress() const;
+    double getSeconds() const;
+
+signals:
+    void progressChanged();
+    void finished(bool succeeded, QString message);
+
+private:
+    std::function<bool(JobProgress *progress, std::string &message)> work;
+    JobProgress progress;
+    double seconds;
+};
+
+#endif // BACKGROUNDJOB_H
@@ -1,33 +1,24 @@
 #include "decryption.h"
 #include "ui_decryption.h"
 #include "menu.h"
+#include "keyfile.h"
+#include "filedecryptor.h"
+#include "fileencryptor.h"
+#include "backgroundjob.h"
+#include "jobprogress.h"
+#include "filequeue.h"
 #include <gmpxx.h>
-#include <includes/base64.h>
 
-#include <iostream>
-#include <ctime>
-#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <QDir>
 #include <QFileDialog>
-#include <bitset>
+#include <QFileInfo>
 #include <QMessageBox>
-#include <cryptopp/cryptlib.h>
-#include <cryptopp/integer.h>
-#include <cryptopp/files.h>
-#include <cryptopp/rsa.h>
-#include <cryptopp/pem.h>
 
-static int SIZE_OF_CHAR = 8; // Number of bits that are taken up by a character.
-
-std::string decryptedString = ""; // The string which will be written to the file at the end of execution.
-
-std::string privateKeyFilepath = ""; // The filepath of the private key.
-std::string encryptedFilepath = ""; // The filepath of the encrypted file (which will be decrypted).
-std::string outputFilepath = ""; // The filepath which the decrypted, plain-text file will be saved.
-
-bool privateKeySelected = false; // A flag which indicates if the user has selected the private key.
-bool encryptedFileSelected = false; // A flag which indicates if the user has selected the encrypted file.
-bool outputFilepathSelected = false; // A flag which indicates if the user has selected an output filepath.
 
 Decryption::Decryption(QWidget *parent):QMainWindow(parent), ui(new Ui::Decryption){
 /***********************************************************************
@@ -36,6 +27,11 @@ Decryption::Decryption(QWidget *parent):QMainWindow(parent), ui(new Ui::Decrypti
 * and calls the setup function.
 ***********************************************************************/
     ui->setupUi(this);
+    this->fileQueue = new FileQueue(ui->QueueList);
+    this->privateKeyFilepath = "";
+    this->outputFilepath = "";
+    this->privateKeySelected = false;
+    this->outputFilepathSelected = false;
     setup();
 }
 
@@ -45,6 +41,7 @@ Decryption::~Decryption()
 * Gets called automatically by QT when the UI window is closed.
 ***********************************************************************/
 {
+    delete fileQueue;
     delete ui;
 }
 
@@ -56,14 +53,15 @@ void Decryption::setup(){
 * - Sets the outputFilepathLabel to false as no filepath selected.
 * - Adds the homepage action button to the toolbar.
 * - Connects all of the buttons to respective functions.
-* - Initializes the private key.
+* - Connects the jobRunner's signals, which arrive on the GUI thread, to the progress bar and the result messages.
 ***********************************************************************/
     Decryption::setKeyLabel(false);
     Decryption::setFilepathLabel(false);
     Decryption::setOutputFilepathLabel(false);
     Decryption::addHomeButtonToToolbar();
     Decryption::connectButtons();
-    Decryption::initializePrivateKey();
+    connect(&jobRunner, &JobRunner::progressChanged, this, &Decryption::updateJobProgress);
+    connect(&jobRunner, &JobRunner::jobFinished, this, &Decryption::decryptionFinished);
 }
 
 void Decryption::loadMenu(){
@@ -97,13 +95,17 @@ void Decryption::connectButtons(){
 * Connects each button to their respective functions:
 * - PrivateKeyButton connected to the selectPrivateKey function
 * - FileToDecryptButton connected to the selectFileToDecrypt function
+* - FolderToDecryptButton connected to the selectFolderToDecrypt function
 * - OutputButton connected to the selectOutputFilepath function
 * - GoButton connected to the decrypt function
+* - CancelButton connected to the jobRunner's cancelAll function
 ***********************************************************************/
     connect(ui->PrivateKeyButton, &QPushButton::released, this, &Decryption::selectPrivateKey);
     connect(ui->FileToDecryptButton, &QPushButton::released, this, &Decryption::selectFileToDecrypt);
+    connect(ui->FolderToDecryptButton, &QPushButton::released, this, &Decryption::selectFolderToDecrypt);
     connect(ui->OutputButton, &QPushButton::released, this, &Decryption::selectOutputFilepath);
     connect(ui->GoButton, &QPushButton::released, this, &Decryption::decrypt);
+    connect(ui->CancelButton, &QPushButton::released, &jobRunner, &JobRunner::cancelAll);
 }
 
 bool Decryption::checkUserInput(){
@@ -113,33 +115,16 @@ bool Decryption::checkUserInput(){
 *  True: If the user has entered all of the required information (i.e. pass)
 *  False: If the user has not entered all of the required information (i.e. fail)
 ***********************************************************************/
-    if(privateKeySelected == false || encryptedFileSelected == false || outputFilepathSelected == false){
+    if(privateKeySelected == false || fileQueue->getWaitingFiles().empty() == true || outputFilepathSelected == false){
         return false;
     }
     return true;
 }
 
-privateKey Decryption::initializePrivateKey(){
-/***********************************************************************
-* A function which creates a privateKey stucture, and initializes each
-* multiprecision variable.
-*
-* Returns:
-* @ privateKeyStruct: A privateKey structure, named privateKeyStruct, that has been initialised.
-***********************************************************************/
-    privateKey privateKeyStruct;
-    mpz_init(privateKeyStruct.modulus);
-    mpz_init(privateKeyStruct.publicExponent);
-    mpz_init(privateKeyStruct.privateExponent);
-    mpz_init(privateKeyStruct.prime1);
-    mpz_init(privateKeyStruct.prime2);
-    return privateKeyStruct;
-}
-
 void Decryption::selectPrivateKey(){
 /***********************************************************************
 * Opens a file browser for the user to select the PrivateKey.pem file
-* If no file is selected the global variable privateKeyFilepath is reset
+* If no file is selected the member variable privateKeyFilepath is reset
 * and privateKeySelected bool is set to false.
 * If a file is selected then the variable gets set to the path of the file
 * and the privateKeySelected bool is set to true.
@@ -189,28 +174,38 @@ void Decryption::setKeyLabel(bool keySelected){
 
 void Decryption::selectFileToDecrypt(){
 /***********************************************************************
-* Opens a file browser for the user to select the file to decrypt.
-* If no file is selected the global variable encryptedFilepath is reset
-* and encryptedFileSelected is set to false.
-* If a file is selected then the variable gets set to the path of the file
-* and the encryptedFileSelected bool is set to true.
+* Opens a file browser for the user to select the files to decrypt.
+* Every file selected is added to the fileQueue, and the label is set to
+* a tick once there is a file waiting in it.
 ***********************************************************************/
     QFileDialog fileBrowser;
-    fileBrowser.setFileMode(QFileDialog::ExistingFile);
-    fileBrowser.setNameFilter("*.txt");
-    fileBrowser.setWindowTitle(QObject::tr("Open File To Decrypt..."));
+    fileBrowser.setFileMode(QFileDialog::ExistingFiles);
+    fileBrowser.setNameFilter("*.rsa *.txt");
+    fileBrowser.setWindowTitle(QObject::tr("Open Files To Decrypt..."));
     if(fileBrowser.exec()!=QDialog::Accepted){
         Decryption::outputErrorMessage("Error!", "ERROR: Please select a valid encrypted file!");
-        encryptedFilepath = "";
-        encryptedFileSelected = false;
-        Decryption::setFilepathLabel(false);
     }
     else{
-        QStringList FileLocation = fileBrowser.selectedFiles();
-        encryptedFilepath = FileLocation.join("").toStdString();
-        encryptedFileSelected = true;
-        Decryption::setFilepathLabel(true);
+        fileQueue->addFiles(fileBrowser.selectedFiles());
+    }
+    Decryption::setFilepathLabel(fileQueue->getWaitingFiles().empty() == false);
+}
+
+void Decryption::selectFolderToDecrypt(){
+/***********************************************************************
+* Opens a file browser for the user to select a folder of encrypted files.
+* Every file in the folder, and in the folders inside it, is added to the fileQueue.
+***********************************************************************/
+    QFileDialog fileBrowser;
+    fileBrowser.setFileMode(QFileDialog::Directory);
+    fileBrowser.setWindowTitle(QObject::tr("Open Folder To Decrypt..."));
+    if(fileBrowser.exec()!=QDialog::Accepted){
+        Decryption::outputErrorMessage("Error!", "ERROR: Please select a valid folder to decrypt!");
     }
+    else if(fileQueue->addFolder(fileBrowser.selectedFiles().join("")) == 0){
+        Decryption::outputErrorMessage("Error!", "ERROR: The folder does not contain any files!");
+    }
+    Decryption::setFilepathLabel(fileQueue->getWaitingFiles().empty() == false);
 }
 
 void Decryption::setFilepathLabel(bool filepathSelected){
@@ -241,15 +236,24 @@ void Decryption::setFilepathLabel(bool filepathSelected){
 void Decryption::selectOutputFilepath(){
 /***********************************************************************
 * Opens a file browser for the user to select the output decrypted file location.
-* If no file is selected the global variable outputFilepath is reset
+* If more than one file is queued, a folder is selected instead, which every
+* decrypted file is saved into.
+* If no file is selected the member variable outputFilepath is reset
 * and outputFilepathSelected is set to false.
 * If a file is selected then the variable gets set to the path of the file location
 * and the outputFilepathSelected bool is set to true.
 ***********************************************************************/
+    bool selectFolder = (fileQueue->getWaitingFiles().size() > 1);
     QFileDialog fileBrowser;
-    fileBrowser.setFileMode(QFileDialog::AnyFile);
-    fileBrowser.setNameFilter("*.txt");
-    fileBrowser.setWindowTitle(QObject::tr("Save Decrypted File..."));
+    if(selectFolder == true){
+        fileBrowser.setFileMode(QFileDialog::Directory);
+        fileBrowser.setWindowTitle(QObject::tr("Save Decrypted Files To..."));
+    }
+    else{
+        fileBrowser.setFileMode(QFileDialog::AnyFile);
+        fileBrowser.setNameFilter("*.txt");
+        fileBrowser.setWindowTitle(QObject::tr("Save Decrypted File..."));
+    }
     if(fileBrowser.exec()!=QDialog::Accepted){
         Decryption::outputErrorMessage("Error!", "ERROR: Please select a valid path for the decrypted file to be saved!");
         outputFilepath = "";
@@ -258,7 +262,7 @@ void Decryption::selectOutputFilepath(){
     }
     else{
         QStringList FileLocation = fileBrowser.selectedFiles();
-        outputFilepath = FileLocation.join("").toStdString() + ".txt";
+        outputFilepath = FileLocation.join("").toStdString() + (selectFolder ? "" : ".txt");
         outputFilepathSelected = true;
         Decryption::setOutputFilepathLabel(true);
     }
@@ -289,190 +293,198 @@ void Decryption::setOutputFilepathLabel(bool outputFilepathSelected){
     }
 }
 
-privateKey Decryption::loadPrivateKey(privateKey privateKeyStruct){
-/***********************************************************************
-* A function which loads the private key from the .pem file the user has selected
-* and then assigns the privateExponent and modulus values to our privateKey structure.
-*
-* Arguments:
-* @ privateKeyStruct: The initialised, but not-yet assigned privateKey structure.
-*
-* Returns:
-*  privateKeyStruct: The privateKey structure once the values have been assigned from the .pem file.
-***********************************************************************/
-    try {
-        CryptoPP::FileSource privateKeySource(privateKeyFilepath.c_str(), true);
-        CryptoPP::RSA::PrivateKey cryptoPrivateKey;
-        CryptoPP::PEM_Load(privateKeySource, cryptoPrivateKey);
-
-        CryptoPP::Integer privateExponent = cryptoPrivateKey.GetPrivateExponent();
-        CryptoPP::Integer modulus = cryptoPrivateKey.GetModulus();
-
-        std::string privateExponentString;
-        std::ostringstream privateExponentStream;
-        privateExponentStream << privateExponent;
-        privateExponentString = privateExponentStream.str();
-        // The privateExponentString ends in a full-stop ('.') char, therefore we pop_back the string to remove the last character.
-        privateExponentString.pop_back();
-
-        std::string modulusString;
-        std::ostringstream modulusStream;
-        modulusStream << modulus;
-        modulusString = modulusStream.str();
-        // The modulusString ends in a full-stop ('.') char, therefore we pop_back the string to remove the last character.
-        modulusString.pop_back();
-
-        mpz_set_str(privateKeyStruct.privateExponent, privateExponentString.c_str(), 10);
-        mpz_set_str(privateKeyStruct.modulus, modulusString.c_str(), 10);
-
-        return privateKeyStruct;
-    }
-    catch (std::exception &e) {
-        Decryption::outputErrorMessage("Error!", "ERROR: Error when reading PEM file");
-        // Goes back to the Menu window to prevent any errors carrying forward in this class.
-        Decryption::loadMenu();
-    }
-
-}
-
-
 void Decryption::decrypt(){
 /***********************************************************************
 * This function is run when the go button is clicked by the user.
-* It essentially calls the other functions in the correct order, with some
-* validation checks along the way
-* A success message is output after decryption has been completed.
-* All the filepaths are reset so the program can be run again.
+* It checks the input and loads the private key, then starts a BackgroundJob for every
+* file waiting in the fileQueue, so the window stays responsive while they run.
+* Every job shares its blocks out on the sharedWorkScheduler, so the cores keep working
+* on the other files' blocks while a small file is being read or written.
+* A single file is saved to the selected filepath, several files are saved into the
+* selected folder, named after the encrypted files without their .rsa or .txt extension.
+* The progress bar follows the blocks as they are decrypted (or the files, for a batch),
+* and decryptionFinished() outputs the results once the jobs are done.
+* All the filepaths are reset so the program can be run again straight away.
 ***********************************************************************/
     if(Decryption::checkUserInput() == false){
         Decryption::outputErrorMessage("Error!", "ERROR: Please check all input fields and try again!");
         return;
     }
-    privateKey privateKeyStruct = initializePrivateKey();
-    privateKeyStruct = Decryption::loadPrivateKey(privateKeyStruct);
-    std::string b64textFromFile = Decryption::readFromFile();
-    std::string textFromFile;
-    //Base64 Decrypts the b64textFromFile, and stores the output in textFromFile.
-    macaron::Base64::Decode(b64textFromFile, textFromFile);
-    Decryption::decryptString(textFromFile, privateKeyStruct);
-    Decryption::writeDecryptedTextToFile();
-    Decryption::outputSuccessMessage("Success!", "File decrypted and written to filepath successfully!");
-
+    bool outputToFolder = QFileInfo(QString::fromStdString(outputFilepath)).isDir();
+    if(fileQueue->getWaitingFiles().size() > 1 && outputToFolder == false){
+        Decryption::outputErrorMessage("Error!", "ERROR: Please select a folder for the decrypted files to be saved to!");
+        return;
+    }
+    // The key is shared with the jobs, and cleared once the jobs (and this function) no longer need it.
+    std::shared_ptr<privateKey> privateKeyStruct(new privateKey(KeyFile::initializePrivateKey()), [](privateKey* keyToClear){
+        KeyFile::clearPrivateKey(keyToClear);
+        delete keyToClear;
+    });
+    if(KeyFile::loadPrivateKey(privateKeyFilepath, privateKeyStruct.get()) == false){
+        Decryption::outputErrorMessage("Error!", "ERROR: Error when reading PEM file");
+        // Goes back to the Menu window to prevent any errors carrying forward in this class.
+        Decryption::loadMenu();
+        return;
+    }
 
+    std::vector<int> waitingFiles = fileQueue->startBatch();
+    for(unsigned int i = 0; i < waitingFiles.size(); i++){
+        const queuedFile &file = fileQueue->getFile(waitingFiles[i]);
+        std::string decryptedFilepath = outputFilepath;
+        if(outputToFolder == true){
+            decryptedFilepath = outputFilepath + "/" + Decryption::getDecryptedName(file.outputName);
+            QDir().mkpath(QFileInfo(QString::fromStdString(decryptedFilepath)).absolutePath());
+        }
+        Decryption::startDecryptionJob(privateKeyStruct, file.inputFilepath, decryptedFilepath, waitingFiles[i]);
+    }
+    Decryption::resetWindow();
 }
 
-void Decryption::decryptString(std::string stringToDecrypt, privateKey privateKeyStruct){
+void Decryption::startDecryptionJob(std::shared_ptr<privateKey> privateKeyStruct, const std::string &encryptedFilepath, const std::string &outputFilepath,
+                                    int queueIndex){
 /***********************************************************************
-* A function which iterates through the string which will be decrypted.
-* It searches for the delimiter, which in this case is a forward slash ('/'),
-* as this indicates where the blocks were split when the message was encrypted.
+* Starts a BackgroundJob which decrypts one file with decryptToFile().
+* Everything the job needs is copied into it, so it never uses the window.
 *
 * Arguments:
-*  @ stringToDecrypt: The entire string, from the encrypted file, once it has been base64 decoded.
-*  @ privateKeyStruct: The structure which contains the values needed for decryption.
+*  @ privateKeyStruct: The private key, shared between every job.
+*  @ encryptedFilepath: The filepath of the encrypted file.
+*  @ outputFilepath: The filepath the decrypted file is written to.
+*  @ queueIndex: The index of the file in the fileQueue.
 ***********************************************************************/
-    std::string blockToDecrypt = "";
-    for (int charCounter = 0; static_cast<unsigned int>(charCounter) <= static_cast<unsigned int>(stringToDecrypt.length()) ; charCounter++) {
-        char currentChar = stringToDecrypt[charCounter];
-        if(currentChar != '/'){
-            blockToDecrypt += currentChar;
-        }
-        else{
-            decryptBlock(blockToDecrypt, privateKeyStruct);
-            blockToDecrypt = "";
-        }
-    }
+    WorkScheduler *scheduler = sharedWorkScheduler;
+    BackgroundJob *job = new BackgroundJob([privateKeyStruct, encryptedFilepath, outputFilepath, scheduler](JobProgress *progress, std::string &message){
+        return Decryption::decryptToFile(privateKeyStruct.get(), encryptedFilepath, outputFilepath, scheduler, progress, message);
+    });
+    fileQueue->startFile(queueIndex, jobRunner.start(job));
 }
 
-void Decryption::decryptBlock(std::string blockToDecrypt, privateKey privateKeyStruct){
+std::string Decryption::getDecryptedName(const std::string &encryptedName){
 /***********************************************************************
-* This function is called iteratively by decryptString, it decrypts the current block
-* which gets passed in the variable "blockToDecrypt".
-* A validation check "addLeadingZeros" is called to correct the loss of leading zeros
-* when converting numbers into integers.
-* Once successfully decrypted, the decrypted block is concatenated onto the global variable decryptedString.
+* Works out the name of a decrypted file in the output folder, by taking the extension
+* FileEncryptor added (.rsa, or .txt when armoured) back off, e.g. "report.pdf.rsa"
+* is decrypted to "report.pdf". Files without either extension are saved as .txt files,
+* like a single decrypted file.
 *
 * Arguments:
-*  @ blockToDecrypt: The current block, passed from decryptString function, which needs to be decoded.
-*  @ privateKeyStruct: The structure which contains the values needed for decryption.
+*  @ encryptedName: The name of the encrypted file, relative to the folder it was added from.
+*
+* Returns:
+*  @ decryptedName: The name of the decrypted file, relative to the output folder.
 ***********************************************************************/
-    mpz_t valueToDecrypt; mpz_init(valueToDecrypt);
-    mpz_t decryptedDenary; mpz_init(decryptedDenary);
-
-    mpz_set_str(valueToDecrypt, blockToDecrypt.c_str(), 10);
-    mpz_powm(decryptedDenary, valueToDecrypt, privateKeyStruct.privateExponent, privateKeyStruct.modulus);
-
-    std::string decryptedBlockBinaryString = mpz_get_str(NULL, 2, decryptedDenary);
-    Decryption::addLeadingZeros(decryptedBlockBinaryString);
-    std::string currentByte = "";
-
-    int temp_counter = 0;
-    for(int currentBitCounter = 0; static_cast<unsigned long long>(currentBitCounter) <= decryptedBlockBinaryString.length(); currentBitCounter++) {
-        currentByte += decryptedBlockBinaryString[currentBitCounter];
-        temp_counter += 1;
-        if(temp_counter == SIZE_OF_CHAR){
-            decryptedString += static_cast<char>(stoi(currentByte, 0, 2));
-            currentByte = "";
-            temp_counter = 0;
+    std::string extensions[2] = {FileEncryptor::getExtension(false), FileEncryptor::getExtension(true)};
+    for(int i = 0; i < 2; i++){
+        size_t extensionLength = extensions[i].size();
+        if(encryptedName.size() > extensionLength
+                && encryptedName.compare(encryptedName.size() - extensionLength, extensionLength, extensions[i]) == 0){
+            return encryptedName.substr(0, encryptedName.size() - extensionLength);
         }
     }
+    return encryptedName + ".txt";
 }
 
-std::string Decryption::readFromFile(){
+bool Decryption::decryptToFile(const privateKey* privateKeyStruct, const std::string &encryptedFilepath, const std::string &outputFilepath,
+                               WorkScheduler *scheduler, JobProgress *progress, std::string &message){
 /***********************************************************************
-* This function reads all of the text from a file, using a buffer stream.
+* Decrypts a file with a FileDecryptor, which decrypts containers straight to the output
+* file a chunk at a time, and files from older versions of the program in memory.
+* It runs on a BackgroundJob's thread, so it only uses what it has been given and never the window.
+*
+* Arguments:
+*  @ privateKeyStruct: The private key the file is decrypted with.
+*  @ encryptedFilepath: The filepath of the encrypted file.
+*  @ outputFilepath: The filepath the decrypted file is written to.
+*  @ scheduler: The WorkScheduler shared by every file being decrypted, or nullptr.
+*  @ progress: The job's JobProgress.
+*  @ message: Set to the message which is shown to the user.
 *
 * Returns:
-*  bufferStream.str(): the text content from the file returned as a string.
+*  True: If the decrypted file has been written.
+*  False: If it could not be decrypted or written, or the job was cancelled.
 ***********************************************************************/
-    try {
-        std::ifstream inputFileStream(encryptedFilepath);
-        std::stringstream bufferStream;
-        bufferStream << inputFileStream.rdbuf();
-        return bufferStream.str();
-    }
-    catch(const std::exception &e){
-        Decryption::outputErrorMessage("Error!", "ERROR: Error when reading from file");
-        // Goes back to the Menu window to prevent any errors carrying forward in this class.
-        Decryption::loadMenu();
+    FileDecryptor fileDecryptor(privateKeyStruct, 0, progress, scheduler);
+    if(fileDecryptor.decryptFile(encryptedFilepath, outputFilepath) == true){
+        message = "File decrypted and written to " + outputFilepath + " successfully!";
+        return true;
+    }
+    if(progress->isCancelled() == true){
+        message = "Decryption of " + encryptedFilepath + " cancelled.";
+    }
+    else if(fileDecryptor.couldNotReadInput() == true){
+        message = "ERROR: Error when reading from file";
+    }
+    else if(fileDecryptor.wasEncryptedForDifferentKey() == true){
+        message = "ERROR: This file was encrypted for a different key!";
     }
+    else{
+        message = "ERROR: The file was not encrypted with this key, or has been damaged!";
+    }
+    return false;
 }
 
-void Decryption::writeDecryptedTextToFile(){
+void Decryption::updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total){
 /***********************************************************************
-* A function which writes the global variable decryptedString into a file
-* at the location of the contents of global variable outputFilepath.
+* Shows the progress of every running decryption on the progress bar, as a share of
+* all of their blocks, and how many decryptions are running on the status label.
+* While a batch of several files is running, the progress bar shows the share of the
+* files which have finished instead, and the label the batch's throughput.
+*
+* Arguments:
+* @ numberOfRunningJobs: The number of decryptions which are running (or waiting for a thread).
+* @ done: The number of blocks (or hybrid chunks) which have been decrypted.
+* @ total: The number of blocks (or hybrid chunks) in all of the running decryptions, as far as is known.
 ***********************************************************************/
-    try {
-        std::ofstream outputFileStream;
-        outputFileStream.open (outputFilepath);
-        outputFileStream << decryptedString;
-        outputFileStream.close();
-    }
-    catch (const std::exception &e){
-        Decryption::outputErrorMessage("Error!", "ERROR: Error when writing to file");
-        // Goes back to the Menu window to prevent any errors carrying forward in this class.
-        Decryption::loadMenu();
+    if(numberOfRunningJobs == 0){
+        ui->JobProgressBar->setValue(0);
+        ui->JobStatusLabel->setText("No jobs running");
+        return;
     }
+    if(fileQueue->isBatchRunning() == true && fileQueue->getNumberOfFilesInBatch() > 1){
+        ui->JobProgressBar->setValue(fileQueue->getNumberOfFilesFinished() * 1000 / fileQueue->getNumberOfFilesInBatch());
+        ui->JobStatusLabel->setText(QString::fromStdString(std::to_string(numberOfRunningJobs) + " running, " + fileQueue->describeThroughput()));
+        return;
+    }
+    ui->JobProgressBar->setValue((total == 0) ? 0 : static_cast<int>(done * 1000 / total));
+    ui->JobStatusLabel->setText(QString::fromStdString(std::to_string(numberOfRunningJobs) + " running, "
+                                                       + std::to_string(done) + " of " + std::to_string(total) + " blocks decrypted"));
 }
 
-void Decryption::addLeadingZeros(std::string &binaryString){
+void Decryption::decryptionFinished(bool succeeded, bool cancelled, QString message, double seconds, int jobNumber){
 /***********************************************************************
-* Due to the conversion from string to binary to string, any leading zeros ('0') will
-* be lost, which causes math problems later down the line if not fixed. This function
-* ensures that the string has a whole number of bytes, so there are no errors in binary
-* to character conversion. As the only data that could be lost is a zero, a variable number
-* of zeros get added to the beginning of the string (depending on how many were lost).
+* Runs on the GUI thread once a decryption job has returned, and shows its result.
+* The result of each file in a batch is shown in the QueueList, and one message with
+* the batch's throughput is output once every file in it has finished.
 *
 * Arguments:
-* @ binaryString: A string passed by reference, meaning any changes to the string
-*                 are also reflected outside the function. This string represents
-*                 the data in the current block being decrypted.
+* @ succeeded: Whether the file was decrypted.
+* @ cancelled: Whether the job was cancelled, which only updates the status label.
+* @ message: The message from decryptToFile().
+* @ seconds: The time the job ran for.
+* @ jobNumber: The number of the job, which finds its file in the fileQueue.
 ***********************************************************************/
-    int numberOfZerosRequired = (SIZE_OF_CHAR - (binaryString.length() % SIZE_OF_CHAR));
-    if(numberOfZerosRequired != SIZE_OF_CHAR){
-        binaryString.insert(0, numberOfZerosRequired, '0');
+    if(fileQueue->finishFile(jobNumber, succeeded, cancelled, message.toStdString(), seconds) == true
+            && fileQueue->getNumberOfFilesInBatch() > 1){
+        if(fileQueue->isBatchRunning() == false){
+            std::string summary = "Decrypted " + fileQueue->describeThroughput();
+            ui->JobStatusLabel->setText(QString::fromStdString(summary));
+            if(fileQueue->getNumberOfFilesFailed() > 0){
+                summary += "\n" + std::to_string(fileQueue->getNumberOfFilesFailed()) + " files failed or were cancelled, see the queue for details.";
+            }
+            Decryption::outputSuccessMessage("Finished!", summary);
+        }
+        return;
+    }
+    if(cancelled == true && succeeded == false){
+        ui->JobStatusLabel->setText(message);
+        return;
+    }
+    if(succeeded == false){
+        Decryption::outputErrorMessage("Error!", message.toStdString());
+        return;
     }
+    std::ostringstream timeStream;
+    timeStream << std::fixed << std::setprecision(1) << seconds;
+    Decryption::outputSuccessMessage("Success!", message.toStdString() + " (" + timeStream.str() + " seconds)");
 }
 
 void Decryption::outputErrorMessage(std::string windowHeader, std::string messageContent){
@@ -505,14 +517,12 @@ void Decryption::outputSuccessMessage(std::string windowHeader, std::string mess
 
 void Decryption::resetWindow(){
 /***********************************************************************
-* Resets all of the global variables, flags and label images to their default values.
+* Resets all of the filepaths, flags and label images to their default values.
+* The fileQueue is left alone, as its files have either been started or are still waiting.
 ***********************************************************************/
-    decryptedString = "";
     privateKeyFilepath = "";
-    encryptedFilepath = "";
     outputFilepath = "";
     privateKeySelected = false;
-    encryptedFileSelected = false;
     outputFilepathSelected = false;
     Decryption::setKeyLabel(false);
     Decryption::setFilepathLabel(false);
@@ -0,0 +1,62 @@
+#ifndef DECRYPTION_H
+#define DECRYPTION_H
+
+#include "keyfile.h"
+#include "filedecryptor.h"
+#include "jobprogress.h"
+#include "jobrunner.h"
+#include "filequeue.h"
+#include <gmpxx.h>
+#include <QMainWindow>
+#include <QString>
+#include <memory>
+#include <string>
+
+namespace Ui {
+class Decryption;
+}
+
+class Decryption : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit Decryption(QWidget *parent = nullptr);
+    ~Decryption();
+
+private:
+    Ui::Decryption *ui;
+    FileQueue *fileQueue;
+    std::string privateKeyFilepath;
+    std::string outputFilepath;
+    bool privateKeySelected;
+    bool outputFilepathSelected;
+    JobRunner jobRunner;
+    void setup();
+    void loadMenu();
+    void addHomeButtonToToolbar();
+    void connectButtons();
+    bool checkUserInput();
+
+    void selectPrivateKey();
+    void setKeyLabel(bool keySelected);
+    void selectFileToDecrypt();
+    void selectFolderToDecrypt();
+    void setFilepathLabel(bool filepathSelected);
+    void selectOutputFilepath();
+    void setOutputFilepathLabel(bool outputFilepathSelected);
+
+    void decrypt();
+    void startDecryptionJob(std::shared_ptr<privateKey> privateKeyStruct, const std::string &encryptedFilepath, const std::string &outputFilepath,
+                            int queueIndex);
+    static std::string getDecryptedName(const std::string &encryptedName);
+    static bool decryptToFile(const privateKey* privateKeyStruct, const std::string &encryptedFilepath, const std::string &outputFilepath,
+                              WorkScheduler *scheduler, JobProgress *progress, std::string &message);
+    void updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total);
+    void decryptionFinished(bool succeeded, bool cancelled, QString message, double seconds, int jobNumber);
+    void outputErrorMessage(std::string windowHeader, std::string messageContent);
+    void outputSuccessMessage(std::string windowHeader, std::string messageContent);
+    void resetWindow();
+};
+
+#endif // DECRYPTION_H
@@ -1,37 +1,22 @@
 #include "encryption.h"
 #include "ui_encryption.h"
 #include "menu.h"
-#include <includes/base64.h>
+#include "keyfile.h"
+#include "fileencryptor.h"
+#include "backgroundjob.h"
+#include "jobprogress.h"
+#include "filequeue.h"
 #include <gmpxx.h>
 
-#include <iostream>
-#include <ctime>
-#include <string>
-#include <cstring>
-#include <fstream>
+#include <iomanip>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
+#include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
-#include <bitset>
-#include <cryptopp/cryptlib.h>
-#include <cryptopp/integer.h>
-#include <cryptopp/files.h>
-#include <cryptopp/rsa.h>
-#include <cryptopp/pem.h>
-
-static int BLOCK_SIZE = 256; // Size of the blocks to be used in encryption.
-static int SIZE_OF_CHAR = 8; // Number of bits that are taken up by a character.
-
-std::string encryptedString = ""; // The string which has been encrypted using RSA public key.
-std::string b64EncryptedString = ""; // The RSA encrypted string, base64 encoded, ready to be written to a file.
-
-std::string inputFilepath = ""; // The filepath of the plain-text file (which will have it's contents encrypted).
-std::string publicKeyFilepath = ""; // The filepath of the public key.
-std::string outputEncryptedFilepath = ""; // The filepath which the base64 encrypted file will be saved.
-
-bool inputFileSelected = false; // A flag which indicates if the user has selected the plaintext file to encrypt.
-bool publicKeySelected = false; // A flag which indicates if the user has selected the public key.
-bool outputEncryptedFilepathSelected = false; // A flag which indicates if the user has selected an output filepath.
 
 
 
@@ -42,6 +27,11 @@ Encryption::Encryption(QWidget *parent):QMainWindow(parent), ui(new Ui::Encrypti
 * and calls the setup function.
 ***********************************************************************/
     ui->setupUi(this);
+    this->fileQueue = new FileQueue(ui->QueueList);
+    this->publicKeyFilepath = "";
+    this->outputEncryptedFilepath = "";
+    this->publicKeySelected = false;
+    this->outputEncryptedFilepathSelected = false;
     Encryption::setup();
 }
 
@@ -50,6 +40,7 @@ Encryption::~Encryption(){
 * Destructor for the Encryption Window,
 * Gets called automatically by QT when the UI window is closed.
 ***********************************************************************/
+    delete fileQueue;
     delete ui;
 }
 
@@ -61,12 +52,15 @@ void Encryption::setup(){
 * - Sets the outputFilepathLabel to false as no filepath selected.
 * - Adds the homepage action button to the toolbar.
 * - Connects all of the buttons to respective functions.
+* - Connects the jobRunner's signals, which arrive on the GUI thread, to the progress bar and the result messages.
 ***********************************************************************/
     Encryption::setKeyLabel(false);
     Encryption::setFilepathLabel(false);
     Encryption::setOutputFilepathLabel(false);
     Encryption::addHomeButtonToToolbar();
     Encryption::connectButtons();
+    connect(&jobRunner, &JobRunner::progressChanged, this, &Encryption::updateJobProgress);
+    connect(&jobRunner, &JobRunner::jobFinished, this, &Encryption::encryptionFinished);
 }
 
 void Encryption::loadMenu(){
@@ -100,13 +94,17 @@ void Encryption::connectButtons(){
 * Connects each button to their respective functions:
 * - PublicKeyButton connected to the selectPublicKey function
 * - FileToEncryptButton connected to the selectFileToEncrypt function
+* - FolderToEncryptButton connected to the selectFolderToEncrypt function
 * - OutputButton connected to the selectOutputFilepath function
 * - GoButton connected to the encrypt function
+* - CancelButton connected to the jobRunner's cancelAll function
 ***********************************************************************/
     connect(ui->PublicKeyButton, &QPushButton::released, this, &Encryption::selectPublicKey);
     connect(ui->FileToEncryptButton, &QPushButton::released, this, &Encryption::selectFileToEncrypt);
+    connect(ui->FolderToEncryptButton, &QPushButton::released, this, &Encryption::selectFolderToEncrypt);
     connect(ui->OutputButton, &QPushButton::released, this, &Encryption::selectOutputFilepath);
     connect(ui->GoButton, &QPushButton::released, this, &Encryption::encrypt);
+    connect(ui->CancelButton, &QPushButton::released, &jobRunner, &JobRunner::cancelAll);
 
 }
 
@@ -120,30 +118,16 @@ bool Encryption::checkUserInput(){
     if(publicKeySelected == false || outputEncryptedFilepathSelected == false){
         return false;
     }
-    if(inputFileSelected == false && ui->InputTextBox->toPlainText().toStdString() == ""){
+    if(fileQueue->getWaitingFiles().empty() == true && ui->InputTextBox->toPlainText().toStdString() == ""){
         return false;
     }
     return true;
 }
 
-publicKey Encryption::initializePublicKey(){
-/***********************************************************************
-* A function which creates a publicKey stucture, and initializes each
-* multiprecision variable.
-*
-* Returns:
-* @ publicKeyStruct: A publicKey structure, named publicKeyStruct, that has been initialised.
-***********************************************************************/
-    publicKey publicKeyStruct;
-    mpz_init(publicKeyStruct.modulus);
-    mpz_init(publicKeyStruct.publicExponent);
-    return publicKeyStruct;
-}
-
 void Encryption::selectPublicKey(){
 /***********************************************************************
 * Opens a file browser for the user to select the PublicKey.pem file
-* If no file is selected the global variable privateKeyFilepath is reset
+* If no file is selected the member variable privateKeyFilepath is reset
 * and privateKeySelected bool is set to false.
 * If a file is selected then the variable gets set to the path of the file
 * and the privateKeySelected bool is set to true.
@@ -193,28 +177,37 @@ void Encryption::setKeyLabel(bool keySelected){
 
 void Encryption::selectFileToEncrypt(){
 /***********************************************************************
-* Opens a file browser for the user to select the file to Encrypt.
-* If no file is selected the global variable encryptedFilepath is reset
-* and encryptedFileSelected is set to false.
-* If a file is selected then the variable gets set to the path of the file
-* and the encryptedFileSelected bool is set to true.
+* Opens a file browser for the user to select the files to encrypt, of any type.
+* Every file selected is added to the fileQueue, and the label is set to
+* a tick once there is a file waiting in it.
 ***********************************************************************/
     QFileDialog fileBrowser;
-    fileBrowser.setFileMode(QFileDialog::ExistingFile);
-    fileBrowser.setNameFilter("*.txt");
-    fileBrowser.setWindowTitle(QObject::tr("Open File To Encrypt..."));
+    fileBrowser.setFileMode(QFileDialog::ExistingFiles);
+    fileBrowser.setWindowTitle(QObject::tr("Open Files To Encrypt..."));
     if(fileBrowser.exec()!=QDialog::Accepted){
         Encryption::outputErrorMessage("Error!", "ERROR: Please select a valid file to encrypt!");
-        inputFilepath= "";
-        inputFileSelected = false;
-        Encryption::setFilepathLabel(false);
     }
     else{
-        QStringList FileLocation = fileBrowser.selectedFiles();
-        inputFilepath = FileLocation.join("").toStdString();
-        inputFileSelected = true;
-        Encryption::setFilepathLabel(true);
+        fileQueue->addFiles(fileBrowser.selectedFiles());
     }
+    Encryption::setFilepathLabel(fileQueue->getWaitingFiles().empty() == false);
+}
+
+void Encryption::selectFolderToEncrypt(){
+/***********************************************************************
+* Opens a file browser for the user to select a folder to encrypt.
+* Every file in the folder, and in the folders inside it, is added to the fileQueue.
+***********************************************************************/
+    QFileDialog fileBrowser;
+    fileBrowser.setFileMode(QFileDialog::Directory);
+    fileBrowser.setWindowTitle(QObject::tr("Open Folder To Encrypt..."));
+    if(fileBrowser.exec()!=QDialog::Accepted){
+        Encryption::outputErrorMessage("Error!", "ERROR: Please select a valid folder to encrypt!");
+    }
+    else if(fileQueue->addFolder(fileBrowser.selectedFiles().join("")) == 0){
+        Encryption::outputErrorMessage("Error!", "ERROR: The folder does not contain any files!");
+    }
+    Encryption::setFilepathLabel(fileQueue->getWaitingFiles().empty() == false);
 }
 
 void Encryption::setFilepathLabel(bool filepathSelected){
@@ -245,15 +238,23 @@ void Encryption::setFilepathLabel(bool filepathSelected){
 void Encryption::selectOutputFilepath(){
 /***********************************************************************
 * Opens a file browser for the user to select the output encrypted file location.
-* If no file is selected the global variable outputEncryptedFilepath is reset
+* If more than one file is queued, a folder is selected instead, which every
+* encrypted file is saved into.
+* If no file is selected the member variable outputEncryptedFilepath is reset
 * and outputEncryptedFilepathSelected is set to false.
 * If a file is selected then the variable gets set to the path of the file location
 * and the outputEncryptedFilepathSelected bool is set to true.
 ***********************************************************************/
     QFileDialog fileBrowser;
-    fileBrowser.setFileMode(QFileDialog::AnyFile);
-    fileBrowser.setNameFilter("*.txt");
-    fileBrowser.setWindowTitle(QObject::tr("Save Encyrpted File..."));
+    if(fileQueue->getWaitingFiles().size() > 1){
+        fileBrowser.setFileMode(QFileDialog::Directory);
+        fileBrowser.setWindowTitle(QObject::tr("Save Encrypted Files To..."));
+    }
+    else{
+        fileBrowser.setFileMode(QFileDialog::AnyFile);
+        fileBrowser.setNameFilter("*.rsa *.txt");
+        fileBrowser.setWindowTitle(QObject::tr("Save Encyrpted File..."));
+    }
     if(fileBrowser.exec()!=QDialog::Accepted){
         Encryption::outputErrorMessage("Error!", "ERROR: Please select a valid path for the Encrypted file to be saved!");
         outputEncryptedFilepath = "";
@@ -262,7 +263,8 @@ void Encryption::selectOutputFilepath(){
     }
     else{
         QStringList FileLocation = fileBrowser.selectedFiles();
-        outputEncryptedFilepath = FileLocation.join("").toStdString() + ".txt";
+        // The extension is added when the file is written, as it depends on whether the output is armoured.
+        outputEncryptedFilepath = FileLocation.join("").toStdString();
         outputEncryptedFilepathSelected = true;
         Encryption::setOutputFilepathLabel(true);
     }
@@ -293,162 +295,196 @@ void Encryption::setOutputFilepathLabel(bool outputFilepathSelected){
     }
 }
 
-std::string Encryption::readFromFile(){
+void Encryption::encrypt(){
 /***********************************************************************
-* This function reads all of the text from a file, using a buffer stream.
-*
-* Returns:
-*  strStream.str(): the text content from the file returned as a string.
+* This function is run when the go button is clicked by the user.
+* It checks the input and loads the public key, then starts a BackgroundJob for every
+* file waiting in the fileQueue (or for the text in the text box, if there are none),
+* so the window stays responsive while they run.
+* Every job shares its blocks out on the sharedWorkScheduler, so the cores keep working
+* on the other files' blocks while a small file is being read or written, instead of
+* one file at a time getting every core.
+* A single file is saved to the selected filepath, several files are saved into the
+* selected folder, keeping their paths relative to any folder they were added from.
+* The progress bar follows the blocks as they are encrypted (or the files, for a batch),
+* and encryptionFinished() outputs the results once the jobs are done.
+* All the filepaths are reset so the program can be run again straight away.
 ***********************************************************************/
-    try {
-        std::ifstream inFile;
-        inFile.open(inputFilepath);
-        std::stringstream strStream;
-        strStream << inFile.rdbuf();
-        return strStream.str();
-    }
-    catch(const std::exception &e){
-        Encryption::outputErrorMessage("Error!", "ERROR: Error when reading from file");
+    if(Encryption::checkUserInput() == false){
+        Encryption::outputErrorMessage("Error!", "ERROR: Please check all input fields and try again!");
+        return;
+    }
+    bool outputToFolder = QFileInfo(QString::fromStdString(outputEncryptedFilepath)).isDir();
+    if(fileQueue->getWaitingFiles().size() > 1 && outputToFolder == false){
+        Encryption::outputErrorMessage("Error!", "ERROR: Please select a folder for the encrypted files to be saved to!");
+        return;
+    }
+    // The key is shared with the jobs, and cleared once the jobs (and this function) no longer need it.
+    std::shared_ptr<publicKey> publicKeyStruct(new publicKey(KeyFile::initializePublicKey()), [](publicKey* keyToClear){
+        KeyFile::clearPublicKey(keyToClear);
+        delete keyToClear;
+    });
+    if(KeyFile::loadPublicKey(publicKeyFilepath, publicKeyStruct.get()) == false){
+        Encryption::outputErrorMessage("Error!", "ERROR: Error when reading PEM file");
         // Goes back to the Menu window to prevent any errors carrying forward in this class.
         Encryption::loadMenu();
+        return;
     }
+    encryptionConfig config;
+    config.encryptionMode = ui->EncryptionModeComboBox->currentIndex();
+    config.armoured = ui->ArmourCheckBox->isChecked();
+    config.scheduler = sharedWorkScheduler;
+    std::string extension = FileEncryptor::getExtension(config.armoured);
+
+    std::vector<int> waitingFiles = fileQueue->startBatch();
+    if(waitingFiles.empty() == true){
+        Encryption::startEncryptionJob(publicKeyStruct, config, "", ui->InputTextBox->toPlainText().toStdString(),
+                                       outputEncryptedFilepath + extension, -1);
+    }
+    for(unsigned int i = 0; i < waitingFiles.size(); i++){
+        const queuedFile &file = fileQueue->getFile(waitingFiles[i]);
+        std::string outputFilepath = outputEncryptedFilepath + extension;
+        if(outputToFolder == true){
+            outputFilepath = outputEncryptedFilepath + "/" + file.outputName + extension;
+            QDir().mkpath(QFileInfo(QString::fromStdString(outputFilepath)).absolutePath());
+        }
+        Encryption::startEncryptionJob(publicKeyStruct, config, file.inputFilepath, "", outputFilepath, waitingFiles[i]);
+    }
+    Encryption::resetWindow();
 }
 
-publicKey Encryption::loadPublicKey(publicKey publicKeyStruct){
+void Encryption::startEncryptionJob(std::shared_ptr<publicKey> publicKeyStruct, const encryptionConfig &config, const std::string &inputFilepath,
+                                    const std::string &plaintext, const std::string &outputFilepath, int queueIndex){
 /***********************************************************************
-* A function which loads the public key from the .pem file the user has selected
-* and then assigns the publicExponent and modulus values to our publicKey structure.
+* Starts a BackgroundJob which encrypts one file (or the text) with encryptToFile().
+* Everything the job needs is copied into it, so it never uses the window.
 *
 * Arguments:
-* @ publicKeyStruct: The initialised, but not-yet assigned privateKey structure.
-*
-* Returns:
-*  privateKeyStruct: The privateKey structure once the values have been assigned from the .pem file.
+*  @ publicKeyStruct: The public key, shared between every job.
+*  @ config: The encryption mode, whether the output is armoured and the WorkScheduler.
+*  @ inputFilepath: The file to encrypt, or "" to encrypt the plaintext instead.
+*  @ plaintext: The text from the text box, used when there is no inputFilepath.
+*  @ outputFilepath: The filepath the container is written to, with its extension.
+*  @ queueIndex: The index of the file in the fileQueue, or -1 for the text.
 ***********************************************************************/
-    try {
-        CryptoPP::FileSource publicKeySource(publicKeyFilepath.c_str(), true);
-        CryptoPP::RSA::PublicKey cryptoPublicKey;
-        CryptoPP::PEM_Load(publicKeySource, cryptoPublicKey);
-
-        CryptoPP::Integer cryptoPublicKeyExponent = cryptoPublicKey.GetPublicExponent();
-        CryptoPP::Integer cryptoPublicKeyModulus = cryptoPublicKey.GetModulus();
-
-        std::ostringstream exponentStream;
-        std::ostringstream modulusStream;
-
-        exponentStream << cryptoPublicKeyExponent;
-        modulusStream << cryptoPublicKeyModulus;
-        std::string exponentString = exponentStream.str();
-        std::string modulusString = modulusStream.str();
-
-        exponentString.pop_back();
-        modulusString.pop_back();
-
-        mpz_set_str(publicKeyStruct.publicExponent, exponentString.c_str(), 10);
-        mpz_set_str(publicKeyStruct.modulus, modulusString.c_str(), 10);
-        return publicKeyStruct;
-    }
-    catch (const std::exception &e){
-        Encryption::outputErrorMessage("Error!", "ERROR: Error when reading PEM file");
-        // Goes back to the Menu window to prevent any errors carrying forward in this class.
-        Encryption::loadMenu();
+    BackgroundJob *job = new BackgroundJob([publicKeyStruct, config, inputFilepath, plaintext, outputFilepath](JobProgress *progress, std::string &message){
+        encryptionConfig jobConfig = config;
+        jobConfig.progress = progress;
+        return Encryption::encryptToFile(publicKeyStruct.get(), jobConfig, inputFilepath, plaintext, outputFilepath, message);
+    });
+    int jobNumber = jobRunner.start(job);
+    if(queueIndex != -1){
+        fileQueue->startFile(queueIndex, jobNumber);
     }
 }
 
-void Encryption::encrypt(){
+bool Encryption::encryptToFile(const publicKey* publicKeyStruct, const encryptionConfig &config, const std::string &inputFilepath,
+                               const std::string &plaintext, const std::string &outputFilepath, std::string &message){
 /***********************************************************************
-* This function is run when the go button is clicked by the user.
-* It essentially calls the other functions in the correct order, with some
-* validation checks along the way
-* A success message is output after encryption has been completed.
-* All the filepaths are reset so the program can be run again.
+* A function which encrypts the selected file (or the text from the text box) with a FileEncryptor
+* into a CiphertextContainer at outputFilepath. It runs on a BackgroundJob's thread, so it only
+* uses what it has been given and never the window.
+* The EncryptionModeComboBox chooses between the hybrid modes, where RSA only encrypts a random
+* key and the file itself is encrypted with AES-256-GCM or ChaCha20-Poly1305 (which is far faster),
+* and RSA Blocks, where every block of the file is encrypted with RSA. Its indexes are the
+* FileEncryptor modes.
+* Binary containers are saved as .rsa files, and armoured ones as .txt files.
+*
+* Arguments:
+*  @ publicKeyStruct: The structure which contains the values needed for encryption.
+*  @ config: The encryption mode, whether the output is armoured and the job's JobProgress.
+*  @ inputFilepath: The file to encrypt, or "" to encrypt the plaintext instead.
+*  @ plaintext: The text from the text box, used when there is no inputFilepath.
+*  @ outputFilepath: The filepath the container is written to, with its extension.
+*  @ message: Set to the message which is shown to the user.
+*
+* Returns:
+*  True: If the encrypted file has been written.
+*  False: If the input could not be read, the output could not be written or the job was cancelled.
 ***********************************************************************/
-    if(Encryption::checkUserInput() == false){
-        Encryption::outputErrorMessage("Error!", "ERROR: Please check all input fields and try again!");
-        return;
+    FileEncryptor fileEncryptor(publicKeyStruct, config);
+    bool encrypted = false;
+    if(inputFilepath.empty() == false){
+        encrypted = fileEncryptor.encryptFile(inputFilepath, outputFilepath);
+    }
+    else{
+        encrypted = fileEncryptor.encryptText(plaintext, outputFilepath);
     }
-    publicKey publicKeyStruct = Encryption::initializePublicKey();
-    publicKeyStruct = Encryption::loadPublicKey(publicKeyStruct);
-    if(inputFileSelected == true){
-        std::string stringFromFile = Encryption::readFromFile();
-        Encryption::encryptString(stringFromFile, publicKeyStruct);
-        b64EncryptedString = macaron::Base64::Encode(encryptedString);
+    if(encrypted == true){
+        message = "File encrypted and written to " + outputFilepath + " successfully!";
     }
-    else if(ui->InputTextBox->toPlainText().toStdString() != ""){
-        Encryption::encryptString(ui->InputTextBox->toPlainText().toStdString(), publicKeyStruct);
-        b64EncryptedString = macaron::Base64::Encode(encryptedString);
+    else if(config.progress != nullptr && config.progress->isCancelled() == true){
+        message = "Encryption of " + outputFilepath + " cancelled.";
     }
     else{
-        Encryption::outputErrorMessage("Error!", "ERROR: Please check all input fields and try again!");
-        return;
+        message = "ERROR: Error when encrypting the file";
     }
-    Encryption::writeEncryptedTextToFile();
-    Encryption::outputSuccessMessage("Success!", "File encrypted and written to filepath successfully!");
-    Encryption::resetWindow();
+    return encrypted;
 }
 
-void Encryption::encryptString(std::string stringToEncrypt, publicKey publicKeyStruct){
+void Encryption::updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total){
 /***********************************************************************
-* A function which iterates through the plaintext string which will be encrypted.
-* Splits the string into blocks of size BLOCK_SIZE / SIZE_OF_CHAR (by default 32 characters).
-* The current block in each iteration gets passed into the encryptBlock() function.
-* The if statement handles the padding of the last block, to ensure it meets the block size.
+* Shows the progress of every running encryption on the progress bar, as a share of
+* all of their blocks, and how many encryptions are running on the status label.
+* While a batch of several files is running, the progress bar shows the share of the
+* files which have finished instead, and the label the batch's throughput.
 *
 * Arguments:
-*  @ stringToEncrypt: The string, read from the inputted file, which will be encrypted.
-*  @ publicKeyStruct: The structure which contains the values needed for encryption.
+* @ numberOfRunningJobs: The number of encryptions which are running (or waiting for a thread).
+* @ done: The number of blocks (or hybrid chunks) which have been encrypted.
+* @ total: The number of blocks (or hybrid chunks) in all of the running encryptions.
 ***********************************************************************/
-    std::string currentBlock = "";
-    while(stringToEncrypt.length() >= static_cast<unsigned long long>((BLOCK_SIZE / SIZE_OF_CHAR))){
-        currentBlock = stringToEncrypt.substr(0, ((BLOCK_SIZE / SIZE_OF_CHAR) - 1));
-        stringToEncrypt.erase(0, (BLOCK_SIZE / SIZE_OF_CHAR));
-        encryptBlock(currentBlock, publicKeyStruct);
-    }
-    if(stringToEncrypt.length() != 0){
-        //This if statement handles the padding, by calculating how much padding is required and adding that many spaces.
-        int paddingRequired = (BLOCK_SIZE / SIZE_OF_CHAR) - stringToEncrypt.length();
-        for(int i = 0; i < paddingRequired; i++){
-            stringToEncrypt += " ";
-        }
-        encryptBlock(stringToEncrypt, publicKeyStruct);
+    if(numberOfRunningJobs == 0){
+        ui->JobProgressBar->setValue(0);
+        ui->JobStatusLabel->setText("No jobs running");
+        return;
     }
+    if(fileQueue->isBatchRunning() == true && fileQueue->getNumberOfFilesInBatch() > 1){
+        ui->JobProgressBar->setValue(fileQueue->getNumberOfFilesFinished() * 1000 / fileQueue->getNumberOfFilesInBatch());
+        ui->JobStatusLabel->setText(QString::fromStdString(std::to_string(numberOfRunningJobs) + " running, " + fileQueue->describeThroughput()));
+        return;
+    }
+    ui->JobProgressBar->setValue((total == 0) ? 0 : static_cast<int>(done * 1000 / total));
+    ui->JobStatusLabel->setText(QString::fromStdString(std::to_string(numberOfRunningJobs) + " running, "
+                                                       + std::to_string(done) + " of " + std::to_string(total) + " blocks encrypted"));
 }
 
-void Encryption::encryptBlock(std::string blockToEncrypt, publicKey publicKeyStruct){
+void Encryption::encryptionFinished(bool succeeded, bool cancelled, QString message, double seconds, int jobNumber){
 /***********************************************************************
-* This function is called iteratively by encryptString, it encrypts the current block
-* which gets passed in the variable "blockToEncrypt".
-* This function assumes padding has already been applied to the blockToEncrypt string
-* Once successfully Encrypted, the encrypted block is concatenated onto the global variable encryptedString.
-* After the encrypted block has been appended to the encryptedString, a delimiter ('/')
-* is used to signify the end of a block (helpful when needing to decrypt).
+* Runs on the GUI thread once an encryption job has returned, and shows its result.
+* The result of each file in a batch is shown in the QueueList, and one message with
+* the batch's throughput is output once every file in it has finished.
 *
 * Arguments:
-*  @ blockToEncrypt: The current block, passed from encryptString function, which needs to be decoded.
-*  @ publicKeyStruct: The structure which contains the values needed for encryption.
+* @ succeeded: Whether the file was encrypted.
+* @ cancelled: Whether the job was cancelled, which only updates the status label.
+* @ message: The message from encryptToFile().
+* @ seconds: The time the job ran for.
+* @ jobNumber: The number of the job, which finds its file in the fileQueue.
 ***********************************************************************/
-    std::string binaryString = "";
-    for (int charCounter = 0; static_cast<unsigned long long>(charCounter) < blockToEncrypt.size(); charCounter++){
-        binaryString += std::bitset<8>(blockToEncrypt[charCounter]).to_string();
+    if(fileQueue->finishFile(jobNumber, succeeded, cancelled, message.toStdString(), seconds) == true
+            && fileQueue->getNumberOfFilesInBatch() > 1){
+        if(fileQueue->isBatchRunning() == false){
+            std::string summary = "Encrypted " + fileQueue->describeThroughput();
+            ui->JobStatusLabel->setText(QString::fromStdString(summary));
+            if(fileQueue->getNumberOfFilesFailed() > 0){
+                summary += "\n" + std::to_string(fileQueue->getNumberOfFilesFailed()) + " files failed or were cancelled, see the queue for details.";
+            }
+            Encryption::outputSuccessMessage("Finished!", summary);
+        }
+        return;
     }
-    mpz_t valueToEncrypt; mpz_init(valueToEncrypt);
-    mpz_t outputValue; mpz_init(outputValue);
-
-    mpz_set_str(valueToEncrypt, binaryString.c_str(), 2);
-    mpz_powm(outputValue, valueToEncrypt, publicKeyStruct.publicExponent, publicKeyStruct.modulus);
-
-    std::string encryptedBlockAsString = mpz_get_str(NULL, 10, outputValue);
-    encryptedString += encryptedBlockAsString + "/";
-}
-
-void Encryption::writeEncryptedTextToFile(){
-/***********************************************************************
-* A function which writes the global variable b64EncryptedString into a file
-* at the location of the contents of global variable outputEncryptedFilepath.
-***********************************************************************/
-    std::ofstream outputFileStream(outputEncryptedFilepath);
-    outputFileStream << b64EncryptedString;
-    outputFileStream.close();
+    if(cancelled == true && succeeded == false){
+        ui->JobStatusLabel->setText(message);
+        return;
+    }
+    if(succeeded == false){
+        Encryption::outputErrorMessage("Error!", message.toStdString());
+        return;
+    }
+    std::ostringstream timeStream;
+    timeStream << std::fixed << std::setprecision(1) << seconds;
+    Encryption::outputSuccessMessage("Success!", message.toStdString() + " (" + timeStream.str() + " seconds)");
 }
 
 void Encryption::outputErrorMessage(std::string windowHeader, std::string messageContent){
@@ -481,14 +517,11 @@ void Encryption::outputSuccessMessage(std::string windowHeader, std::string mess
 
 void Encryption::resetWindow(){
 /***********************************************************************
-* Resets all of the global variables, flags and label images to their default values.
+* Resets all of the filepaths, flags and label images to their default values.
+* The fileQueue is left alone, as its files have either been started or are still waiting.
 ***********************************************************************/
-    encryptedString = "";
-    b64EncryptedString = "";
-    inputFilepath = "";
     publicKeyFilepath = "";
     outputEncryptedFilepath = "";
-    inputFileSelected = false;
     publicKeySelected = false;
     outputEncryptedFilepathSelected = false;
     Encryption::setKeyLabel(false);
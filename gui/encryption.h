@@ -0,0 +1,61 @@
+#ifndef ENCRYPTION_H
+#define ENCRYPTION_H
+
+#include "keyfile.h"
+#include "fileencryptor.h"
+#include "jobprogress.h"
+#include "jobrunner.h"
+#include "filequeue.h"
+#include <gmpxx.h>
+#include <QMainWindow>
+#include <QString>
+#include <memory>
+#include <string>
+
+namespace Ui {
+class Encryption;
+}
+
+class Encryption : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit Encryption(QWidget *parent = nullptr);
+    ~Encryption();
+
+private:
+    Ui::Encryption *ui;
+    FileQueue *fileQueue;
+    std::string publicKeyFilepath;
+    std::string outputEncryptedFilepath;
+    bool publicKeySelected;
+    bool outputEncryptedFilepathSelected;
+    JobRunner jobRunner;
+    void setup();
+    void loadMenu();
+    void addHomeButtonToToolbar();
+    void connectButtons();
+    bool checkUserInput();
+
+    void selectPublicKey();
+    void setKeyLabel(bool keySelected);
+    void selectFileToEncrypt();
+    void selectFolderToEncrypt();
+    void setFilepathLabel(bool filepathSelected);
+    void selectOutputFilepath();
+    void setOutputFilepathLabel(bool outputFilepathSelected);
+
+    void encrypt();
+    void startEncryptionJob(std::shared_ptr<publicKey> publicKeyStruct, const encryptionConfig &config, const std::string &inputFilepath,
+                            const std::string &plaintext, const std::string &outputFilepath, int queueIndex);
+    static bool encryptToFile(const publicKey* publicKeyStruct, const encryptionConfig &config, const std::string &inputFilepath,
+                              const std::string &plaintext, const std::string &outputFilepath, std::string &message);
+    void updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total);
+    void encryptionFinished(bool succeeded, bool cancelled, QString message, double seconds, int jobNumber);
+    void outputErrorMessage(std::string windowHeader, std::string messageContent);
+    void outputSuccessMessage(std::string windowHeader, std::string messageContent);
+    void resetWindow();
+};
+
+#endif // ENCRYPTION_H
@@ -0,0 +1,274 @@
+#include "filequeue.h"
+#include "workscheduler.h"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+WorkScheduler *sharedWorkScheduler = nullptr; // The scheduler every queued file's blocks are shared out on, set up by main().
+
+static const double BYTES_PER_MEGABYTE = 1024.0 * 1024.0; // Used to show sizes and throughput in MB.
+
+FileQueue::FileQueue(QListWidget *queueList){
+/***********************************************************************
+* Constructor for the FileQueue class, the list of files the Encryption and Decryption
+* windows are working through.
+* Every file is started as its own job, and their blocks are all shared out on the
+* sharedWorkScheduler, so the cores move between files instead of waiting for each one.
+* The queueList shows every file, and once it has finished, its throughput.
+*
+* Arguments:
+* @ queueList: The list on the window which the files are shown in.
+***********************************************************************/
+    this->queueList = queueList;
+    this->filesInBatch = 0;
+    this->filesFinished = 0;
+    this->filesFailed = 0;
+    this->bytesFinished = 0;
+}
+
+void FileQueue::addFiles(const QStringList &filepaths){
+/***********************************************************************
+* Adds each file to the queue, its output is named after the file.
+*
+* Arguments:
+* @ filepaths: The files chosen by the user.
+***********************************************************************/
+    for(int i = 0; i < filepaths.size(); i++){
+        FileQueue::addFile(filepaths[i], QFileInfo(filepaths[i]).fileName());
+    }
+}
+
+int FileQueue::addFolder(const QString &folder){
+/***********************************************************************
+* Adds every file in the folder, and in the folders inside it, to the queue. Each output
+* keeps its path relative to the folder, so files with the same name in different
+* folders are not written over each other.
+*
+* Arguments:
+* @ folder: The folder chosen by the user.
+*
+* Returns:
+* @ numberOfFiles: The number of files added.
+***********************************************************************/
+    QDir folderDirectory(folder);
+    QDirIterator iterator(folder, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    int numberOfFiles = 0;
+    while(iterator.hasNext() == true){
+        QString filepath = iterator.next();
+        FileQueue::addFile(filepath, folderDirectory.relativeFilePath(filepath));
+        numberOfFiles++;
+    }
+    return numberOfFiles;
+}
+
+std::vector<int> FileQueue::getWaitingFiles() const{
+/***********************************************************************
+* Returns:
+* @ waitingFiles: The index of every file which has not been started yet.
+***********************************************************************/
+    std::vector<int> waitingFiles;
+    for(unsigned int i = 0; i < files.size(); i++){
+        if(files[i].jobNumber == -1){
+            waitingFiles.push_back(static_cast<int>(i));
+        }
+    }
+    return waitingFiles;
+}
+
+std::vector<int> FileQueue::startBatch(){
+/***********************************************************************
+* Called before the waiting files are started. If nothing is running, a new batch is
+* started, which the aggregate throughput is worked out over, and the files finished
+* by the last batch are cleared from the list. Otherwise the files join the running batch.
+*
+* Returns:
+* @ waitingFiles: The index of every file which has not been started yet.
+***********************************************************************/
+    if(FileQueue::isBatchRunning() == false){
+        FileQueue::removeFinishedFiles();
+        batchStartTime = std::chrono::steady_clock::now();
+        filesInBatch = 0;
+        filesFinished = 0;
+        filesFailed = 0;
+        bytesFinished = 0;
+    }
+    return FileQueue::getWaitingFiles();
+}
+
+const queuedFile& FileQueue::getFile(int index) const{
+/***********************************************************************
+* Arguments:
+* @ index: The index of the file, from startBatch().
+*
+* Returns:
+* @ file: The queued file.
+***********************************************************************/
+    return files[index];
+}
+
+void FileQueue::startFile(int index, int jobNumber){
+/***********************************************************************
+* Records the job a waiting file is being processed by.
+*
+* Arguments:
+* @ index: The index of the file, from startBatch().
+* @ jobNumber: The number JobRunner::start() returned for the file's job.
+***********************************************************************/
+    files[index].jobNumber = jobNumber;
+    filesInBatch++;
+    queueList->item(index)->setText(QString::fromStdString("Queued: " + files[index].inputFilepath));
+}
+
+bool FileQueue::finishFile(int jobNumber, bool succeeded, bool cancelled, const std::string &message, double seconds){
+/***********************************************************************
+* Shows the result of a file's job in the list, with the file's throughput if it succeeded.
+*
+* Arguments:
+* @ jobNumber: The number of the job which has finished.
+* @ succeeded: Whether the file was encrypted or decrypted.
+* @ cancelled: Whether the job was cancelled.
+* @ message: The message from the job.
+* @ seconds: The time the job ran for.
+*
+* Returns:
+*  True: If the job was one of the queued files.
+*  False: If it was not (such as text typed into the Encryption window).
+***********************************************************************/
+    for(unsigned int i = 0; i < files.size(); i++){
+        if(files[i].jobNumber != jobNumber || files[i].finished == true){
+            continue;
+        }
+        files[i].finished = true;
+        filesFinished++;
+        std::string itemText;
+        if(succeeded == true){
+            bytesFinished += files[i].size;
+            itemText = "Done: " + files[i].inputFilepath + " (" + FileQueue::describeRate(files[i].size, seconds) + ")";
+        }
+        else if(cancelled == true){
+            filesFailed++;
+            itemText = "Cancelled: " + files[i].inputFilepath;
+        }
+        else{
+            filesFailed++;
+            itemText = "Failed: " + files[i].inputFilepath + " - " + message;
+        }
+        queueList->item(static_cast<int>(i))->setText(QString::fromStdString(itemText));
+        return true;
+    }
+    return false;
+}
+
+bool FileQueue::isBatchRunning() const{
+/***********************************************************************
+* Returns:
+*  True: If any file which has been started has not finished yet.
+*  False: If every started file has finished.
+***********************************************************************/
+    return filesFinished < filesInBatch;
+}
+
+int FileQueue::getNumberOfFilesInBatch() const{
+/***********************************************************************
+* Returns:
+* @ filesInBatch: The number of files started since nothing was last running.
+***********************************************************************/
+    return filesInBatch;
+}
+
+int FileQueue::getNumberOfFilesFinished() const{
+/***********************************************************************
+* Returns:
+* @ filesFinished: The number of files in the batch which have finished, including the ones which failed.
+***********************************************************************/
+    return filesFinished;
+}
+
+int FileQueue::getNumberOfFilesFailed() const{
+/***********************************************************************
+* Returns:
+* @ filesFailed: The number of files in the batch which failed or were cancelled.
+***********************************************************************/
+    return filesFailed;
+}
+
+std::string FileQueue::describeThroughput() const{
+/***********************************************************************
+* Describes the batch as a whole, the throughput is the size of every file which has
+* been finished over the time since the batch started, so it includes the time the
+* files spent waiting for each other.
+*
+* Returns:
+* @ throughput: e.g. "12 of 40 files, 35.20 MB in 2.1 seconds (16.76 MB/s)".
+***********************************************************************/
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - batchStartTime;
+    return std::to_string(filesFinished) + " of " + std::to_string(filesInBatch) + " files, "
+            + FileQueue::describeRate(bytesFinished, elapsed.count());
+}
+
+void FileQueue::clearWaitingFiles(){
+/***********************************************************************
+* Removes every file which has not been started from the queue and the list.
+***********************************************************************/
+    for(int i = static_cast<int>(files.size()) - 1; i >= 0; i--){
+        if(files[i].jobNumber == -1){
+            files.erase(files.begin() + i);
+            delete queueList->takeItem(i);
+        }
+    }
+}
+
+void FileQueue::addFile(const QString &filepath, const QString &outputName){
+/***********************************************************************
+* Adds a file to the end of the queue, unless it is already waiting in it.
+*
+* Arguments:
+* @ filepath: The file to add.
+* @ outputName: The path of its output, relative to the output folder.
+***********************************************************************/
+    std::string inputFilepath = filepath.toStdString();
+    for(unsigned int i = 0; i < files.size(); i++){
+        if(files[i].inputFilepath == inputFilepath && files[i].jobNumber == -1){
+            return;
+        }
+    }
+    queuedFile file;
+    file.inputFilepath = inputFilepath;
+    file.outputName = outputName.toStdString();
+    file.size = static_cast<unsigned long long>(QFileInfo(filepath).size());
+    files.push_back(file);
+    queueList->addItem(QString::fromStdString("Waiting: " + inputFilepath));
+}
+
+void FileQueue::removeFinishedFiles(){
+/***********************************************************************
+* Removes the files finished by the last batch from the queue and the list.
+***********************************************************************/
+    for(int i = static_cast<int>(files.size()) - 1; i >= 0; i--){
+        if(files[i].finished == true){
+            files.erase(files.begin() + i);
+            delete queueList->takeItem(i);
+        }
+    }
+}
+
+std::string FileQueue::describeRate(unsigned long long bytes, double seconds){
+/***********************************************************************
+* Arguments:
+* @ bytes: The number of bytes processed.
+* @ seconds: The time they took.
+*
+* Returns:
+* @ rate: e.g. "35.20 MB in 2.1 seconds (16.76 MB/s)".
+***********************************************************************/
+    double megabytes = bytes / BYTES_PER_MEGABYTE;
+    std::ostringstream rateStream;
+    rateStream << std::fixed << std::setprecision(2) << megabytes << " MB in " << std::setprecision(1) << seconds << " seconds ("
+               << std::setprecision(2) << ((seconds > 0) ? megabytes / seconds : 0.0) << " MB/s)";
+    return rateStream.str();
+}
@@ -0,0 +1,54 @@
+#ifndef FILEQUEUE_H
+#define FILEQUEUE_H
+
+#include "workscheduler.h"
+#include <QListWidget>
+#include <QString>
+#include <QStringList>
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct queuedFile{
+    std::string inputFilepath; // The file to encrypt or decrypt.
+    std::string outputName; // The path of the output relative to the output folder, before its extension is changed.
+    unsigned long long size = 0; // The size of the input in bytes.
+    int jobNumber = -1; // The number of the job the file is being processed by, -1 while it is waiting.
+    bool finished = false; // Whether the job has returned.
+};
+
+class FileQueue
+{
+public:
+    explicit FileQueue(QListWidget *queueList);
+    void addFiles(const QStringList &filepaths);
+    int addFolder(const QString &folder);
+    std::vector<int> getWaitingFiles() const;
+    std::vector<int> startBatch();
+    const queuedFile& getFile(int index) const;
+    void startFile(int index, int jobNumber);
+    bool finishFile(int jobNumber, bool succeeded, bool cancelled, const std::string &message, double seconds);
+    bool isBatchRunning() const;
+    int getNumberOfFilesInBatch() const;
+    int getNumberOfFilesFinished() const;
+    int getNumberOfFilesFailed() const;
+    std::string describeThroughput() const;
+    void clearWaitingFiles();
+
+private:
+    QListWidget *queueList;
+    std::vector<queuedFile> files;
+    std::chrono::steady_clock::time_point batchStartTime;
+    int filesInBatch;
+    int filesFinished;
+    int filesFailed;
+    unsigned long long bytesFinished;
+
+    void addFile(const QString &filepath, const QString &outputName);
+    void removeFinishedFiles();
+    static std::string describeRate(unsigned long long bytes, double seconds);
+};
+
+extern WorkScheduler *sharedWorkScheduler;
+
+#endif // FILEQUEUE_H
@@ -0,0 +1,113 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++11
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+TARGET = RSA_Project
+CONFIG += static
+QTPLUGIN += qsqloci qgif
+DEFINES += STATIC
+CONFIG += qt static
+QMAKE_LFLAGS += -static-libgcc -static-libstdc++
+
+
+SOURCES += \
+    backgroundjob.cpp \
+    decryption.cpp \
+    encryption.cpp \
+    filequeue.cpp \
+    jobrunner.cpp \
+    keygeneration.cpp \
+    main.cpp \
+    menu.cpp
+
+HEADERS += \
+    backgroundjob.h \
+    decryption.h \
+    encryption.h \
+    filequeue.h \
+    jobrunner.h \
+    keygeneration.h \
+    menu.h
+
+FORMS += \
+    decryption.ui \
+    encryption.ui \
+    keygeneration.ui \
+    menu.ui
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../rsacore/release/ -lrsacore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../rsacore/debug/ -lrsacore
+else:unix: LIBS += -L$$OUT_PWD/../rsacore/ -lrsacore
+
+INCLUDEPATH += $$PWD/.. $$PWD/../rsacore
+DEPENDPATH += $$PWD/../rsacore
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/release/librsacore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/debug/librsacore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/release/rsacore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/debug/rsacore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../rsacore/librsacore.a
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../libs/ -lgmpxx
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../libs/ -lgmpxxd
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libgmpxx.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libgmpxxd.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/gmpxx.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/gmpxxd.lib
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../libs/ -lgmp
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../libs/ -lgmpd
+else:unix: LIBS += -L$$PWD/../libs/ -lgmp
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libgmp.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libgmpd.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/gmp.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/gmpd.lib
+else:unix: PRE_TARGETDEPS += $$PWD/../libs/libgmp.a
+
+DISTFILES += \
+    icons/cross.png \
+    icons/home.png \
+    icons/tick.png
+
+RESOURCES += \
+    resources.qrc
+
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../libs/ -lcryptopp
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../libs/ -lcryptoppd
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../libs/ -lcryptopp
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../libs/ -lcryptoppd
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libcryptopp.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/libcryptoppd.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../libs/cryptopp.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../libs/cryptoppd.lib
+
@@ -0,0 +1,109 @@
+#include "jobrunner.h"
+#include "backgroundjob.h"
+
+#include <algorithm>
+#include <vector>
+#include <QString>
+#include <QThread>
+
+JobRunner::JobRunner(QObject *parent):QObject(parent){
+/***********************************************************************
+* Constructor for the JobRunner class, which runs a window's BackgroundJobs on its own
+* QThreadPool, so the window stays responsive and several jobs can run at the same time.
+* Each window has its own JobRunner, so closing a window only waits for its own jobs.
+*
+* Arguments:
+* @ parent: The QObject which owns the JobRunner, if there is one.
+***********************************************************************/
+    threadPool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+    this->nextJobNumber = 0;
+}
+
+JobRunner::~JobRunner(){
+/***********************************************************************
+* Destructor for the JobRunner class. Cancels every job which is still running and
+* waits for them to return, so no job outlives the window it writes its results to.
+***********************************************************************/
+    JobRunner::cancelAll();
+    threadPool.waitForDone();
+    for(unsigned int i = 0; i < runningJobs.size(); i++){
+        delete runningJobs[i];
+    }
+}
+
+int JobRunner::start(BackgroundJob *job){
+/***********************************************************************
+* Starts a job on the thread pool and takes ownership of it. Its signals are queued onto
+* the GUI thread, where the progress of every running job is added up and its result
+* is passed on with the jobFinished signal.
+* If every thread in the pool is busy, the job waits in the pool's queue until one is free.
+*
+* Arguments:
+* @ job: The job to run, which is deleted once it has finished.
+*
+* Returns:
+* @ jobNumber: The number the job's jobFinished signal is sent with.
+***********************************************************************/
+    int jobNumber = nextJobNumber++;
+    runningJobs.push_back(job);
+    connect(job, &BackgroundJob::progressChanged, this, &JobRunner::updateProgress, Qt::QueuedConnection);
+    connect(job, &BackgroundJob::finished, this, [this, job, jobNumber](bool succeeded, QString message){
+        JobRunner::finishJob(job, jobNumber, succeeded, message);
+    }, Qt::QueuedConnection);
+    threadPool.start(job);
+    JobRunner::updateProgress();
+    return jobNumber;
+}
+
+void JobRunner::cancelAll(){
+/***********************************************************************
+* Cancels every running job. Each one still emits jobFinished, with cancelled set,
+* once it has stopped.
+***********************************************************************/
+    for(unsigned int i = 0; i < runningJobs.size(); i++){
+        runningJobs[i]->cancel();
+    }
+}
+
+int JobRunner::getNumberOfRunningJobs() const{
+/***********************************************************************
+* Returns:
+* @ numberOfRunningJobs: The number of jobs which have been started and have not finished yet.
+***********************************************************************/
+    return static_cast<int>(runningJobs.size());
+}
+
+void JobRunner::updateProgress(){
+/***********************************************************************
+* Adds up the progress of every running job and emits it with the progressChanged signal.
+***********************************************************************/
+    unsigned long long done = 0;
+    unsigned long long total = 0;
+    unsigned long long candidates = 0;
+    for(unsigned int i = 0; i < runningJobs.size(); i++){
+        const JobProgress *progress = runningJobs[i]->getProgress();
+        done += progress->getDone();
+        total += progress->getTotal();
+        candidates += progress->getCandidates();
+    }
+    emit progressChanged(JobRunner::getNumberOfRunningJobs(), done, total, candidates);
+}
+
+void JobRunner::finishJob(BackgroundJob *job, int jobNumber, bool succeeded, QString message){
+/***********************************************************************
+* Runs on the GUI thread once a job has returned. The job is removed from the running jobs
+* and deleted, and its result is passed on to the window.
+*
+* Arguments:
+* @ job: The job which has finished.
+* @ jobNumber: The number start() returned for the job.
+* @ succeeded: Whether its work succeeded.
+* @ message: The message its work set for the user.
+***********************************************************************/
+    runningJobs.erase(std::remove(runningJobs.begin(), runningJobs.end(), job), runningJobs.end());
+    bool cancelled = job->wasCancelled();
+    double seconds = job->getSeconds();
+    job->deleteLater();
+    JobRunner::updateProgress();
+    emit jobFinished(succeeded, cancelled, message, seconds, jobNumber);
+}
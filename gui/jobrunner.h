@@ -0,0 +1,34 @@
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include "backgroundjob.h"
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <vector>
+
+class JobRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JobRunner(QObject *parent = nullptr);
+    ~JobRunner();
+    int start(BackgroundJob *job);
+    void cancelAll();
+    int getNumberOfRunningJobs() const;
+
+signals:
+    void progressChanged(int numberOfRunningJobs, qulonglong done, qulonglong total, qulonglong candidates);
+    void jobFinished(bool succeeded, bool cancelled, QString message, double seconds, int jobNumber);
+
+private:
+    QThreadPool threadPool;
+    std::vector<BackgroundJob*> runningJobs;
+    int nextJobNumber;
+
+    void updateProgress();
+    void finishJob(BackgroundJob *job, int jobNumber, bool succeeded, QString message);
+};
+
+#endif // JOBRUNNER_H
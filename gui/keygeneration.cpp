@@ -0,0 +1,424 @@
+#include "keygeneration.h"
+#include "ui_keygeneration.h"
+#include "menu.h"
+#include "keyfile.h"
+#include "keygenerator.h"
+#include "primepool.h"
+#include "backgroundjob.h"
+#include "jobprogress.h"
+#include <gmpxx.h>
+
+#include <QMessageBox>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <QFileDialog>
+
+PrimePool *sharedPrimePool = nullptr; // The pool the key generation takes primes from, set up by main().
+
+
+
+KeyGeneration::KeyGeneration(QWidget *parent):QMainWindow(parent), ui(new Ui::KeyGeneration){
+/***********************************************************************
+* Constructor for the User Interface,
+* Gets called when the window is initialised, sets up the user interface
+* and calls the setup function.
+***********************************************************************/
+    ui->setupUi(this);
+    this->keyFilepath = "";
+    this->keyFilepathSelected = false;
+    KeyGeneration::setup();
+}
+
+KeyGeneration::~KeyGeneration()
+/***********************************************************************
+* Destructor for the User Interface,
+* Gets called automatically by QT when the UI window is closed.
+***********************************************************************/
+{
+    delete ui;
+}
+
+void KeyGeneration::setup(){
+/***********************************************************************
+* The setup function which does the following:
+* - connects all buttons to their respective functions,
+* - sets labels image to a cross to indicate filepath hasnt been selected,
+* - adds the Home button to the toolbar along the top of the window,
+* - connects the jobRunner's signals, which arrive on the GUI thread, to the progress bar and the result messages.
+***********************************************************************/
+    KeyGeneration::connectButtons();
+    KeyGeneration::setLabelImage(false);
+    KeyGeneration::addHomeButtonToToolbar();
+    connect(&jobRunner, &JobRunner::progressChanged, this, &KeyGeneration::updateJobProgress);
+    connect(&jobRunner, &JobRunner::jobFinished, this, &KeyGeneration::keyGenerationFinished);
+}
+
+
+void KeyGeneration::addHomeButtonToToolbar(){
+/***********************************************************************
+* - Creates a new action for the toolbar.
+* - Assigns the action an icon of home.png and text.
+* - Creates a shortcut so the menu can be opened via Ctrl+M
+* - Adds the action to the toolbar
+* - Connects the action icon to the function loadMenu()
+***********************************************************************/
+    QAction *homeActionButton = new QAction("Home", this);
+    homeActionButton->setText("Go To The Main Menu");
+    homeActionButton->setIcon(QIcon(":/icons/home.png"));
+    homeActionButton->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_M));
+    ui->toolBar->addAction(homeActionButton);
+    connect(homeActionButton, &QAction::triggered, this, &KeyGeneration::loadMenu);
+}
+
+void KeyGeneration::setLabelImage(bool filepathChosen){
+/***********************************************************************
+* Sets the icon to a tick or a cross depending on the value of flag "filepathChosen"
+* whose value is decided whether a valid filepath has been selected.
+*
+* Arguments:
+* @ filepathChosen: A flag which indicates whether to set the icon to a tick or a cross.
+***********************************************************************/
+    QPixmap cross(":/icons/cross.png");
+    cross = cross.scaled(ui->ImageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QPixmap tick(":/icons/tick.png");
+    tick = tick.scaled(ui->ImageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QLabel* ImageLabel = ui->ImageLabel;
+
+    if(filepathChosen==true){
+        ImageLabel->setPixmap(tick);
+        ImageLabel->setMask(tick.mask());
+        ImageLabel->show();
+    }
+    else{
+        ImageLabel->setPixmap(cross);
+        ImageLabel->setMask(cross.mask());
+        ImageLabel->show();
+    }
+}
+
+void KeyGeneration::connectButtons(){
+/***********************************************************************
+* Connects each button to their respective functions:
+* - SelectFilepathButton connected to FilepathButton function
+* - goButton connected to generateKeys funtion
+* - CancelButton connected to the jobRunner's cancelAll function
+***********************************************************************/
+    connect(ui->SelectFilepathButton, &QPushButton::released, this, &KeyGeneration::filepathButton);
+    connect(ui->goButton, &QPushButton::released, this, &KeyGeneration::generateKeys);
+    connect(ui->CancelButton, &QPushButton::released, &jobRunner, &JobRunner::cancelAll);
+}
+
+bool KeyGeneration::checkUserInput(){
+/***********************************************************************
+* A validation function which checks if a value has been selected from
+* the drop down menu, and a filepath has been chosen which doesn't already hold
+* keys with the names the new keys would be saved under.
+*
+* Returns:
+*  True: If the user has choosen a value from the dropdown menu.
+*  False: If the user has not choosen a value, or keys would be overwritten.
+***********************************************************************/
+    std::string dropDownValue = ui->KeySizeComboBox->currentText().toStdString();
+
+    if(dropDownValue == ""){
+        KeyGeneration::outputErrorMessage("ERROR!", "Error: Please select a key size using the drop down menu!");
+        return false;
+    }
+    else if(keyFilepathSelected == false){
+        KeyGeneration::outputErrorMessage("ERROR!", "Error: Please select a filepath for the keys to be saved!");
+        return false;
+    }
+    else if(KeyFile::findExistingBatchKeyFile(keyFilepath, ui->NumberOfKeysSpinBox->value(),
+                                              ui->FileNamingComboBox->currentText() == "Fingerprint").empty() == false){
+        KeyGeneration::outputErrorMessage("ERROR!", "Error: The folder already has keys with the same names, please select another folder so they aren't overwritten!");
+        return false;
+    }
+    else{
+        // This else statement indicates that the validation checks have passed.
+        return true;
+    }
+}
+
+keyGenerationConfig KeyGeneration::getKeyGenerationConfig(){
+/***********************************************************************
+* Reads the key size and the paranoid check box into a keyGenerationConfig for the KeyGenerator,
+* which picks the number of Miller-Rabin rounds from the schedule for the size of the primes,
+* unless the paranoid check box has been ticked.
+*
+* Returns:
+* @ config: The keyGenerationConfig chosen by the user, using the shared PrimePool.
+***********************************************************************/
+    keyGenerationConfig config;
+    config.sizeOfKey = ui->KeySizeComboBox->currentText().toInt();
+    config.paranoidChecks = ui->ParanoidCheckBox->isChecked();
+    config.primePool = sharedPrimePool;
+    return config;
+}
+
+void KeyGeneration::loadMenu(){
+/***********************************************************************
+* Closes the current window widget and loads the menu.
+***********************************************************************/
+    Menu *menuWindow = new Menu;
+    this->~KeyGeneration();
+    //destruct the current window to prevent memory leaks
+    menuWindow->show();
+}
+
+
+void KeyGeneration::filepathButton(){
+/***********************************************************************
+* Opens the file browser, so the user can choose a filepath to save the PEM
+* Files to.
+* The file browser has been Directory file mode, meaning only folders will
+* be shown.
+* If a valid directory is choosen, the keyFilepath member is updated.
+* The label image is set depending on whether a valid outcome is choosen.
+***********************************************************************/
+    QFileDialog fileBrowser;
+    fileBrowser.setFileMode(QFileDialog::Directory);
+    fileBrowser.setWindowTitle(QObject::tr("Save Keys To..."));
+    if(fileBrowser.exec()!=QDialog::Accepted){
+        KeyGeneration::outputErrorMessage("ERROR", "Error: Please select a valid filepath to save the keys!");
+        keyFilepath = "";
+        keyFilepathSelected = false;
+        KeyGeneration::setLabelImage(false);
+    }
+    else{
+        QStringList FileLocation = fileBrowser.selectedFiles();
+        keyFilepath = FileLocation.join("").toStdString();
+        keyFilepathSelected = true;
+        KeyGeneration::setLabelImage(true);
+    }
+}
+
+void KeyGeneration::generateKeys(){
+/***********************************************************************
+* This is the function that gets run when the button on the UI gets pressed.
+* It validates that a keySize has been chosen by the user, and if the check passes
+* then the keys are generated and saved to the chosen folder as a BackgroundJob, so the
+* window stays responsive while the primes are searched for.
+* The progress bar follows the primes as they are found, and a message is output by
+* keyGenerationFinished() once the job is done.
+***********************************************************************/
+    if(checkUserInput() == true){
+        keyGenerationConfig config = KeyGeneration::getKeyGenerationConfig();
+        int numberOfKeys = ui->NumberOfKeysSpinBox->value();
+        bool fingerprintNames = (ui->FileNamingComboBox->currentText() == "Fingerprint");
+        std::string folder = keyFilepath;
+
+        BackgroundJob *job = new BackgroundJob([config, numberOfKeys, fingerprintNames, folder](JobProgress *progress, std::string &message){
+            keyGenerationConfig jobConfig = config;
+            jobConfig.progress = progress;
+            return KeyGeneration::generateAndSaveKeys(jobConfig, numberOfKeys, fingerprintNames, folder, message);
+        });
+        jobRunner.start(job);
+        KeyGeneration::resetWindow();
+    }
+}
+
+bool KeyGeneration::generateAndSaveKeys(const keyGenerationConfig &config, int numberOfKeys, bool fingerprintNames,
+                                        const std::string &keyFilepath, std::string &message){
+/***********************************************************************
+* Generates the keys with the KeyGenerator and saves them to the chosen folder.
+* If more than one key has been asked for, the keys are generated in batch mode instead.
+* It runs on a BackgroundJob's thread, so it only uses what it has been given and never the window.
+*
+* Arguments:
+* @ config: The keyGenerationConfig chosen by the user, with the job's JobProgress.
+* @ numberOfKeys: The number of keypairs to generate.
+* @ fingerprintNames: Whether a batch of keys is named by fingerprint instead of by number.
+* @ keyFilepath: The folder the keys are saved to.
+* @ message: Set to the message which is shown to the user.
+*
+* Returns:
+*  True: If every key has been generated and saved.
+*  False: If a key could not be saved, or the job was cancelled.
+***********************************************************************/
+    KeyGenerator keyGenerator(config);
+    if(numberOfKeys > 1){
+        return KeyGeneration::generateKeyBatch(keyGenerator, numberOfKeys, fingerprintNames, keyFilepath, config.progress, message);
+    }
+    privateKey privateKeyStruct = KeyFile::initializePrivateKey();
+    bool generated = keyGenerator.generatePrivateKey(&privateKeyStruct);
+    bool saved = (generated == true) && KeyGeneration::saveKeyPair(&privateKeyStruct, keyFilepath, "");
+    KeyFile::clearPrivateKey(&privateKeyStruct);
+    if(generated == false){
+        message = "Key generation cancelled.";
+        return false;
+    }
+    if(saved == false){
+        message = "ERROR: Error when writing PEM file, or a key file with the same name already exists";
+        return false;
+    }
+    message = "Keys generated successfully and saved to: " + keyFilepath + "\n" + keyGenerator.describePrimeChecks();
+    return true;
+}
+
+bool KeyGeneration::generateKeyBatch(const KeyGenerator &keyGenerator, int numberOfKeys, bool fingerprintNames,
+                                     const std::string &keyFilepath, JobProgress *progress, std::string &message){
+/***********************************************************************
+* Generates numberOfKeys keypairs at once with KeyGenerator::generateKeyBatch(), which
+* generates a different key on each core.
+* Once every key has been generated, the keys are saved to the chosen folder, named either
+* by number (PublicKey_001.pem, PrivateKey_001.pem, ...) or by the fingerprint of the public key,
+* and the throughput is given in keys per minute.
+* If the job is cancelled, none of the keys are saved.
+*
+* Arguments:
+* @ keyGenerator: The KeyGenerator set up with the options chosen by the user.
+* @ numberOfKeys: The number of keypairs to generate.
+* @ fingerprintNames: Whether the keys are named by fingerprint instead of by number.
+* @ keyFilepath: The folder the keys are saved to.
+* @ progress: The job's JobProgress.
+* @ message: Set to the message which is shown to the user.
+*
+* Returns:
+*  True: If every key has been generated and saved.
+*  False: If a key could not be saved, or the job was cancelled.
+***********************************************************************/
+    std::vector<privateKey> privateKeyStructs(numberOfKeys);
+    for(int i = 0; i < numberOfKeys; i++){
+        privateKeyStructs[i] = KeyFile::initializePrivateKey();
+    }
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    unsigned int numberOfThreads = keyGenerator.generateKeyBatch(privateKeyStructs);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    bool cancelled = progress->isCancelled();
+    bool saved = true;
+    for(int i = 0; i < numberOfKeys; i++){
+        if(cancelled == false && saved == true){
+            publicKey publicKeyStruct = KeyFile::initializePublicKey();
+            KeyFile::getPublicKey(&publicKeyStruct, &privateKeyStructs[i]);
+            std::string keyName = KeyFile::batchKeyName(&publicKeyStruct, i + 1, numberOfKeys, fingerprintNames);
+            KeyFile::clearPublicKey(&publicKeyStruct);
+            saved = KeyGeneration::saveKeyPair(&privateKeyStructs[i], keyFilepath, "_" + keyName);
+        }
+        KeyFile::clearPrivateKey(&privateKeyStructs[i]);
+    }
+    if(cancelled == true){
+        message = "Key generation cancelled, no keys were saved.";
+        return false;
+    }
+    if(saved == false){
+        message = "ERROR: Error when writing PEM file, or a key file with the same name already exists";
+        return false;
+    }
+
+    double keysPerMinute = numberOfKeys * 60.0 / elapsed.count();
+    std::ostringstream throughputStream;
+    throughputStream << std::fixed << std::setprecision(1) << elapsed.count() << " seconds ("
+                     << keysPerMinute << " keys per minute on " << numberOfThreads << " threads)";
+    message = std::to_string(numberOfKeys) + " keypairs generated in " + throughputStream.str()
+            + " and saved to: " + keyFilepath + "\n" + keyGenerator.describePrimeChecks();
+    return true;
+}
+
+bool KeyGeneration::saveKeyPair(privateKey* privateKeyStruct, const std::string &keyFilepath, std::string keyName){
+/***********************************************************************
+* Saves a keypair to PublicKey<keyName>.pem and PrivateKey<keyName>.pem in the chosen folder.
+* A key file which already exists is never written over.
+*
+* Arguments:
+* @ privateKeyStruct: The generated private key, the public key is taken from it.
+* @ keyFilepath: The folder the keys are saved to.
+* @ keyName: The text added to the end of the file names, "" for a single keypair.
+*
+* Returns:
+*  True: If both keys have been saved.
+*  False: If there was an error writing a file, or one of them already exists.
+***********************************************************************/
+    if(KeyFile::findExistingKeyFile(keyFilepath, keyName).empty() == false){
+        return false;
+    }
+    publicKey publicKeyStruct = KeyFile::initializePublicKey();
+    KeyFile::getPublicKey(&publicKeyStruct, privateKeyStruct);
+    bool saved = KeyFile::savePublicKey(keyFilepath + "/PublicKey" + keyName + ".pem", &publicKeyStruct)
+            && KeyFile::savePrivateKey(keyFilepath + "/PrivateKey" + keyName + ".pem", privateKeyStruct);
+    KeyFile::clearPublicKey(&publicKeyStruct);
+    return saved;
+}
+
+void KeyGeneration::updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total, qulonglong candidates){
+/***********************************************************************
+* Shows the progress of every running key generation on the progress bar, as a share of
+* the primes they need (two per key), and the number of candidates tested on the status label.
+*
+* Arguments:
+* @ numberOfRunningJobs: The number of key generations which are running.
+* @ done: The number of primes which have been found.
+* @ total: The number of primes needed by all of the running key generations.
+* @ candidates: The number of candidates which have been tested for primality.
+***********************************************************************/
+    if(numberOfRunningJobs == 0){
+        ui->JobProgressBar->setValue(0);
+        ui->JobStatusLabel->setText("No jobs running");
+        return;
+    }
+    ui->JobProgressBar->setValue((total == 0) ? 0 : static_cast<int>(done * 1000 / total));
+    ui->JobStatusLabel->setText(QString::fromStdString(std::to_string(numberOfRunningJobs) + " running, "
+                                                       + std::to_string(done) + " of " + std::to_string(total) + " primes found, "
+                                                       + std::to_string(candidates) + " candidates tested"));
+}
+
+void KeyGeneration::keyGenerationFinished(bool succeeded, bool cancelled, QString message){
+/***********************************************************************
+* Runs on the GUI thread once a key generation job has returned, and shows its result.
+*
+* Arguments:
+* @ succeeded: Whether the keys were generated and saved.
+* @ cancelled: Whether the job was cancelled, which only updates the status label.
+* @ message: The message from generateAndSaveKeys().
+***********************************************************************/
+    if(cancelled == true && succeeded == false){
+        ui->JobStatusLabel->setText(message);
+        return;
+    }
+    if(succeeded == false){
+        KeyGeneration::outputErrorMessage("Error!", message.toStdString());
+        return;
+    }
+    KeyGeneration::outputSuccessMessage("Success!", message.toStdString());
+}
+
+void KeyGeneration::outputErrorMessage(std::string windowHeader, std::string messageContent){
+/***********************************************************************
+* A function which handles the error outputting.
+*
+* Arguments:
+* @ windowHeader: The title of the window of the error box.
+* @ messageContent: The message which will be shown in the error message box.
+***********************************************************************/
+    QMessageBox messageBox;
+    messageBox.critical(0,QString::fromStdString(windowHeader),QString::fromStdString(messageContent));
+    messageBox.setFixedSize(500,200);
+}
+
+void KeyGeneration::outputSuccessMessage(std::string windowHeader, std::string messageContent){
+/***********************************************************************
+* A function which outputs a success message to the user.
+*
+* Arguments:
+* @ windowHeader: The title of the window of the success box.
+* @ messageContent: The message which will be shown in the success box.
+***********************************************************************/
+    QMessageBox messageBox;
+    messageBox.setWindowTitle(QString::fromStdString(windowHeader));
+    messageBox.setText(QString::fromStdString(messageContent));
+    messageBox.setFixedSize(500,200);
+    messageBox.exec();
+}
+
+void KeyGeneration::resetWindow(){
+/***********************************************************************
+* Resets the filepath, its flag and the label image to their default values.
+***********************************************************************/
+    keyFilepath = "";
+    keyFilepathSelected = false;
+    KeyGeneration::setLabelImage(false);
+}
@@ -0,0 +1,54 @@
+#ifndef KEYGENERATION_H
+#define KEYGENERATION_H
+
+#include "keyfile.h"
+#include "keygenerator.h"
+#include "primepool.h"
+#include "jobprogress.h"
+#include "jobrunner.h"
+#include <gmpxx.h>
+#include <QMainWindow>
+#include <QString>
+#include <string>
+
+namespace Ui {
+class KeyGeneration;
+}
+
+class KeyGeneration : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit KeyGeneration(QWidget *parent = nullptr);
+    ~KeyGeneration();
+
+private:
+    Ui::KeyGeneration *ui;
+    std::string keyFilepath;
+    bool keyFilepathSelected;
+    JobRunner jobRunner;
+    void setup();
+    void addHomeButtonToToolbar();
+    void setLabelImage(bool filepathChosen);
+    void connectButtons();
+    bool checkUserInput();
+    keyGenerationConfig getKeyGenerationConfig();
+    void loadMenu();
+    void filepathButton();
+    void generateKeys();
+    static bool generateAndSaveKeys(const keyGenerationConfig &config, int numberOfKeys, bool fingerprintNames,
+                                    const std::string &keyFilepath, std::string &message);
+    static bool generateKeyBatch(const KeyGenerator &keyGenerator, int numberOfKeys, bool fingerprintNames,
+                                 const std::string &keyFilepath, JobProgress *progress, std::string &message);
+    static bool saveKeyPair(privateKey* privateKeyStruct, const std::string &keyFilepath, std::string keyName);
+    void updateJobProgress(int numberOfRunningJobs, qulonglong done, qulonglong total, qulonglong candidates);
+    void keyGenerationFinished(bool succeeded, bool cancelled, QString message);
+    void outputErrorMessage(std::string windowHeader, std::string messageContent);
+    void outputSuccessMessage(std::string windowHeader, std::string messageContent);
+    void resetWindow();
+};
+
+extern PrimePool *sharedPrimePool;
+
+#endif // KEYGENERATION_H
@@ -0,0 +1,44 @@
+#include "menu.h"
+#include "keygeneration.h"
+#include "primepool.h"
+#include "filequeue.h"
+#include "workscheduler.h"
+#include <QtPlugin>
+#include <QApplication>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+
+int main(int argc, char *argv[]){
+/***********************************************************************
+* Creates an instance of the Menu class, executes and shows the main window.
+* The PrimePool is started first, so primes are being generated in the background
+* while the user is still in the menu. Its depth, refill threshold and number of workers
+* can be changed in the PrimePool group of the application's settings.
+* The WorkScheduler, which the blocks of every file being encrypted or decrypted are
+* shared out on, is started too, with one thread per core unless WorkScheduler/threads is set.
+***********************************************************************/
+    QApplication application(argc, argv);
+    QCoreApplication::setOrganizationName("RSA_Project");
+    QCoreApplication::setApplicationName("RSA_Project");
+
+    QString cacheFolder = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(cacheFolder);
+    QSettings settings;
+    PrimePool primePool(QDir(cacheFolder).filePath("primepool.cache").toStdString(),
+                        {64, 128, 256, 512, 1024, 2048}, // Half of each size in the KeySizeComboBox.
+                        settings.value("PrimePool/depth", 8).toInt(),
+                        settings.value("PrimePool/refillThreshold", 4).toInt(),
+                        settings.value("PrimePool/workers", 1).toUInt());
+    primePool.start();
+    sharedPrimePool = &primePool;
+    WorkScheduler workScheduler(settings.value("WorkScheduler/threads", 0).toUInt());
+    sharedWorkScheduler = &workScheduler;
+
+    Menu menuWindow;
+    menuWindow.show();
+    int result = application.exec();
+    sharedPrimePool = nullptr;
+    sharedWorkScheduler = nullptr;
+    return result;
+}
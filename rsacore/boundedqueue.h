@@ -0,0 +1,63 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+template <typename T>
+class BoundedQueue
+{
+/***********************************************************************
+* A first in, first out queue shared between threads, which holds at most
+* capacity items. push() waits while the queue is full and pop() waits while it
+* is empty, so a fast stage of a pipeline can never get more than capacity items
+* ahead of a slow one, which keeps the memory used by the pipeline fixed.
+* close() wakes every waiting thread: pop() still returns the items left in the
+* queue, then returns false, and push() returns false straight away.
+***********************************************************************/
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity == 0 ? 1 : capacity), closed(false) {}
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    bool push(T item){
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notFull.wait(lock, [this]{ return closed == true || items.size() < capacity; });
+        if(closed == true){
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T &item){
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notEmpty.wait(lock, [this]{ return closed == true || items.empty() == false; });
+        if(items.empty() == true){
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close(){
+        std::lock_guard<std::mutex> lock(queueMutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed;
+    std::deque<T> items;
+    std::mutex queueMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,333 @@
+#include "ciphertextcontainer.h"
+#include "integerbridge.h"
+#include <gmpxx.h>
+
+#include <cryptopp/rsa.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/base64.h>
+#include <algorithm>
+#include <string>
+
+static const std::string CONTAINER_MAGIC = "RSAC"; // The first bytes of every binary ciphertext file.
+static const std::string ARMOUR_BEGIN = "-----BEGIN RSA_PROJECT ENCRYPTED MESSAGE-----"; // The first line of an armoured file.
+static const std::string ARMOUR_END = "-----END RSA_PROJECT ENCRYPTED MESSAGE-----"; // The last line of an armoured file.
+static const size_t ARMOUR_LINE_LENGTH = 64; // The number of base64 characters on each armoured line.
+static const size_t ARMOUR_LINE_BYTES = ARMOUR_LINE_LENGTH / 4 * 3; // The number of container bytes on each armoured line.
+
+const size_t CiphertextContainer::HEADER_SIZE;
+const size_t CiphertextContainer::FINGERPRINT_SIZE;
+const unsigned int CiphertextContainer::BLOCK_VERSION;
+const unsigned int CiphertextContainer::HYBRID_VERSION;
+
+std::string CiphertextContainer::keyFingerprint(const mpz_t modulus, const mpz_t publicExponent){
+/***********************************************************************
+* Works out the fingerprint of a public key, which is stored in the header so decryption
+* can tell straight away whether a file was encrypted for the key it has been given.
+* The fingerprint is the first FINGERPRINT_SIZE bytes of the SHA-256 hash of the DER
+* encoded public key, which is the same fingerprint the batch key generation names files with.
+*
+* Arguments:
+* @ modulus: The modulus (n) of the key.
+* @ publicExponent: The public exponent (e) of the key.
+*
+* Returns:
+* @ fingerprint: The FINGERPRINT_SIZE byte fingerprint.
+***********************************************************************/
+    CryptoPP::RSA::PublicKey cryptoPublicKey;
+    cryptoPublicKey.SetModulus(IntegerBridge::mpzToInteger(modulus));
+    cryptoPublicKey.SetPublicExponent(IntegerBridge::mpzToInteger(publicExponent));
+
+    std::string encodedKey;
+    CryptoPP::StringSink encodedKeySink(encodedKey);
+    cryptoPublicKey.DEREncode(encodedKeySink);
+
+    std::string hash;
+    CryptoPP::SHA256 sha256;
+    CryptoPP::StringSource(encodedKey, true, new CryptoPP::HashFilter(sha256, new CryptoPP::StringSink(hash)));
+    return hash.substr(0, FINGERPRINT_SIZE);
+}
+
+std::string CiphertextContainer::writeHeader(const ciphertextHeader &header){
+/***********************************************************************
+* Lays out the HEADER_SIZE byte header, all numbers are big endian:
+* - 4 bytes: CONTAINER_MAGIC ("RSAC")
+* - 1 byte: version
+* - 1 byte: cipher (only used by HYBRID_VERSION, zero otherwise)
+* - 2 bytes: reserved, always zero
+* - 8 bytes: key fingerprint
+* - 4 bytes: block size (plaintext bytes in each block)
+* - 4 bytes: encrypted block size (k, the number of bytes in the modulus)
+* - 8 bytes: number of blocks
+* In a BLOCK_VERSION container the encrypted blocks follow straight after, each exactly
+* k bytes, so block i starts at HEADER_SIZE + i * k.
+* In a HYBRID_VERSION container the "blocks" are the chunks of the symmetric payload, and
+* the block size is the number of plaintext bytes in each chunk. The header is followed by
+* the k byte RSA encrypted secret, and then by each chunk with its authentication tag.
+*
+* Arguments:
+* @ header: The values to write.
+*
+* Returns:
+* @ headerBytes: The HEADER_SIZE bytes of the header.
+***********************************************************************/
+    std::string headerBytes = CONTAINER_MAGIC;
+    headerBytes += static_cast<char>(header.version);
+    headerBytes += static_cast<char>(header.version == HYBRID_VERSION ? header.cipher : 0);
+    headerBytes.append(2, '\0');
+    headerBytes += header.keyFingerprint.substr(0, FINGERPRINT_SIZE);
+    headerBytes.append(FINGERPRINT_SIZE - std::min(header.keyFingerprint.size(), FINGERPRINT_SIZE), '\0');
+    for(int i = 3; i >= 0; i--){
+        headerBytes += static_cast<char>((header.blockSize >> (8 * i)) & 0xFF);
+    }
+    for(int i = 3; i >= 0; i--){
+        headerBytes += static_cast<char>((header.encryptedBlockSize >> (8 * i)) & 0xFF);
+    }
+    for(int i = 7; i >= 0; i--){
+        headerBytes += static_cast<char>((header.numberOfBlocks >> (8 * i)) & 0xFF);
+    }
+    return headerBytes;
+}
+
+bool CiphertextContainer::readHeader(const std::string &container, ciphertextHeader &header){
+/***********************************************************************
+* Reads the header written by writeHeader().
+*
+* Arguments:
+* @ container: The contents of the binary ciphertext file.
+* @ header: The structure the values are read into.
+*
+* Returns:
+*  True: If the header has been read.
+*  False: If the data is not a container, or was written by a newer version of the program.
+***********************************************************************/
+    if(CiphertextContainer::isContainer(container) == false){
+        return false;
+    }
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(container.data());
+    if(bytes[4] != BLOCK_VERSION && bytes[4] != HYBRID_VERSION){
+        return false;
+    }
+    header.version = bytes[4];
+    header.cipher = bytes[5];
+    header.keyFingerprint = container.substr(8, FINGERPRINT_SIZE);
+    header.blockSize = 0;
+    header.encryptedBlockSize = 0;
+    header.numberOfBlocks = 0;
+    for(int i = 0; i < 4; i++){
+        header.blockSize = (header.blockSize << 8) | bytes[16 + i];
+        header.encryptedBlockSize = (header.encryptedBlockSize << 8) | bytes[20 + i];
+    }
+    for(int i = 0; i < 8; i++){
+        header.numberOfBlocks = (header.numberOfBlocks << 8) | bytes[24 + i];
+    }
+    return true;
+}
+
+bool CiphertextContainer::isContainer(const std::string &data){
+/***********************************************************************
+* Returns:
+*  True: If the data starts with a container header.
+*  False: If the data is something else, such as a file from an older version of the program.
+***********************************************************************/
+    return data.size() >= HEADER_SIZE && data.compare(0, CONTAINER_MAGIC.size(), CONTAINER_MAGIC) == 0;
+}
+
+std::string CiphertextContainer::addArmour(const std::string &container){
+/***********************************************************************
+* Base64 encodes the container between ARMOUR_BEGIN and ARMOUR_END lines, with
+* ARMOUR_LINE_LENGTH characters on each line, so it can be pasted into an email or text box.
+*
+* Arguments:
+* @ container: The binary container.
+*
+* Returns:
+* @ armouredText: The armoured text.
+***********************************************************************/
+    ArmourEncoder armourEncoder;
+    std::string armouredText = armourEncoder.encode(container);
+    armouredText += armourEncoder.finish();
+    return armouredText;
+}
+
+bool CiphertextContainer::isArmoured(const std::string &data){
+/***********************************************************************
+* Returns:
+*  True: If the data starts with the ARMOUR_BEGIN line.
+*  False: If it does not.
+***********************************************************************/
+    return data.compare(0, ARMOUR_BEGIN.size(), ARMOUR_BEGIN) == 0;
+}
+
+bool CiphertextContainer::removeArmour(const std::string &armouredText, std::string &container){
+/***********************************************************************
+* Reverses addArmour(), any line endings or spaces between the lines are ignored.
+*
+* Arguments:
+* @ armouredText: The armoured text read from the file.
+* @ container: The string the binary container is written to.
+*
+* Returns:
+*  True: If the armour has been removed.
+*  False: If the text is not valid armour.
+***********************************************************************/
+    ArmourDecoder armourDecoder;
+    container.clear();
+    return armourDecoder.decode(armouredText, container) == true && armourDecoder.finish() == true;
+}
+
+ArmourEncoder::ArmourEncoder(){
+/***********************************************************************
+* Constructor for the ArmourEncoder class, which writes the same armour as
+* CiphertextContainer::addArmour() a piece at a time, so a container can be
+* armoured as it is being written without holding all of it in memory.
+***********************************************************************/
+    started = false;
+}
+
+std::string ArmourEncoder::encode(const std::string &bytes){
+/***********************************************************************
+* Encodes the next part of the container. Only whole lines are returned, any bytes
+* left over are kept until the next call or finish().
+*
+* Arguments:
+* @ bytes: The next bytes of the container.
+*
+* Returns:
+* @ armouredText: The ARMOUR_BEGIN line (on the first call) and every complete line.
+***********************************************************************/
+    std::string armouredText;
+    if(started == false){
+        armouredText = ARMOUR_BEGIN + "\n";
+        started = true;
+    }
+    leftoverBytes += bytes;
+    size_t wholeLineBytes = leftoverBytes.size() / ARMOUR_LINE_BYTES * ARMOUR_LINE_BYTES;
+    if(wholeLineBytes == 0){
+        return armouredText;
+    }
+
+    std::string encoded;
+    CryptoPP::StringSource(reinterpret_cast<const CryptoPP::byte*>(leftoverBytes.data()), wholeLineBytes, true,
+                           new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded), false));
+    leftoverBytes.erase(0, wholeLineBytes);
+    armouredText.reserve(armouredText.size() + encoded.size() + encoded.size() / ARMOUR_LINE_LENGTH);
+    for(size_t lineStart = 0; lineStart < encoded.size(); lineStart += ARMOUR_LINE_LENGTH){
+        armouredText.append(encoded, lineStart, ARMOUR_LINE_LENGTH);
+        armouredText += '\n';
+    }
+    return armouredText;
+}
+
+std::string ArmourEncoder::finish(){
+/***********************************************************************
+* Encodes the bytes which are left over as the last (shorter) line.
+*
+* Returns:
+* @ armouredText: The last line and the ARMOUR_END line.
+***********************************************************************/
+    std::string armouredText;
+    if(started == false){
+        armouredText = ARMOUR_BEGIN + "\n";
+        started = true;
+    }
+    if(leftoverBytes.empty() == false){
+        CryptoPP::StringSource(leftoverBytes, true, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(armouredText), false));
+        armouredText += '\n';
+        leftoverBytes.clear();
+    }
+    armouredText += ARMOUR_END + "\n";
+    return armouredText;
+}
+
+ArmourDecoder::ArmourDecoder(){
+/***********************************************************************
+* Constructor for the ArmourDecoder class, which reverses the ArmourEncoder a piece
+* at a time, so an armoured file can be decrypted as it is read without holding
+* all of it (or the decoded container) in memory.
+***********************************************************************/
+    started = false;
+    ended = false;
+}
+
+bool ArmourDecoder::decode(const std::string &text, std::string &bytes){
+/***********************************************************************
+* Decodes the next part of the armoured text. Line endings and spaces are ignored,
+* and base64 characters are decoded four at a time, any left over are kept until the
+* next call. The ARMOUR_END line starts with '-', which is not a base64 character,
+* so it is found even when it is split between two calls. Anything after it is ignored.
+*
+* Arguments:
+* @ text: The next part of the armoured text.
+* @ bytes: The string the decoded container bytes are added onto.
+*
+* Returns:
+*  True: If the text so far is valid armour.
+*  False: If the text does not start with the ARMOUR_BEGIN line, or contains a character which is not base64.
+***********************************************************************/
+    const std::string *textToDecode = &text;
+    std::string textAfterBegin;
+    if(started == false){
+        beginText += text;
+        size_t comparedLength = std::min(beginText.size(), ARMOUR_BEGIN.size());
+        if(beginText.compare(0, comparedLength, ARMOUR_BEGIN, 0, comparedLength) != 0){
+            return false;
+        }
+        if(beginText.size() < ARMOUR_BEGIN.size()){
+            return true;
+        }
+        textAfterBegin = beginText.substr(ARMOUR_BEGIN.size());
+        textToDecode = &textAfterBegin;
+        beginText.clear();
+        started = true;
+    }
+
+    for(size_t i = 0; i < textToDecode->size(); i++){
+        char currentChar = (*textToDecode)[i];
+        if(ended == true){
+            if(endText.size() >= ARMOUR_END.size()){
+                break;
+            }
+            endText += currentChar;
+        }
+        else if(currentChar == '-'){
+            ended = true;
+            endText += currentChar;
+        }
+        else if(currentChar != '\n' && currentChar != '\r' && currentChar != ' ' && currentChar != '\t'){
+            if(ArmourDecoder::isBase64Character(currentChar) == false){
+                return false;
+            }
+            leftoverCharacters += currentChar;
+        }
+    }
+
+    size_t wholeQuantumCharacters = leftoverCharacters.size() / 4 * 4;
+    if(wholeQuantumCharacters != 0){
+        CryptoPP::StringSource(reinterpret_cast<const CryptoPP::byte*>(leftoverCharacters.data()), wholeQuantumCharacters, true,
+                               new CryptoPP::Base64Decoder(new CryptoPP::StringSink(bytes)));
+        leftoverCharacters.erase(0, wholeQuantumCharacters);
+    }
+    return true;
+}
+
+bool ArmourDecoder::finish(){
+/***********************************************************************
+* Checks the armour was complete once all of the text has been passed to decode().
+*
+* Returns:
+*  True: If the ARMOUR_END line was found and no base64 characters are left over.
+*  False: If the armour was cut short.
+***********************************************************************/
+    return started == true && ended == true && endText == ARMOUR_END && leftoverCharacters.empty() == true;
+}
+
+bool ArmourDecoder::isBase64Character(char character){
+/***********************************************************************
+* Returns:
+*  True: If the character can appear in base64 encoded text (including the '=' padding).
+*  False: If it cannot.
+***********************************************************************/
+    return (character >= 'A' && character <= 'Z') || (character >= 'a' && character <= 'z')
+            || (character >= '0' && character <= '9') || character == '+' || character == '/' || character == '=';
+}
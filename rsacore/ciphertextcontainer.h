@@ -0,0 +1,62 @@
+#ifndef CIPHERTEXTCONTAINER_H
+#define CIPHERTEXTCONTAINER_H
+
+#include <gmpxx.h>
+#include <string>
+
+struct ciphertextHeader{
+    unsigned int version;
+    unsigned int cipher;
+    std::string keyFingerprint;
+    unsigned int blockSize;
+    unsigned int encryptedBlockSize;
+    unsigned long long numberOfBlocks;
+};
+
+class CiphertextContainer
+{
+public:
+    static const size_t HEADER_SIZE = 32;
+    static const size_t FINGERPRINT_SIZE = 8;
+    static const unsigned int BLOCK_VERSION = 1;
+    static const unsigned int HYBRID_VERSION = 2;
+
+    static std::string keyFingerprint(const mpz_t modulus, const mpz_t publicExponent);
+    static std::string writeHeader(const ciphertextHeader &header);
+    static bool readHeader(const std::string &container, ciphertextHeader &header);
+    static bool isContainer(const std::string &data);
+    static std::string addArmour(const std::string &container);
+    static bool isArmoured(const std::string &data);
+    static bool removeArmour(const std::string &armouredText, std::string &container);
+};
+
+class ArmourEncoder
+{
+public:
+    ArmourEncoder();
+    std::string encode(const std::string &bytes);
+    std::string finish();
+
+private:
+    std::string leftoverBytes;
+    bool started;
+};
+
+class ArmourDecoder
+{
+public:
+    ArmourDecoder();
+    bool decode(const std::string &text, std::string &bytes);
+    bool finish();
+
+private:
+    std::string beginText;
+    std::string leftoverCharacters;
+    std::string endText;
+    bool started;
+    bool ended;
+
+    static bool isBase64Character(char character);
+};
+
+#endif // CIPHERTEXTCONTAINER_H
@@ -0,0 +1,353 @@
+#include "decryptionengine.h"
+#include <gmpxx.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static size_t BLOCKS_PER_RANGE = 8; // The number of blocks a worker takes at a time, one full MultiBufferModExp batch.
+
+DecryptionEngine::DecryptionEngine(const mpz_t modulus, const mpz_t privateExponent, const mpz_t prime1, const mpz_t prime2,
+                                   const mpz_t exponent1, const mpz_t exponent2, const mpz_t coefficient, unsigned int numberOfThreads,
+                                   WorkScheduler *scheduler){
+/***********************************************************************
+* Constructor for the DecryptionEngine class, which decrypts the blocks of a
+* message with a private key using every core of the machine.
+*
+* Arguments:
+* @ modulus: The modulus (n) of the private key.
+* @ privateExponent: The private exponent (d), used when the CRT values are not available.
+* @ prime1, prime2: The primes (p and q) of the private key.
+* @ exponent1, exponent2: The Chinese Remainder Theorem exponents (dP and dQ).
+* @ coefficient: The Chinese Remainder Theorem coefficient (qInv), 0 if the CRT values are not available.
+* @ numberOfThreads: The number of worker threads to use, 0 uses one per core.
+* @ scheduler: The WorkScheduler the workers run on, or nullptr to start threads for each chunk.
+***********************************************************************/
+    this->modulus = mpz_class(modulus);
+    this->scheduler = scheduler;
+    this->privateExponent = mpz_class(privateExponent);
+    this->prime1 = mpz_class(prime1);
+    this->prime2 = mpz_class(prime2);
+    this->exponent1 = mpz_class(exponent1);
+    this->exponent2 = mpz_class(exponent2);
+    this->coefficient = mpz_class(coefficient);
+    // Only the contexts which decryptBatch() will use are set up.
+    if(mpz_sgn(coefficient) != 0){
+        this->primeContext1.setKey(prime1, exponent1);
+        this->primeContext2.setKey(prime2, exponent2);
+    }
+    else{
+        this->privateContext.setKey(modulus, privateExponent);
+    }
+    this->encryptedBlockSize = (mpz_sizeinbase(modulus, 2) + 7) / 8;
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 when the number of cores cannot be worked out.
+    this->numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+}
+
+unsigned int DecryptionEngine::getNumberOfThreads() const{
+/***********************************************************************
+* Returns:
+*  numberOfThreads: The number of worker threads the blocks are shared between.
+***********************************************************************/
+    return numberOfThreads;
+}
+
+WorkScheduler* DecryptionEngine::getScheduler() const{
+/***********************************************************************
+* Returns:
+*  scheduler: The WorkScheduler the workers run on, or nullptr if threads are started for each chunk.
+***********************************************************************/
+    return scheduler;
+}
+
+size_t DecryptionEngine::getEncryptedBlockSize() const{
+/***********************************************************************
+* Returns:
+*  encryptedBlockSize: The number of bytes each fixed width encrypted block takes up (k, the size of the modulus).
+***********************************************************************/
+    return encryptedBlockSize;
+}
+
+bool DecryptionEngine::decryptBlocks(const std::string &ciphertext, std::string &plaintext, JobProgress *progress){
+/***********************************************************************
+* Decrypts a ciphertext made of decimal blocks, each followed by a delimiter ('/'),
+* as written by older versions of the program. The block boundaries are found first,
+* then the blocks are decrypted by runWorkers(), and each one is written out without
+* any leading zeros.
+*
+* Arguments:
+* @ ciphertext: The decimal blocks, each followed by a delimiter ('/').
+* @ plaintext: The string the decrypted blocks are added onto.
+* @ progress: Has the number of blocks found added to its total, and is advanced as they are decrypted, or nullptr.
+*
+* Returns:
+*  True: If every block has been decrypted.
+*  False: If a block is not a number smaller than the modulus, so the file is damaged, or progress was cancelled.
+***********************************************************************/
+    std::vector<BlockPosition> blocks;
+    DecryptionEngine::findBlocks(ciphertext, blocks);
+    if(progress != nullptr){
+        progress->addToTotal(blocks.size());
+    }
+    return DecryptionEngine::runWorkers(ciphertext, blocks, false, 0, plaintext, progress);
+}
+
+bool DecryptionEngine::decryptFixedBlocks(const std::string &ciphertext, size_t firstBlockStart, size_t numberOfBlocks, size_t blockSize, std::string &plaintext,
+                                          JobProgress *progress){
+/***********************************************************************
+* Decrypts a ciphertext made of binary blocks which are each getEncryptedBlockSize() bytes,
+* as stored in a CiphertextContainer. Block i starts at firstBlockStart + i * k, so no
+* searching is needed before the blocks are decrypted by runWorkers().
+*
+* Arguments:
+* @ ciphertext: The data containing the encrypted blocks.
+* @ firstBlockStart: The position in the ciphertext where the first block starts.
+* @ numberOfBlocks: The number of blocks, the ciphertext must be long enough to hold them all.
+* @ blockSize: The number of bytes in each decrypted block.
+* @ plaintext: The string the decrypted blocks are added onto.
+* @ progress: Advanced as the blocks are decrypted, or nullptr. The caller adds them to its total,
+*             as a container's blocks are decrypted a chunk at a time.
+*
+* Returns:
+*  True: If every block has been decrypted.
+*  False: If the ciphertext is too short, a block is not smaller than the modulus, or progress was cancelled.
+***********************************************************************/
+    if(blockSize == 0 || firstBlockStart > ciphertext.length()
+            || numberOfBlocks > (ciphertext.length() - firstBlockStart) / encryptedBlockSize){
+        return false;
+    }
+    std::vector<BlockPosition> blocks(numberOfBlocks);
+    for(size_t i = 0; i < numberOfBlocks; i++){
+        blocks[i].start = firstBlockStart + i * encryptedBlockSize;
+        blocks[i].length = encryptedBlockSize;
+    }
+    return DecryptionEngine::runWorkers(ciphertext, blocks, true, blockSize, plaintext, progress);
+}
+
+bool DecryptionEngine::runWorkers(const std::string &ciphertext, const std::vector<BlockPosition> &blocks, bool fixedWidth, size_t blockSize, std::string &plaintext,
+                                  JobProgress *progress){
+/***********************************************************************
+* Shares the blocks out between the workers in ranges of BLOCKS_PER_RANGE. Every block
+* has its own slot, made before the workers start, and the slots are joined onto the
+* plaintext once at the end, so the blocks stay in order without any locking.
+*
+* Arguments:
+* @ ciphertext: The data containing the encrypted blocks.
+* @ blocks: The start and length of every block.
+* @ fixedWidth: Whether the blocks are binary (true) or decimal text (false).
+* @ blockSize: The number of bytes in each decrypted block, 0 for the oldest files.
+* @ plaintext: The string the decrypted blocks are added onto.
+* @ progress: Advanced after each range of blocks, or nullptr.
+*
+* Returns:
+*  True: If every block has been decrypted.
+*  False: If a block could not be decrypted, or progress was cancelled.
+***********************************************************************/
+    std::vector<std::string> decryptedBlocks(blocks.size());
+    size_t numberOfRanges = (blocks.size() + BLOCKS_PER_RANGE - 1) / BLOCKS_PER_RANGE;
+    unsigned int workersNeeded = static_cast<unsigned int>(std::min<size_t>(numberOfThreads, numberOfRanges));
+
+    std::atomic<size_t> nextRange(0);
+    std::atomic<bool> failed(false);
+    // The calling thread does its share of the work too, rather than waiting.
+    WorkScheduler::runWorkers(scheduler, workersNeeded, [&](){
+        DecryptionEngine::decryptWorker(&ciphertext, &blocks, fixedWidth, blockSize, &decryptedBlocks, &nextRange, &failed, progress);
+    });
+    if(failed == true){
+        return false;
+    }
+
+    size_t totalLength = plaintext.length();
+    for(size_t i = 0; i < decryptedBlocks.size(); i++){
+        totalLength += decryptedBlocks[i].length();
+    }
+    plaintext.reserve(totalLength);
+    for(size_t i = 0; i < decryptedBlocks.size(); i++){
+        plaintext += decryptedBlocks[i];
+    }
+    return true;
+}
+
+void DecryptionEngine::findBlocks(const std::string &ciphertext, std::vector<BlockPosition> &blocks){
+/***********************************************************************
+* Finds where each block starts and ends by searching for the delimiters with memchr,
+* which is much quicker than copying the ciphertext a character at a time. Anything
+* after the last delimiter is not a whole block and is ignored.
+*
+* Arguments:
+* @ ciphertext: The decimal blocks, each followed by a delimiter ('/').
+* @ blocks: The vector the start and length of every block is written to.
+***********************************************************************/
+    const char *text = ciphertext.data();
+    const char *textEnd = text + ciphertext.length();
+    const char *blockStart = text;
+    blocks.clear();
+    const char *delimiter = static_cast<const char*>(std::memchr(blockStart, '/', textEnd - blockStart));
+    while(delimiter != nullptr){
+        BlockPosition block;
+        block.start = blockStart - text;
+        block.length = delimiter - blockStart;
+        blocks.push_back(block);
+        blockStart = delimiter + 1;
+        delimiter = static_cast<const char*>(std::memchr(blockStart, '/', textEnd - blockStart));
+    }
+}
+
+void DecryptionEngine::decryptWorker(const std::string *ciphertext, const std::vector<BlockPosition> *blocks, bool fixedWidth, size_t blockSize,
+                                     std::vector<std::string> *decryptedBlocks, std::atomic<size_t> *nextRange, std::atomic<bool> *failed,
+                                     JobProgress *progress){
+/***********************************************************************
+* The function that each worker thread runs. It keeps taking the next range of blocks
+* until there are none left, or a block has failed to decrypt, or the job has been cancelled, and decrypts each range
+* in batches of the contexts' batch size. The multiprecision variables and the scratch
+* space for the contexts are made once per worker and reused for every batch.
+*
+* Arguments:
+* @ ciphertext: The data containing the encrypted blocks.
+* @ blocks: The start and length of every block.
+* @ fixedWidth: Whether the blocks are binary (true) or decimal text (false).
+* @ blockSize: The number of bytes in each decrypted block, 0 for the oldest files.
+* @ decryptedBlocks: The slots the decrypted blocks are written to.
+* @ nextRange: The index of the next range of blocks which no worker has taken yet.
+* @ failed: A flag which is set when a block cannot be decrypted (or the job is cancelled), which stops every worker.
+* @ progress: Advanced after each range, or nullptr.
+***********************************************************************/
+    // Every context is made for the same machine, so they all have the same batch size.
+    size_t batchSize = static_cast<size_t>(std::max(privateContext.getBatchSize(), primeContext1.getBatchSize()));
+    BatchValues values;
+    values.valuesToDecrypt.resize(batchSize);
+    values.decryptedDenaries.resize(batchSize);
+    values.primeResults1.resize(batchSize);
+    values.primeResults2.resize(batchSize);
+    std::vector<mp_limb_t> scratch(std::max(privateContext.getScratchSize(),
+                                            std::max(primeContext1.getScratchSize(), primeContext2.getScratchSize())));
+    std::string blockToDecrypt;
+
+    size_t numberOfBlocks = blocks->size();
+    while(*failed == false){
+        size_t firstBlock = nextRange->fetch_add(1) * BLOCKS_PER_RANGE;
+        if(firstBlock >= numberOfBlocks){
+            break;
+        }
+        size_t lastBlock = std::min(firstBlock + BLOCKS_PER_RANGE, numberOfBlocks);
+        for(size_t blockIndex = firstBlock; blockIndex < lastBlock; blockIndex += batchSize){
+            if(DecryptionEngine::decryptBatch(values, scratch, blockToDecrypt, *ciphertext, *blocks, blockIndex, std::min(batchSize, lastBlock - blockIndex),
+                                              fixedWidth, blockSize, *decryptedBlocks) == false){
+                *failed = true;
+                break;
+            }
+        }
+        if(progress != nullptr){
+            progress->advance(lastBlock - firstBlock);
+            if(progress->isCancelled() == true){
+                *failed = true;
+            }
+        }
+    }
+}
+
+bool DecryptionEngine::decryptBatch(BatchValues &values, std::vector<mp_limb_t> &scratch, std::string &blockToDecrypt,
+                                    const std::string &ciphertext, const std::vector<BlockPosition> &blocks, size_t firstBlock, size_t numberOfBlocks,
+                                    bool fixedWidth, size_t blockSize, std::vector<std::string> &decryptedBlocks){
+/***********************************************************************
+* Decrypts a batch of consecutive blocks and writes each one to its slot. The exponentiations
+* of the whole batch are worked out together by the contexts when the processor can.
+* When the Chinese Remainder Theorem values are available each block is decrypted with
+* two half-size exponentiations which are then recombined (Garner's formula):
+* - m1 = c^exponent1 mod prime1
+* - m2 = c^exponent2 mod prime2
+* - m = m2 + prime2 * ((coefficient * (m1 - m2)) mod prime1)
+* Otherwise a full exponentiation with the privateExponent modulo the modulus is used.
+*
+* Arguments:
+* @ values: The worker's multiprecision variables, one of each for every block in a batch.
+* @ scratch: The worker's scratch space for the exponentiation contexts.
+* @ blockToDecrypt: The worker's string which each block is copied into.
+* @ ciphertext: The data containing the encrypted blocks.
+* @ blocks: The start and length of every block.
+* @ firstBlock: The index of the first block in the batch.
+* @ numberOfBlocks: The number of blocks in the batch, at most the size of the worker's variables.
+* @ fixedWidth: Whether the blocks are binary (true) or decimal text (false).
+* @ blockSize: The number of bytes in each decrypted block, 0 for the oldest files.
+* @ decryptedBlocks: The slots the decrypted blocks are written to.
+*
+* Returns:
+*  True: If every block in the batch has been decrypted.
+*  False: If a block is not a number smaller than the modulus.
+***********************************************************************/
+    mpz_srcptr valuesToDecrypt[MultiBufferModExp::LANES];
+    mpz_ptr decryptedDenaries[MultiBufferModExp::LANES];
+    mpz_ptr primeResults1[MultiBufferModExp::LANES];
+    mpz_ptr primeResults2[MultiBufferModExp::LANES];
+    for(size_t i = 0; i < numberOfBlocks; i++){
+        mpz_ptr valueToDecrypt = values.valuesToDecrypt[i].get_mpz_t();
+        blockToDecrypt.assign(ciphertext, blocks[firstBlock + i].start, blocks[firstBlock + i].length);
+        if(fixedWidth == true){
+            mpz_import(valueToDecrypt, blockToDecrypt.length(), 1, 1, 0, 0, blockToDecrypt.data());
+        }
+        else if(blockToDecrypt.empty() == true || mpz_set_str(valueToDecrypt, blockToDecrypt.c_str(), 10) != 0){
+            return false;
+        }
+        if(mpz_sgn(valueToDecrypt) < 0 || mpz_cmp(valueToDecrypt, modulus.get_mpz_t()) >= 0){
+            return false;
+        }
+        valuesToDecrypt[i] = valueToDecrypt;
+        decryptedDenaries[i] = values.decryptedDenaries[i].get_mpz_t();
+        primeResults1[i] = values.primeResults1[i].get_mpz_t();
+        primeResults2[i] = values.primeResults2[i].get_mpz_t();
+    }
+
+    int batchSize = static_cast<int>(numberOfBlocks);
+    if(mpz_sgn(coefficient.get_mpz_t()) != 0){
+        primeContext1.exponentiateBatch(primeResults1, valuesToDecrypt, batchSize, scratch);
+        primeContext2.exponentiateBatch(primeResults2, valuesToDecrypt, batchSize, scratch);
+
+        // Recombine the two halves, mpz_mod always gives a non-negative result so (m1 - m2) can be negative.
+        for(size_t i = 0; i < numberOfBlocks; i++){
+            mpz_sub(decryptedDenaries[i], primeResults1[i], primeResults2[i]);
+            mpz_mul(decryptedDenaries[i], decryptedDenaries[i], coefficient.get_mpz_t());
+            mpz_mod(decryptedDenaries[i], decryptedDenaries[i], prime1.get_mpz_t());
+            mpz_mul(decryptedDenaries[i], decryptedDenaries[i], prime2.get_mpz_t());
+            mpz_add(decryptedDenaries[i], decryptedDenaries[i], primeResults2[i]);
+        }
+    }
+    else{
+        privateContext.exponentiateBatch(decryptedDenaries, valuesToDecrypt, batchSize, scratch);
+    }
+
+    for(size_t i = 0; i < numberOfBlocks; i++){
+        DecryptionEngine::writeBlock(decryptedDenaries[i], blockSize, decryptedBlocks[firstBlock + i]);
+    }
+    return true;
+}
+
+void DecryptionEngine::writeBlock(mpz_t decryptedDenary, size_t blockSize, std::string &decryptedBlock){
+/***********************************************************************
+* Writes a decrypted number straight out to its slot as big endian bytes, one character per byte.
+*
+* Arguments:
+* @ decryptedDenary: The decrypted number (m), which is changed if it is too large for a block.
+* @ blockSize: The number of bytes in the decrypted block, 0 for the oldest files.
+* @ decryptedBlock: The slot which the decrypted block is written to.
+***********************************************************************/
+    size_t bytesWritten = 0;
+    if(blockSize != 0){
+        if(mpz_sizeinbase(decryptedDenary, 2) > 8 * blockSize){
+            // Too large for a block, so the ciphertext has been changed. Keeping the block size means the padding check fails.
+            mpz_fdiv_r_2exp(decryptedDenary, decryptedDenary, 8 * blockSize);
+        }
+        // Right align the number in the block, so any leading zero bytes stay in place.
+        size_t leadingZeros = blockSize - (mpz_sizeinbase(decryptedDenary, 2) + 7) / 8;
+        decryptedBlock.assign(blockSize, '\0');
+        mpz_export(&decryptedBlock[leadingZeros], &bytesWritten, 1, 1, 0, 0, decryptedDenary);
+    }
+    else{
+        decryptedBlock.assign((mpz_sizeinbase(decryptedDenary, 2) + 7) / 8, '\0');
+        mpz_export(&decryptedBlock[0], &bytesWritten, 1, 1, 0, 0, decryptedDenary);
+        decryptedBlock.resize(bytesWritten);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef DECRYPTIONENGINE_H
+#define DECRYPTIONENGINE_H
+
+#include "exponentiationcontext.h"
+#include "jobprogress.h"
+#include "workscheduler.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+class DecryptionEngine
+{
+public:
+    DecryptionEngine(const mpz_t modulus, const mpz_t privateExponent, const mpz_t prime1, const mpz_t prime2,
+                     const mpz_t exponent1, const mpz_t exponent2, const mpz_t coefficient, unsigned int numberOfThreads = 0,
+                     WorkScheduler *scheduler = nullptr);
+    bool decryptBlocks(const std::string &ciphertext, std::string &plaintext, JobProgress *progress = nullptr);
+    bool decryptFixedBlocks(const std::string &ciphertext, size_t firstBlockStart, size_t numberOfBlocks, size_t blockSize, std::string &plaintext,
+                            JobProgress *progress = nullptr);
+    size_t getEncryptedBlockSize() const;
+    unsigned int getNumberOfThreads() const;
+    WorkScheduler* getScheduler() const;
+
+private:
+    struct BlockPosition{
+        size_t start;
+        size_t length;
+    };
+
+    struct BatchValues{
+        std::vector<mpz_class> valuesToDecrypt;
+        std::vector<mpz_class> decryptedDenaries;
+        std::vector<mpz_class> primeResults1;
+        std::vector<mpz_class> primeResults2;
+    };
+
+    mpz_class modulus;
+    mpz_class privateExponent;
+    mpz_class prime1;
+    mpz_class prime2;
+    mpz_class exponent1;
+    mpz_class exponent2;
+    mpz_class coefficient;
+    ExponentiationContext privateContext;
+    ExponentiationContext primeContext1;
+    ExponentiationContext primeContext2;
+    size_t encryptedBlockSize;
+    unsigned int numberOfThreads;
+    WorkScheduler *scheduler;
+
+    void findBlocks(const std::string &ciphertext, std::vector<BlockPosition> &blocks);
+    bool runWorkers(const std::string &ciphertext, const std::vector<BlockPosition> &blocks, bool fixedWidth, size_t blockSize, std::string &plaintext,
+                    JobProgress *progress);
+    void decryptWorker(const std::string *ciphertext, const std::vector<BlockPosition> *blocks, bool fixedWidth, size_t blockSize,
+                       std::vector<std::string> *decryptedBlocks, std::atomic<size_t> *nextRange, std::atomic<bool> *failed, JobProgress *progress);
+    bool decryptBatch(BatchValues &values, std::vector<mp_limb_t> &scratch, std::string &blockToDecrypt,
+                      const std::string &ciphertext, const std::vector<BlockPosition> &blocks, size_t firstBlock, size_t numberOfBlocks,
+                      bool fixedWidth, size_t blockSize, std::vector<std::string> &decryptedBlocks);
+    void writeBlock(mpz_t decryptedDenary, size_t blockSize, std::string &decryptedBlock);
+};
+
+#endif // DECRYPTIONENGINE_H
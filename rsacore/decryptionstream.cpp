@@ -0,0 +1,396 @@
+#include "decryptionstream.h"
+#include <gmpxx.h>
+
+#include <algorithm>
+#include <thread>
+
+static const size_t CHUNK_SIZE = 1 << 20; // The number of bytes read from the input at a time.
+static const size_t QUEUE_CAPACITY = 2; // The number of chunks each queue between the stages can hold.
+static const size_t FORMAT_CHECK_SIZE = 64; // The number of bytes isStreamable() looks at, enough for a header or the armour's first line.
+static const char PADDING_MARKER = '\x80'; // The byte added after the plaintext, before the zero padding.
+
+DecryptionStream::DecryptionStream(const mpz_t modulus, const mpz_t publicExponent, const mpz_t privateExponent, const mpz_t prime1, const mpz_t prime2,
+                                   const mpz_t exponent1, const mpz_t exponent2, const mpz_t coefficient, unsigned int numberOfThreads,
+                                   WorkScheduler *scheduler)
+    : decryptionEngine(modulus, privateExponent, prime1, prime2, exponent1, exponent2, coefficient, numberOfThreads, scheduler){
+/***********************************************************************
+* Constructor for the DecryptionStream class, which decrypts a CiphertextContainer
+* (binary or armoured) of any size while only holding a few chunks of it in memory.
+*
+* Arguments:
+* @ modulus: The modulus (n) of the private key.
+* @ publicExponent: The public exponent (e), used to check the key fingerprint in the header.
+* @ privateExponent: The private exponent (d) of the private key.
+* @ prime1, prime2, exponent1, exponent2, coefficient: The CRT values, passed on to the DecryptionEngine.
+* @ numberOfThreads: The number of threads the DecryptionEngine uses for each chunk, 0 uses one per core.
+* @ scheduler: The WorkScheduler the chunks are decrypted on, or nullptr to start threads for each chunk.
+***********************************************************************/
+    this->keyFingerprint = CiphertextContainer::keyFingerprint(modulus, publicExponent);
+    this->encryptedBlockSize = decryptionEngine.getEncryptedBlockSize();
+    this->blocksPerChunk = std::max<size_t>(1, CHUNK_SIZE / encryptedBlockSize);
+    this->differentKey = false;
+    this->progress = nullptr;
+}
+
+bool DecryptionStream::decrypt(std::istream &input, std::ostream &output, JobProgress *progress){
+/***********************************************************************
+* Decrypts the input into the output as a pipeline of three stages, which all run at once:
+* - A reader thread reads the input a chunk at a time, and removes the armour if there is any.
+* - This thread checks the header, cuts the container into whole blocks (or hybrid chunks)
+*   and decrypts them on every core with the DecryptionEngine (or HybridEngine).
+* - A writer thread writes each decrypted chunk to the output.
+* The stages are joined by BoundedQueues of QUEUE_CAPACITY chunks, so the memory used stays
+* the same whatever the size of the file, and the first plaintext is written as soon as the
+* first chunk has been decrypted rather than after the whole file has been read.
+*
+* Arguments:
+* @ input: The stream the container is read from.
+* @ output: The stream the plaintext is written to.
+* @ progress: Has the number of blocks (or hybrid chunks) in the header added to its total, and is
+*             advanced as they are decrypted, or nullptr. Once it has been cancelled the pipeline stops.
+*
+* Returns:
+*  True: If the whole container has been decrypted and written.
+*  False: If the container is damaged or for a different key (see wasEncryptedForDifferentKey()),
+*         or the input could not be read, or the output could not be written, or progress was
+*         cancelled. Some plaintext may already have been written, so the caller should throw the output away.
+***********************************************************************/
+    differentKey = false;
+    this->progress = progress;
+    std::atomic<bool> failed(false);
+    BoundedQueue<std::string> containerChunks(QUEUE_CAPACITY);
+    BoundedQueue<std::string> plaintextChunks(QUEUE_CAPACITY);
+    std::thread reader(&DecryptionStream::readChunks, this, &input, &containerChunks, &failed);
+    std::thread writer(&DecryptionStream::writeChunks, this, &output, &plaintextChunks, &failed);
+
+    bool decrypted = DecryptionStream::decryptChunks(&containerChunks, &plaintextChunks);
+    // Closing both queues lets the reader and writer finish, even if one of the stages has failed.
+    containerChunks.close();
+    plaintextChunks.close();
+    reader.join();
+    writer.join();
+    return decrypted == true && failed == false;
+}
+
+bool DecryptionStream::wasEncryptedForDifferentKey() const{
+/***********************************************************************
+* Returns:
+*  True: If the last call to decrypt() failed because the key fingerprint in the header did not match.
+*  False: If it did not.
+***********************************************************************/
+    return differentKey;
+}
+
+DecryptionEngine &DecryptionStream::getDecryptionEngine(){
+/***********************************************************************
+* Returns:
+* @ decryptionEngine: The DecryptionEngine the blocks are decrypted with, so files from older
+*                     versions of the program can be decrypted without setting the key up again.
+***********************************************************************/
+    return decryptionEngine;
+}
+
+bool DecryptionStream::isStreamable(std::istream &input){
+/***********************************************************************
+* Looks at the start of the input to see whether it is a container (binary or armoured)
+* which decrypt() can read. Files from older versions of the program are not, and have
+* to be decrypted in memory. The input is put back at the start afterwards.
+*
+* Arguments:
+* @ input: The stream of the encrypted file.
+*
+* Returns:
+*  True: If the input starts with a container header or the armour's first line.
+*  False: If it is in an older format.
+***********************************************************************/
+    std::string startOfInput(FORMAT_CHECK_SIZE, '\0');
+    input.read(&startOfInput[0], FORMAT_CHECK_SIZE);
+    startOfInput.resize(static_cast<size_t>(input.gcount()));
+    input.clear();
+    input.seekg(0);
+    return CiphertextContainer::isArmoured(startOfInput) == true || CiphertextContainer::isContainer(startOfInput) == true;
+}
+
+void DecryptionStream::readChunks(std::istream *input, BoundedQueue<std::string> *containerChunks, std::atomic<bool> *failed){
+/***********************************************************************
+* The reader stage. Reads CHUNK_SIZE bytes at a time and passes them on as container bytes,
+* decoding them with an ArmourDecoder first if the input starts with the armour's first line.
+*
+* Arguments:
+* @ input: The stream the container is read from.
+* @ containerChunks: The queue the container bytes are passed to the decryption stage on.
+* @ failed: A flag which is set if the input cannot be read or the armour is not valid.
+***********************************************************************/
+    ArmourDecoder armourDecoder;
+    bool armoured = false;
+    bool firstChunk = true;
+    while(true){
+        std::string inputChunk(CHUNK_SIZE, '\0');
+        input->read(&inputChunk[0], CHUNK_SIZE);
+        inputChunk.resize(static_cast<size_t>(input->gcount()));
+        if(firstChunk == true){
+            armoured = CiphertextContainer::isArmoured(inputChunk);
+            firstChunk = false;
+        }
+        if(armoured == true){
+            std::string containerChunk;
+            if(armourDecoder.decode(inputChunk, containerChunk) == false){
+                *failed = true;
+                break;
+            }
+            inputChunk.swap(containerChunk);
+        }
+        if(inputChunk.empty() == false && containerChunks->push(std::move(inputChunk)) == false){
+            break;
+        }
+        if(input->eof() == true || input->fail() == true){
+            if(input->bad() == true || (armoured == true && armourDecoder.finish() == false)){
+                *failed = true;
+            }
+            break;
+        }
+    }
+    containerChunks->close();
+}
+
+bool DecryptionStream::decryptChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks){
+/***********************************************************************
+* The decryption stage. Waits for the HEADER_SIZE byte header and checks it, then decrypts
+* the rest of the container as RSA blocks or as a hybrid payload, depending on its version.
+*
+* Arguments:
+* @ containerChunks: The queue the container bytes arrive on.
+* @ plaintextChunks: The queue the decrypted chunks are passed to the writer stage on.
+*
+* Returns:
+*  True: If the whole container has been decrypted.
+*  False: If the header, a block, a chunk or the padding is not valid for this key, or the
+*         container has more or fewer blocks than its header says.
+***********************************************************************/
+    std::string pendingBytes;
+    std::string containerChunk;
+    while(pendingBytes.size() < CiphertextContainer::HEADER_SIZE && containerChunks->pop(containerChunk) == true){
+        pendingBytes += containerChunk;
+    }
+    ciphertextHeader header;
+    if(pendingBytes.size() < CiphertextContainer::HEADER_SIZE || DecryptionStream::checkHeader(pendingBytes, header) == false){
+        return false;
+    }
+    if(progress != nullptr){
+        progress->addToTotal(header.numberOfBlocks);
+    }
+    if(header.version == CiphertextContainer::HYBRID_VERSION){
+        return DecryptionStream::decryptHybridChunks(containerChunks, plaintextChunks, header, pendingBytes);
+    }
+    return DecryptionStream::decryptBlockChunks(containerChunks, plaintextChunks, header, pendingBytes);
+}
+
+bool DecryptionStream::decryptBlockChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks,
+                                          const ciphertextHeader &header, std::string &pendingBytes){
+/***********************************************************************
+* Decrypts the RSA blocks of a BLOCK_VERSION container. Every whole block which has arrived
+* is decrypted, blocksPerChunk blocks at a time, and the bytes of a block which has only partly
+* arrived are kept until the next chunk. The header gives the number of blocks, so the chunk
+* holding the last block has its padding removed.
+*
+* Arguments:
+* @ containerChunks: The queue the rest of the container bytes arrive on.
+* @ plaintextChunks: The queue the decrypted chunks are passed to the writer stage on.
+* @ header: The container's header, which has already been checked.
+* @ pendingBytes: The container bytes read so far, starting with the header.
+*
+* Returns:
+*  True: If every block in the header has been decrypted and nothing follows the last one.
+*  False: If a block or the padding is not valid for this key, or the container has more
+*         or fewer blocks than its header says, or progress was cancelled.
+***********************************************************************/
+    unsigned long long blocksRemaining = header.numberOfBlocks;
+    size_t blockStart = CiphertextContainer::HEADER_SIZE;
+    std::string containerChunk;
+    while(true){
+        size_t wholeBlocks = (pendingBytes.size() - blockStart) / encryptedBlockSize;
+        if(wholeBlocks > blocksRemaining){
+            return false;
+        }
+        while(wholeBlocks > 0){
+            size_t blocksToDecrypt = std::min(wholeBlocks, blocksPerChunk);
+            std::string plaintextChunk;
+            if(decryptionEngine.decryptFixedBlocks(pendingBytes, blockStart, blocksToDecrypt, header.blockSize, plaintextChunk, progress) == false){
+                return false;
+            }
+            blocksRemaining -= blocksToDecrypt;
+            if(blocksRemaining == 0 && DecryptionStream::removePadding(plaintextChunk, header.blockSize) == false){
+                return false;
+            }
+            if(plaintextChunks->push(std::move(plaintextChunk)) == false){
+                return false;
+            }
+            blockStart += blocksToDecrypt * encryptedBlockSize;
+            wholeBlocks -= blocksToDecrypt;
+        }
+        pendingBytes.erase(0, blockStart);
+        blockStart = 0;
+        if(containerChunks->pop(containerChunk) == false){
+            break;
+        }
+        pendingBytes += containerChunk;
+    }
+    return blocksRemaining == 0 && pendingBytes.empty() == true;
+}
+
+bool DecryptionStream::decryptHybridChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks,
+                                           const ciphertextHeader &header, std::string &pendingBytes){
+/***********************************************************************
+* Decrypts the payload of a HYBRID_VERSION container. The RSA encrypted shared secret after
+* the header is decrypted first, and the HybridEngine derives the session key from it. Every
+* chunk but the last has the same size, so each batch of whole chunks is decrypted on every
+* core as soon as it has arrived. The last chunk can be shorter, so the bytes left once the
+* input has ended are decrypted as the final chunk.
+*
+* Arguments:
+* @ containerChunks: The queue the rest of the container bytes arrive on.
+* @ plaintextChunks: The queue the decrypted chunks are passed to the writer stage on.
+* @ header: The container's header, which has already been checked.
+* @ pendingBytes: The container bytes read so far, starting with the header.
+*
+* Returns:
+*  True: If every chunk in the header has been decrypted and authenticated.
+*  False: If the secret was not encrypted with this key, or any chunk has been changed,
+*         moved, or removed, or the container has more or fewer chunks than its header says,
+*         or progress was cancelled.
+***********************************************************************/
+    std::string containerChunk;
+    size_t secretEnd = CiphertextContainer::HEADER_SIZE + encryptedBlockSize;
+    while(pendingBytes.size() < secretEnd && containerChunks->pop(containerChunk) == true){
+        pendingBytes += containerChunk;
+    }
+    std::string sharedSecret;
+    if(pendingBytes.size() < secretEnd
+            || decryptionEngine.decryptFixedBlocks(pendingBytes, CiphertextContainer::HEADER_SIZE, 1, encryptedBlockSize - 1, sharedSecret) == false){
+        return false;
+    }
+    HybridEngine hybridEngine(header.cipher, sharedSecret, pendingBytes.substr(0, CiphertextContainer::HEADER_SIZE),
+                              header.blockSize, decryptionEngine.getNumberOfThreads(), decryptionEngine.getScheduler());
+    std::fill(sharedSecret.begin(), sharedSecret.end(), '\0');
+
+    size_t recordSize = header.blockSize + HybridEngine::TAG_SIZE;
+    size_t chunksPerBatch = std::max<size_t>(1, CHUNK_SIZE / recordSize);
+    unsigned long long chunksRemaining = header.numberOfBlocks;
+    size_t chunkStart = secretEnd;
+    while(true){
+        // The last chunk can be shorter, so it is only known to be complete once the input has ended.
+        while(chunksRemaining > 1 && pendingBytes.size() - chunkStart >= recordSize){
+            size_t chunksToDecrypt = std::min((pendingBytes.size() - chunkStart) / recordSize, chunksPerBatch);
+            chunksToDecrypt = static_cast<size_t>(std::min<unsigned long long>(chunksToDecrypt, chunksRemaining - 1));
+            std::string plaintextChunk;
+            if(hybridEngine.decryptChunks(pendingBytes, chunkStart, chunksToDecrypt * recordSize,
+                                          header.numberOfBlocks - chunksRemaining, false, plaintextChunk) == false){
+                return false;
+            }
+            if(plaintextChunks->push(std::move(plaintextChunk)) == false){
+                return false;
+            }
+            if(progress != nullptr){
+                progress->advance(chunksToDecrypt);
+                if(progress->isCancelled() == true){
+                    return false;
+                }
+            }
+            chunksRemaining -= chunksToDecrypt;
+            chunkStart += chunksToDecrypt * recordSize;
+        }
+        pendingBytes.erase(0, chunkStart);
+        chunkStart = 0;
+        if(chunksRemaining == 1 && pendingBytes.size() > recordSize){
+            return false;
+        }
+        if(containerChunks->pop(containerChunk) == false){
+            break;
+        }
+        pendingBytes += containerChunk;
+    }
+
+    std::string plaintextChunk;
+    if(chunksRemaining != 1 || pendingBytes.size() < HybridEngine::TAG_SIZE
+            || hybridEngine.decryptChunks(pendingBytes, 0, pendingBytes.size(), header.numberOfBlocks - 1, true, plaintextChunk) == false){
+        return false;
+    }
+    if(progress != nullptr){
+        progress->advance(1);
+    }
+    return plaintextChunks->push(std::move(plaintextChunk));
+}
+
+void DecryptionStream::writeChunks(std::ostream *output, BoundedQueue<std::string> *plaintextChunks, std::atomic<bool> *failed){
+/***********************************************************************
+* The writer stage. Writes each chunk of plaintext to the output as soon as it has been decrypted.
+*
+* Arguments:
+* @ output: The stream the plaintext is written to.
+* @ plaintextChunks: The queue the decrypted chunks arrive on.
+* @ failed: A flag which is set if the output cannot be written.
+***********************************************************************/
+    std::string plaintextChunk;
+    while(plaintextChunks->pop(plaintextChunk) == true){
+        if(output->write(plaintextChunk.data(), plaintextChunk.size()).fail() == true){
+            *failed = true;
+            // Closing the queue stops the decryption stage, which then stops the reader.
+            plaintextChunks->close();
+            return;
+        }
+    }
+    output->flush();
+}
+
+bool DecryptionStream::checkHeader(const std::string &container, ciphertextHeader &header){
+/***********************************************************************
+* Reads the container's header and checks it can be decrypted with this key. A file
+* encrypted for a different key is caught here, before any blocks are decrypted.
+*
+* Arguments:
+* @ container: The start of the container, at least HEADER_SIZE bytes.
+* @ header: The structure the header is read into.
+*
+* Returns:
+*  True: If the header matches this key.
+*  False: If the header cannot be read, the fingerprint does not match, or the block sizes
+*         (or the cipher of a hybrid container) are not valid.
+***********************************************************************/
+    if(CiphertextContainer::readHeader(container, header) == false){
+        return false;
+    }
+    if(header.keyFingerprint != keyFingerprint){
+        differentKey = true;
+        return false;
+    }
+    if(header.encryptedBlockSize != encryptedBlockSize || header.blockSize == 0 || header.numberOfBlocks == 0){
+        return false;
+    }
+    if(header.version == CiphertextContainer::HYBRID_VERSION){
+        // The chunk size is limited so a damaged header cannot make the decryption stage buffer a huge chunk.
+        return HybridEngine::isSupportedCipher(header.cipher) == true && header.blockSize <= HybridEngine::MAX_CHUNK_SIZE;
+    }
+    return header.blockSize < header.encryptedBlockSize;
+}
+
+bool DecryptionStream::removePadding(std::string &plaintextChunk, size_t blockSize){
+/***********************************************************************
+* Removes the zero padding, and the PADDING_MARKER before it, from the end of the chunk
+* which holds the last block. The padding is never longer than a block.
+*
+* Arguments:
+* @ plaintextChunk: The decrypted chunk which ends with the last block.
+* @ blockSize: The number of bytes in each decrypted block.
+*
+* Returns:
+*  True: If the padding has been removed.
+*  False: If the end of the chunk is not valid padding, so the wrong key was used.
+***********************************************************************/
+    size_t paddingStart = plaintextChunk.find_last_not_of('\0');
+    if(paddingStart == std::string::npos || paddingStart + blockSize < plaintextChunk.size()
+            || plaintextChunk[paddingStart] != PADDING_MARKER){
+        return false;
+    }
+    plaintextChunk.resize(paddingStart);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef DECRYPTIONSTREAM_H
+#define DECRYPTIONSTREAM_H
+
+#include "decryptionengine.h"
+#include "hybridengine.h"
+#include "ciphertextcontainer.h"
+#include "boundedqueue.h"
+#include "jobprogress.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <istream>
+#include <ostream>
+#include <string>
+
+class DecryptionStream
+{
+public:
+    DecryptionStream(const mpz_t modulus, const mpz_t publicExponent, const mpz_t privateExponent, const mpz_t prime1, const mpz_t prime2,
+                     const mpz_t exponent1, const mpz_t exponent2, const mpz_t coefficient, unsigned int numberOfThreads = 0,
+                     WorkScheduler *scheduler = nullptr);
+    bool decrypt(std::istream &input, std::ostream &output, JobProgress *progress = nullptr);
+    bool wasEncryptedForDifferentKey() const;
+    DecryptionEngine &getDecryptionEngine();
+    static bool isStreamable(std::istream &input);
+
+private:
+    std::string keyFingerprint;
+    DecryptionEngine decryptionEngine;
+    size_t encryptedBlockSize;
+    size_t blocksPerChunk;
+    bool differentKey;
+    JobProgress *progress;
+
+    void readChunks(std::istream *input, BoundedQueue<std::string> *containerChunks, std::atomic<bool> *failed);
+    bool decryptChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks);
+    bool decryptBlockChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks,
+                            const ciphertextHeader &header, std::string &pendingBytes);
+    bool decryptHybridChunks(BoundedQueue<std::string> *containerChunks, BoundedQueue<std::string> *plaintextChunks,
+                             const ciphertextHeader &header, std::string &pendingBytes);
+    void writeChunks(std::ostream *output, BoundedQueue<std::string> *plaintextChunks, std::atomic<bool> *failed);
+    bool checkHeader(const std::string &container, ciphertextHeader &header);
+    bool removePadding(std::string &plaintextChunk, size_t blockSize);
+};
+
+#endif // DECRYPTIONSTREAM_H
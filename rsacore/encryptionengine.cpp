@@ -0,0 +1,181 @@
+#include "encryptionengine.h"
+#include <gmpxx.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static size_t BLOCKS_PER_RANGE = 16; // The number of blocks a worker takes at a time.
+
+EncryptionEngine::EncryptionEngine(const mpz_t modulus, const mpz_t publicExponent, unsigned int numberOfThreads, WorkScheduler *scheduler){
+/***********************************************************************
+* Constructor for the EncryptionEngine class, which encrypts the blocks of a
+* message with a public key using every core of the machine.
+*
+* Arguments:
+* @ modulus: The modulus (n) of the public key.
+* @ publicExponent: The public exponent (e) of the public key.
+* @ numberOfThreads: The number of worker threads to use, 0 uses one per core.
+* @ scheduler: The WorkScheduler the workers run on, or nullptr to start threads for each chunk.
+***********************************************************************/
+    this->modulus = mpz_class(modulus);
+    this->publicExponent = mpz_class(publicExponent);
+    this->scheduler = scheduler;
+    this->publicContext.setKey(modulus, publicExponent);
+    this->encryptedBlockSize = (mpz_sizeinbase(modulus, 2) + 7) / 8;
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 when the number of cores cannot be worked out.
+    this->numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+}
+
+size_t EncryptionEngine::getBlockSize() const{
+/***********************************************************************
+* Works out how many plaintext bytes fit in each block. A block of one byte less than the
+* modulus is always smaller than the modulus, so every block can be encrypted and decrypted.
+*
+* Returns:
+* @ blockSize: The number of bytes in each block, e.g. 511 for a 4096 bit key.
+***********************************************************************/
+    return (encryptedBlockSize > 1) ? encryptedBlockSize - 1 : 1;
+}
+
+size_t EncryptionEngine::getEncryptedBlockSize() const{
+/***********************************************************************
+* Returns:
+*  encryptedBlockSize: The number of bytes each encrypted block takes up (k, the size of the modulus).
+***********************************************************************/
+    return encryptedBlockSize;
+}
+
+unsigned int EncryptionEngine::getNumberOfThreads() const{
+/***********************************************************************
+* Returns:
+*  numberOfThreads: The number of worker threads the blocks are shared between.
+***********************************************************************/
+    return numberOfThreads;
+}
+
+WorkScheduler* EncryptionEngine::getScheduler() const{
+/***********************************************************************
+* Returns:
+*  scheduler: The WorkScheduler the workers run on, or nullptr if threads are started for each chunk.
+***********************************************************************/
+    return scheduler;
+}
+
+bool EncryptionEngine::encryptBlocks(const std::string &plaintext, size_t blockSize, std::string &ciphertext, JobProgress *progress){
+/***********************************************************************
+* Encrypts every block of the plaintext. Each block is independent, so the blocks are
+* shared out between the workers in ranges of BLOCKS_PER_RANGE. Every encrypted block is
+* exactly getEncryptedBlockSize() bytes, so each one has its own slot in the ciphertext,
+* made before the workers start. The workers never wait on each other and the blocks
+* come out in order without sorting them.
+*
+* Arguments:
+* @ plaintext: The padded plaintext, its length must be a multiple of blockSize.
+* @ blockSize: The number of plaintext bytes in each block.
+* @ ciphertext: The string the encrypted blocks are added onto.
+* @ progress: Advanced by the number of blocks in each range as it is finished, or nullptr.
+*
+* Returns:
+*  True: If every block has been encrypted.
+*  False: If progress was cancelled before then, the ciphertext is incomplete.
+***********************************************************************/
+    size_t numberOfBlocks = plaintext.length() / blockSize;
+    size_t ciphertextStart = ciphertext.length();
+    ciphertext.resize(ciphertextStart + numberOfBlocks * encryptedBlockSize);
+    if(numberOfBlocks == 0){
+        return true;
+    }
+    char *encryptedBlocks = &ciphertext[ciphertextStart];
+    size_t numberOfRanges = (numberOfBlocks + BLOCKS_PER_RANGE - 1) / BLOCKS_PER_RANGE;
+    unsigned int workersNeeded = static_cast<unsigned int>(std::min<size_t>(numberOfThreads, numberOfRanges));
+
+    std::atomic<size_t> nextRange(0);
+    // The calling thread does its share of the work too, rather than waiting.
+    WorkScheduler::runWorkers(scheduler, workersNeeded, [&](){
+        EncryptionEngine::encryptWorker(plaintext.data(), blockSize, numberOfBlocks, encryptedBlocks, &nextRange, progress);
+    });
+    return progress == nullptr || progress->isCancelled() == false;
+}
+
+void EncryptionEngine::encryptWorker(const char *plaintext, size_t blockSize, size_t numberOfBlocks, char *ciphertext, std::atomic<size_t> *nextRange,
+                                     JobProgress *progress){
+/***********************************************************************
+* The function that each worker thread runs. It keeps taking the next range of blocks
+* until there are none left (or the job is cancelled), and encrypts each range in batches of the publicContext's
+* batch size. The multiprecision variables and the scratch space for the publicContext
+* are made once per worker and reused for every batch.
+*
+* Arguments:
+* @ plaintext: The padded plaintext.
+* @ blockSize: The number of plaintext bytes in each block.
+* @ numberOfBlocks: The number of blocks in the plaintext.
+* @ ciphertext: The slots the encrypted blocks are written to, encryptedBlockSize bytes each.
+* @ nextRange: The index of the next range of blocks which no worker has taken yet.
+* @ progress: Advanced after each range, or nullptr.
+***********************************************************************/
+    size_t batchSize = static_cast<size_t>(publicContext.getBatchSize());
+    std::vector<mpz_class> valuesToEncrypt(batchSize);
+    std::vector<mpz_class> outputValues(batchSize);
+    std::vector<mp_limb_t> scratch(publicContext.getScratchSize());
+
+    while(progress == nullptr || progress->isCancelled() == false){
+        size_t firstBlock = nextRange->fetch_add(1) * BLOCKS_PER_RANGE;
+        if(firstBlock >= numberOfBlocks){
+            break;
+        }
+        size_t lastBlock = std::min(firstBlock + BLOCKS_PER_RANGE, numberOfBlocks);
+        for(size_t blockIndex = firstBlock; blockIndex < lastBlock; blockIndex += batchSize){
+            EncryptionEngine::encryptBatch(valuesToEncrypt, outputValues, scratch, plaintext + blockIndex * blockSize,
+                                           std::min(batchSize, lastBlock - blockIndex), blockSize, ciphertext + blockIndex * encryptedBlockSize);
+        }
+        if(progress != nullptr){
+            progress->advance(lastBlock - firstBlock);
+        }
+    }
+}
+
+void EncryptionEngine::encryptBatch(std::vector<mpz_class> &valuesToEncrypt, std::vector<mpz_class> &outputValues, std::vector<mp_limb_t> &scratch,
+                                    const char *blocksToEncrypt, size_t numberOfBlocks, size_t blockSize, char *encryptedBlocks){
+/***********************************************************************
+* Encrypts a batch of consecutive blocks, c = m^e mod n, which the publicContext works out
+* together when the processor can. Each block is written to its slot as encryptedBlockSize
+* big endian bytes, with leading zero bytes when c is shorter than the modulus.
+*
+* Arguments:
+* @ valuesToEncrypt: The worker's variables for the plaintext numbers (m).
+* @ outputValues: The worker's variables for the encrypted numbers (c).
+* @ scratch: The worker's scratch space for the publicContext.
+* @ blocksToEncrypt: The first byte of the first block.
+* @ numberOfBlocks: The number of blocks in the batch, at most the size of valuesToEncrypt.
+* @ blockSize: The number of bytes in each block.
+* @ encryptedBlocks: The slot which the first encrypted block is written to.
+***********************************************************************/
+    mpz_srcptr bases[MultiBufferModExp::LANES];
+    mpz_ptr results[MultiBufferModExp::LANES];
+    for(size_t i = 0; i < numberOfBlocks; i++){
+        // The characters of the block are read straight in as the bytes of a big endian number.
+        mpz_import(valuesToEncrypt[i].get_mpz_t(), blockSize, 1, 1, 0, 0, blocksToEncrypt + i * blockSize);
+        bases[i] = valuesToEncrypt[i].get_mpz_t();
+        results[i] = outputValues[i].get_mpz_t();
+    }
+    publicContext.exponentiateBatch(results, bases, static_cast<int>(numberOfBlocks), scratch);
+
+    for(size_t i = 0; i < numberOfBlocks; i++){
+        mpz_srcptr outputValue = outputValues[i].get_mpz_t();
+        char *encryptedBlock = encryptedBlocks + i * encryptedBlockSize;
+        size_t outputBytes = (mpz_sizeinbase(outputValue, 2) + 7) / 8;
+        size_t leadingZeros = encryptedBlockSize - outputBytes;
+        std::memset(encryptedBlock, 0, leadingZeros);
+        size_t bytesWritten = 0;
+        mpz_export(encryptedBlock + leadingZeros, &bytesWritten, 1, 1, 0, 0, outputValue);
+        if(bytesWritten < outputBytes){
+            // Only happens when the output is zero, which mpz_export writes as no bytes at all.
+            std::memset(encryptedBlock + leadingZeros, 0, outputBytes);
+        }
+    }
+}
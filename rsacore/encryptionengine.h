@@ -0,0 +1,35 @@
+#ifndef ENCRYPTIONENGINE_H
+#define ENCRYPTIONENGINE_H
+
+#include "exponentiationcontext.h"
+#include "jobprogress.h"
+#include "workscheduler.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+class EncryptionEngine
+{
+public:
+    EncryptionEngine(const mpz_t modulus, const mpz_t publicExponent, unsigned int numberOfThreads = 0, WorkScheduler *scheduler = nullptr);
+    bool encryptBlocks(const std::string &plaintext, size_t blockSize, std::string &ciphertext, JobProgress *progress = nullptr);
+    size_t getBlockSize() const;
+    size_t getEncryptedBlockSize() const;
+    unsigned int getNumberOfThreads() const;
+    WorkScheduler* getScheduler() const;
+
+private:
+    mpz_class modulus;
+    mpz_class publicExponent;
+    ExponentiationContext publicContext;
+    size_t encryptedBlockSize;
+    unsigned int numberOfThreads;
+    WorkScheduler *scheduler;
+
+    void encryptWorker(const char *plaintext, size_t blockSize, size_t numberOfBlocks, char *ciphertext, std::atomic<size_t> *nextRange, JobProgress *progress);
+    void encryptBatch(std::vector<mpz_class> &valuesToEncrypt, std::vector<mpz_class> &outputValues, std::vector<mp_limb_t> &scratch,
+                      const char *blocksToEncrypt, size_t numberOfBlocks, size_t blockSize, char *encryptedBlocks);
+};
+
+#endif // ENCRYPTIONENGINE_H
@@ -0,0 +1,257 @@
+#include "encryptionstream.h"
+#include "ciphertextcontainer.h"
+#include <gmpxx.h>
+
+#include <algorithm>
+#include <thread>
+#include <cryptopp/osrng.h>
+
+static const size_t CHUNK_SIZE = 1 << 20; // The number of plaintext bytes read from the input at a time.
+static const size_t QUEUE_CAPACITY = 2; // The number of chunks each queue between the stages can hold.
+static const char PADDING_MARKER = '\x80'; // The byte added after the plaintext, before the zero padding.
+
+EncryptionStream::EncryptionStream(const mpz_t modulus, const mpz_t publicExponent, unsigned int numberOfThreads, WorkScheduler *scheduler)
+    : encryptionEngine(modulus, publicExponent, numberOfThreads, scheduler){
+/***********************************************************************
+* Constructor for the EncryptionStream class, which encrypts a file of any size
+* into a CiphertextContainer while only holding a few chunks of it in memory.
+*
+* Arguments:
+* @ modulus: The modulus (n) of the public key.
+* @ publicExponent: The public exponent (e) of the public key.
+* @ numberOfThreads: The number of threads the EncryptionEngine uses for each chunk, 0 uses one per core.
+* @ scheduler: The WorkScheduler the chunks are encrypted on, or nullptr to start threads for each chunk.
+***********************************************************************/
+    this->modulus = mpz_class(modulus);
+    this->publicExponent = mpz_class(publicExponent);
+    this->blockSize = encryptionEngine.getBlockSize();
+    this->blocksPerChunk = std::max<size_t>(1, CHUNK_SIZE / blockSize);
+}
+
+bool EncryptionStream::encrypt(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured, JobProgress *progress){
+/***********************************************************************
+* Encrypts the input into a BLOCK_VERSION container, where every block of the padded
+* plaintext is encrypted with RSA. The number of blocks in the header is worked out from
+* inputSize, as the padding always adds between 1 and blockSize bytes.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ output: The stream the container is written to.
+* @ armoured: Whether the container is written as ASCII armour instead of binary.
+* @ progress: Has the number of blocks added to its total and is advanced as each range of them is encrypted, or nullptr.
+*
+* Returns:
+*  True: If all of the input has been encrypted and written.
+*  False: If the input could not be read (or was a different size), the output could not be written,
+*         or progress was cancelled.
+***********************************************************************/
+    ciphertextHeader header;
+    header.version = CiphertextContainer::BLOCK_VERSION;
+    header.cipher = 0;
+    header.keyFingerprint = CiphertextContainer::keyFingerprint(modulus.get_mpz_t(), publicExponent.get_mpz_t());
+    header.blockSize = static_cast<unsigned int>(blockSize);
+    header.encryptedBlockSize = static_cast<unsigned int>(encryptionEngine.getEncryptedBlockSize());
+    header.numberOfBlocks = inputSize / blockSize + 1;
+    if(progress != nullptr){
+        progress->addToTotal(header.numberOfBlocks);
+    }
+    return EncryptionStream::runPipeline(input, inputSize, output, armoured, CiphertextContainer::writeHeader(header), nullptr, progress);
+}
+
+bool EncryptionStream::encryptHybrid(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured, unsigned int cipher,
+                                     JobProgress *progress){
+/***********************************************************************
+* Encrypts the input into a HYBRID_VERSION container. RSA is only used once, to encrypt a
+* random shared secret of blockSize bytes (which is always smaller than the modulus), and
+* the session key derived from it encrypts the payload with AES-256-GCM or ChaCha20-Poly1305
+* in chunks, which is many thousands of times faster than encrypting every block with RSA.
+* No padding is needed, as the symmetric ciphers work on any number of bytes.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ output: The stream the container is written to.
+* @ armoured: Whether the container is written as ASCII armour instead of binary.
+* @ cipher: HybridEngine::AES_GCM or HybridEngine::CHACHA20_POLY1305.
+* @ progress: Has the number of chunks added to its total and is advanced as they are encrypted, or nullptr.
+*
+* Returns:
+*  True: If all of the input has been encrypted and written.
+*  False: If the input could not be read (or was a different size), the output could not be written,
+*         or progress was cancelled.
+***********************************************************************/
+    ciphertextHeader header;
+    header.version = CiphertextContainer::HYBRID_VERSION;
+    header.cipher = cipher;
+    header.keyFingerprint = CiphertextContainer::keyFingerprint(modulus.get_mpz_t(), publicExponent.get_mpz_t());
+    header.blockSize = static_cast<unsigned int>(HybridEngine::CHUNK_SIZE);
+    header.encryptedBlockSize = static_cast<unsigned int>(encryptionEngine.getEncryptedBlockSize());
+    header.numberOfBlocks = HybridEngine::getNumberOfChunks(inputSize, HybridEngine::CHUNK_SIZE);
+    std::string headerBytes = CiphertextContainer::writeHeader(header);
+    if(progress != nullptr){
+        progress->addToTotal(header.numberOfBlocks);
+    }
+
+    std::string sharedSecret(blockSize, '\0');
+    CryptoPP::AutoSeededRandomPool randomPool;
+    randomPool.GenerateBlock(reinterpret_cast<CryptoPP::byte*>(&sharedSecret[0]), sharedSecret.size());
+    std::string encryptedSecret;
+    encryptionEngine.encryptBlocks(sharedSecret, blockSize, encryptedSecret);
+    HybridEngine hybridEngine(cipher, sharedSecret, headerBytes, HybridEngine::CHUNK_SIZE, encryptionEngine.getNumberOfThreads(),
+                              encryptionEngine.getScheduler());
+    // Only the derived session key is needed from here on, so the secret is wiped straight away.
+    std::fill(sharedSecret.begin(), sharedSecret.end(), '\0');
+
+    return EncryptionStream::runPipeline(input, inputSize, output, armoured, headerBytes + encryptedSecret, &hybridEngine, progress);
+}
+
+bool EncryptionStream::runPipeline(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured,
+                                   const std::string &containerStart, HybridEngine *hybridEngine, JobProgress *progress){
+/***********************************************************************
+* Encrypts the input into the output as a pipeline of three stages, which all run at once:
+* - A reader thread reads the input a chunk at a time, and pads the last chunk for RSA blocks.
+* - This thread encrypts each chunk on every core, with the EncryptionEngine, or the
+*   HybridEngine if one is given.
+* - A writer thread writes each encrypted chunk to the output (armouring it if asked to).
+* The stages are joined by BoundedQueues of QUEUE_CAPACITY chunks, so no more than about
+* (2 * QUEUE_CAPACITY + 3) chunks are ever in memory, whatever the size of the input.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ output: The stream the container is written to.
+* @ armoured: Whether the container is written as ASCII armour instead of binary.
+* @ containerStart: The bytes written before the first chunk (the header, and for a hybrid container the encrypted secret).
+* @ hybridEngine: The HybridEngine to encrypt the chunks with, or nullptr to encrypt them with RSA.
+* @ progress: Advanced as the blocks (or hybrid chunks) are encrypted, or nullptr. Once it has been
+*             cancelled, no more chunks are encrypted and the pipeline is stopped.
+*
+* Returns:
+*  True: If all of the input has been encrypted and written.
+*  False: If the input could not be read (or was a different size), the output could not be written,
+*         or progress was cancelled.
+***********************************************************************/
+    size_t chunkBytes = blocksPerChunk * blockSize;
+    if(hybridEngine != nullptr){
+        chunkBytes = std::max<size_t>(1, CHUNK_SIZE / hybridEngine->getChunkSize()) * hybridEngine->getChunkSize();
+    }
+    std::atomic<bool> failed(false);
+    BoundedQueue<std::string> plaintextChunks(QUEUE_CAPACITY);
+    BoundedQueue<std::string> ciphertextChunks(QUEUE_CAPACITY);
+    ciphertextChunks.push(containerStart);
+    std::thread reader(&EncryptionStream::readChunks, this, &input, inputSize, chunkBytes, hybridEngine == nullptr, &plaintextChunks, &failed);
+    std::thread writer(&EncryptionStream::writeChunks, this, &output, armoured, &ciphertextChunks, &failed);
+
+    std::string plaintextChunk;
+    unsigned long long bytesEncrypted = 0;
+    while(plaintextChunks.pop(plaintextChunk) == true){
+        std::string ciphertextChunk;
+        if(hybridEngine == nullptr){
+            if(encryptionEngine.encryptBlocks(plaintextChunk, blockSize, ciphertextChunk, progress) == false){
+                failed = true;
+                break;
+            }
+        }
+        else{
+            unsigned long long firstChunk = bytesEncrypted / hybridEngine->getChunkSize();
+            bytesEncrypted += plaintextChunk.size();
+            hybridEngine->encryptChunks(plaintextChunk, firstChunk, bytesEncrypted == inputSize, ciphertextChunk);
+            if(progress != nullptr){
+                unsigned long long chunksEncrypted = (bytesEncrypted == inputSize) ? HybridEngine::getNumberOfChunks(inputSize, hybridEngine->getChunkSize())
+                                                                                   : bytesEncrypted / hybridEngine->getChunkSize();
+                progress->advance(chunksEncrypted - firstChunk);
+                if(progress->isCancelled() == true){
+                    failed = true;
+                    break;
+                }
+            }
+        }
+        if(ciphertextChunks.push(std::move(ciphertextChunk)) == false){
+            break;
+        }
+    }
+    // Closing both queues lets the reader and writer finish, even if one of them has failed.
+    plaintextChunks.close();
+    ciphertextChunks.close();
+    reader.join();
+    writer.join();
+    return failed == false;
+}
+
+void EncryptionStream::readChunks(std::istream *input, unsigned long long inputSize, size_t chunkBytes, bool padded,
+                                  BoundedQueue<std::string> *plaintextChunks, std::atomic<bool> *failed){
+/***********************************************************************
+* The reader stage. Reads chunkBytes at a time, and for RSA blocks adds the padding
+* (a PADDING_MARKER byte and then zeros up to a whole number of blocks) to the last chunk.
+* The last chunk is always passed on, even when it is empty.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ chunkBytes: The number of bytes in each chunk but the last.
+* @ padded: Whether the last chunk is padded to a whole number of blocks.
+* @ plaintextChunks: The queue the chunks are passed to the encryption stage on.
+* @ failed: A flag which is set if the input cannot be read.
+***********************************************************************/
+    unsigned long long bytesRemaining = inputSize;
+    while(true){
+        size_t bytesToRead = static_cast<size_t>(std::min<unsigned long long>(bytesRemaining, chunkBytes));
+        std::string plaintextChunk(bytesToRead, '\0');
+        if(bytesToRead != 0 && (input->read(&plaintextChunk[0], bytesToRead).gcount() != static_cast<std::streamsize>(bytesToRead))){
+            *failed = true;
+            break;
+        }
+        bytesRemaining -= bytesToRead;
+        if(bytesRemaining == 0){
+            if(input->peek() != std::istream::traits_type::eof()){
+                // The input is longer than inputSize, so it has changed since its size was worked out.
+                *failed = true;
+                break;
+            }
+            if(padded == true){
+                plaintextChunk += PADDING_MARKER;
+                plaintextChunk.append((blockSize - (plaintextChunk.length() % blockSize)) % blockSize, '\0');
+            }
+            plaintextChunks->push(std::move(plaintextChunk));
+            break;
+        }
+        if(plaintextChunks->push(std::move(plaintextChunk)) == false){
+            break;
+        }
+    }
+    plaintextChunks->close();
+}
+
+void EncryptionStream::writeChunks(std::ostream *output, bool armoured, BoundedQueue<std::string> *ciphertextChunks, std::atomic<bool> *failed){
+/***********************************************************************
+* The writer stage. Writes each chunk of the container to the output as soon as it
+* has been encrypted, armouring it a chunk at a time if asked to.
+*
+* Arguments:
+* @ output: The stream the container is written to.
+* @ armoured: Whether the container is written as ASCII armour instead of binary.
+* @ ciphertextChunks: The queue the encrypted chunks arrive on.
+* @ failed: A flag which is set if the output cannot be written.
+***********************************************************************/
+    ArmourEncoder armourEncoder;
+    std::string ciphertextChunk;
+    while(ciphertextChunks->pop(ciphertextChunk) == true){
+        if(armoured == true){
+            ciphertextChunk = armourEncoder.encode(ciphertextChunk);
+        }
+        if(output->write(ciphertextChunk.data(), ciphertextChunk.size()).fail() == true){
+            *failed = true;
+            // Closing the queue stops the encryption stage, which then stops the reader.
+            ciphertextChunks->close();
+            return;
+        }
+    }
+    if(armoured == true && *failed == false){
+        std::string lastLines = armourEncoder.finish();
+        if(output->write(lastLines.data(), lastLines.size()).fail() == true){
+            *failed = true;
+        }
+    }
+    output->flush();
+}
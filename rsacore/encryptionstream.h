@@ -0,0 +1,36 @@
+#ifndef ENCRYPTIONSTREAM_H
+#define ENCRYPTIONSTREAM_H
+
+#include "encryptionengine.h"
+#include "hybridengine.h"
+#include "boundedqueue.h"
+#include "jobprogress.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <istream>
+#include <ostream>
+#include <string>
+
+class EncryptionStream
+{
+public:
+    EncryptionStream(const mpz_t modulus, const mpz_t publicExponent, unsigned int numberOfThreads = 0, WorkScheduler *scheduler = nullptr);
+    bool encrypt(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured, JobProgress *progress = nullptr);
+    bool encryptHybrid(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured, unsigned int cipher,
+                       JobProgress *progress = nullptr);
+
+private:
+    mpz_class modulus;
+    mpz_class publicExponent;
+    EncryptionEngine encryptionEngine;
+    size_t blockSize;
+    size_t blocksPerChunk;
+
+    bool runPipeline(std::istream &input, unsigned long long inputSize, std::ostream &output, bool armoured,
+                     const std::string &containerStart, HybridEngine *hybridEngine, JobProgress *progress);
+    void readChunks(std::istream *input, unsigned long long inputSize, size_t chunkBytes, bool padded,
+                    BoundedQueue<std::string> *plaintextChunks, std::atomic<bool> *failed);
+    void writeChunks(std::ostream *output, bool armoured, BoundedQueue<std::string> *ciphertextChunks, std::atomic<bool> *failed);
+};
+
+#endif // ENCRYPTIONSTREAM_H
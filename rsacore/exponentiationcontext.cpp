@@ -0,0 +1,268 @@
+#include "exponentiationcontext.h"
+#include <gmpxx.h>
+
+#include <vector>
+
+static const long MAX_MONTGOMERY_EXPONENT_BITS = 64; // Longer exponents are left to mpz_powm, whose own reduction is faster than one built from the public mpn functions.
+static const int MIN_MULTI_BUFFER_BLOCKS = 3; // A batch costs the same however many lanes are used, and is about 3 times quicker per block than mpz_powm.
+
+ExponentiationContext::ExponentiationContext(){
+/***********************************************************************
+* Constructor for an empty ExponentiationContext, setKey() has to be called
+* before exponentiate() is used.
+***********************************************************************/
+    useMontgomery = false;
+    useFermatExponent = false;
+    useMultiBuffer = false;
+    windowSize = 1;
+    trailingSquarings = 0;
+}
+
+ExponentiationContext::ExponentiationContext(const mpz_t modulus, const mpz_t exponent){
+/***********************************************************************
+* Constructor for the ExponentiationContext, which does all of the work for
+* base^exponent mod modulus that does not depend on the base, once per key.
+*
+* Arguments:
+* @ modulus: The modulus of the key (n, or one of its primes for CRT).
+* @ exponent: The fixed exponent of the key (e, d, dP or dQ).
+***********************************************************************/
+    ExponentiationContext::setKey(modulus, exponent);
+}
+
+void ExponentiationContext::setKey(const mpz_t modulus, const mpz_t exponent){
+/***********************************************************************
+* Works out everything which only depends on the key, which mpz_powm would otherwise
+* work out again for every block:
+* - The Montgomery constants for the modulus (-n^-1 mod 2^64, R mod n and R^2 mod n).
+* - The exponent recoded into sliding windows, so each block only has to follow the
+*   list of squarings and table multiplications.
+* This setup is a large part of the work for a short exponent such as e = 65537, which only
+* needs 17 Montgomery operations. A long exponent (d, dP or dQ) needs thousands, where the
+* setup is too small to matter and mpz_powm's internal reduction is quicker, so exponents
+* longer than MAX_MONTGOMERY_EXPONENT_BITS still use mpz_powm.
+* Fixed width kernels, with the limb count of each key size as a template parameter, stack
+* operands and unrolled loops, were also tried for these exponents. Built with GCC -O2 they
+* ran at 0.87x (256 bits) down to 0.67x (4096 bits) of mpz_powm's speed, as compiled C can't
+* match the carry chains in GMP's assembly, so they were not added.
+* Montgomery multiplication only works with an odd modulus. Every RSA modulus and prime
+* is odd, but a damaged key could have an even modulus, which also falls back to mpz_powm.
+* For e = FERMAT_EXPONENT the correction factor R^65537 mod modulus is worked out instead
+* of the windows, see exponentiateFermat().
+* On processors with AVX-512 IFMA the constants for MultiBufferModExp are worked out too,
+* which exponentiateBatch() uses for any exponent.
+*
+* Arguments:
+* @ modulus: The modulus of the key.
+* @ exponent: The fixed, non-negative exponent of the key.
+***********************************************************************/
+    this->modulus = mpz_class(modulus);
+    this->exponent = mpz_class(exponent);
+    useMontgomery = mpz_odd_p(modulus) != 0 && mpz_sizeinbase(exponent, 2) <= static_cast<size_t>(MAX_MONTGOMERY_EXPONENT_BITS);
+    useFermatExponent = false;
+    useMultiBuffer = mpz_odd_p(modulus) != 0 && MultiBufferModExp::isSupported() == true;
+    if(useMultiBuffer == true){
+        multiBuffer.setModulus(modulus);
+    }
+    if(useMontgomery == true){
+        context.setModulus(modulus);
+        ExponentiationContext::recodeExponent();
+        if(mpz_cmp_ui(exponent, FERMAT_EXPONENT) == 0){
+            useFermatExponent = true;
+            int numberOfLimbs = context.getNumberOfLimbs();
+            mpz_class correction;
+            mpz_setbit(correction.get_mpz_t(), GMP_NUMB_BITS * numberOfLimbs);
+            mpz_powm_ui(correction.get_mpz_t(), correction.get_mpz_t(), FERMAT_EXPONENT, modulus);
+            fermatCorrection.assign(numberOfLimbs, 0);
+            for(int i = 0; i < static_cast<int>(mpz_size(correction.get_mpz_t())); i++){
+                fermatCorrection[i] = mpz_getlimbn(correction.get_mpz_t(), i);
+            }
+        }
+    }
+}
+
+int ExponentiationContext::getScratchSize() const{
+/***********************************************************************
+* Returns:
+*  The number of limbs exponentiate() and exponentiateBatch() need in their scratch buffer:
+*  the table of odd powers, the base squared, the running result and the MontgomeryContext's
+*  scratch, or MultiBufferModExp's scratch if that is larger. 0 when mpz_powm is used, as it
+*  manages its own memory.
+***********************************************************************/
+    int scratchSize = 0;
+    if(useMontgomery == true){
+        int tableSize = 1 << (windowSize - 1);
+        scratchSize = (tableSize + 2) * context.getNumberOfLimbs() + context.getScratchSize();
+    }
+    if(useMultiBuffer == true && multiBuffer.getScratchSize(exponent.get_mpz_t()) > scratchSize){
+        scratchSize = multiBuffer.getScratchSize(exponent.get_mpz_t());
+    }
+    return scratchSize;
+}
+
+int ExponentiationContext::getBatchSize() const{
+/***********************************************************************
+* Returns:
+*  The number of blocks worth passing to exponentiateBatch() at once, MultiBufferModExp::LANES
+*  when the processor has AVX-512 IFMA, otherwise 1.
+***********************************************************************/
+    return (useMultiBuffer == true) ? MultiBufferModExp::LANES : 1;
+}
+
+void ExponentiationContext::exponentiateBatch(mpz_ptr *results, const mpz_srcptr *bases, int count, std::vector<mp_limb_t> &scratch) const{
+/***********************************************************************
+* Works out results[i] = bases[i]^exponent mod modulus for count bases. With AVX-512 IFMA,
+* groups of up to MultiBufferModExp::LANES bases are worked out together, as long as there
+* are at least MIN_MULTI_BUFFER_BLOCKS of them, otherwise each base goes through exponentiate().
+*
+* Arguments:
+* @ results: count initialised multiprecision variables the results are written to.
+* @ bases: count numbers to raise to the power of the exponent.
+* @ count: The number of bases.
+* @ scratch: The worker's scratch vector, resized to getScratchSize() limbs if needed.
+***********************************************************************/
+    for(int first = 0; first < count; first += MultiBufferModExp::LANES){
+        int groupSize = (count - first < MultiBufferModExp::LANES) ? count - first : MultiBufferModExp::LANES;
+        if(useMultiBuffer == true && groupSize >= MIN_MULTI_BUFFER_BLOCKS){
+            multiBuffer.exponentiate(results + first, bases + first, groupSize, exponent.get_mpz_t(), scratch);
+            continue;
+        }
+        for(int i = first; i < first + groupSize; i++){
+            ExponentiationContext::exponentiate(results[i], bases[i], scratch);
+        }
+    }
+}
+
+void ExponentiationContext::exponentiate(mpz_t result, const mpz_t base, std::vector<mp_limb_t> &scratch) const{
+/***********************************************************************
+* Works out result = base^exponent mod modulus. Only the table of odd powers of the
+* base is made for each call, everything else was made by setKey(). The context is
+* never changed, so one context can be shared by every worker thread as long as each
+* has its own scratch vector.
+*
+* Arguments:
+* @ result: The initialised multiprecision variable the result is written to.
+* @ base: The number to raise to the power of the exponent.
+* @ scratch: The worker's scratch vector, resized to getScratchSize() limbs if needed.
+***********************************************************************/
+    if(useMontgomery == false){
+        mpz_powm(result, base, exponent.get_mpz_t(), modulus.get_mpz_t());
+        return;
+    }
+    int numberOfLimbs = context.getNumberOfLimbs();
+    int tableSize = 1 << (windowSize - 1);
+    if(scratch.size() < static_cast<size_t>(getScratchSize())){
+        scratch.resize(getScratchSize());
+    }
+    if(useFermatExponent == true){
+        ExponentiationContext::exponentiateFermat(result, base, scratch.data());
+        return;
+    }
+    mp_limb_t *table = scratch.data();
+    mp_limb_t *baseSquared = table + static_cast<size_t>(tableSize) * numberOfLimbs;
+    mp_limb_t *value = baseSquared + numberOfLimbs;
+    mp_limb_t *productScratch = value + numberOfLimbs;
+
+    // table[i] = base^(2i + 1), in Montgomery form.
+    context.toMontgomery(table, base, productScratch);
+    if(tableSize > 1){
+        context.square(baseSquared, table, productScratch);
+        for(int i = 1; i < tableSize; i++){
+            context.multiply(table + i * numberOfLimbs, table + (i - 1) * numberOfLimbs, baseSquared, productScratch);
+        }
+    }
+
+    // Squaring 1 does nothing, so the first window starts straight from its table entry.
+    const mp_limb_t *startValue = windows.empty() ? context.getOne() : table + windows[0].tableIndex * numberOfLimbs;
+    for(int i = 0; i < numberOfLimbs; i++){
+        value[i] = startValue[i];
+    }
+    for(size_t windowIndex = 1; windowIndex < windows.size(); windowIndex++){
+        for(int i = 0; i < windows[windowIndex].squarings; i++){
+            context.square(value, value, productScratch);
+        }
+        context.multiply(value, value, table + windows[windowIndex].tableIndex * numberOfLimbs, productScratch);
+    }
+    for(int i = 0; i < trailingSquarings; i++){
+        context.square(value, value, productScratch);
+    }
+    context.fromMontgomery(result, value, productScratch);
+}
+
+void ExponentiationContext::recodeExponent(){
+/***********************************************************************
+* Splits the exponent, from its top bit down, into left to right sliding windows of up to
+* windowSize bits which start and end with a 1 bit. Each window is stored as the number of
+* squarings before it (its zero bits and its length) and the table index of its value,
+* with the squarings for the zero bits after the last window kept in trailingSquarings.
+***********************************************************************/
+    long exponentBits = (mpz_sgn(exponent.get_mpz_t()) == 0) ? 0 : static_cast<long>(mpz_sizeinbase(exponent.get_mpz_t(), 2));
+    windowSize = (exponentBits > 671) ? 6 : (exponentBits > 239) ? 5 : (exponentBits > 79) ? 4 : (exponentBits > 23) ? 3 : 1;
+    windows.clear();
+
+    int pendingSquarings = 0;
+    long bitIndex = exponentBits - 1;
+    while(bitIndex >= 0){
+        if(mpz_tstbit(exponent.get_mpz_t(), bitIndex) == 0){
+            pendingSquarings++;
+            bitIndex--;
+            continue;
+        }
+        long windowEnd = (bitIndex - windowSize + 1 < 0) ? 0 : bitIndex - windowSize + 1;
+        while(mpz_tstbit(exponent.get_mpz_t(), windowEnd) == 0){
+            windowEnd++;
+        }
+        int windowValue = 0;
+        for(long i = bitIndex; i >= windowEnd; i--){
+            windowValue = (windowValue << 1) | mpz_tstbit(exponent.get_mpz_t(), i);
+        }
+        ExponentWindow window;
+        window.squarings = pendingSquarings + static_cast<int>(bitIndex - windowEnd + 1);
+        window.tableIndex = windowValue >> 1;
+        windows.push_back(window);
+        pendingSquarings = 0;
+        bitIndex = windowEnd - 1;
+    }
+    trailingSquarings = pendingSquarings;
+}
+
+void ExponentiationContext::exponentiateFermat(mpz_t result, const mpz_t base, mp_limb_t *scratch) const{
+/***********************************************************************
+* Works out result = base^65537 mod modulus with 16 Montgomery squarings and two
+* multiplications, and no table. The base is never converted into Montgomery form:
+* - Each squaring of a plain number a gives a^2 * R^-1, so 16 squarings give a^65536 * R^-65535.
+* - Multiplying by a gives a^65537 * R^-65536.
+* - Multiplying by fermatCorrection (R^65537) gives a^65537, which is already out of Montgomery form.
+* This saves the conversions into and out of Montgomery form, which cost about one
+* multiplication each.
+*
+* Arguments:
+* @ result: The initialised multiprecision variable the result is written to.
+* @ base: The number to raise to the power of 65537.
+* @ scratch: At least getScratchSize() limbs.
+***********************************************************************/
+    int numberOfLimbs = context.getNumberOfLimbs();
+    mp_limb_t *plainBase = scratch;
+    mp_limb_t *value = plainBase + numberOfLimbs;
+    mp_limb_t *productScratch = value + numberOfLimbs;
+
+    mpz_class reducedBase;
+    mpz_srcptr baseToUse = base;
+    if(mpz_sgn(base) < 0 || mpz_cmp(base, modulus.get_mpz_t()) >= 0){
+        mpz_mod(reducedBase.get_mpz_t(), base, modulus.get_mpz_t());
+        baseToUse = reducedBase.get_mpz_t();
+    }
+    int baseLimbs = static_cast<int>(mpz_size(baseToUse));
+    for(int i = 0; i < numberOfLimbs; i++){
+        plainBase[i] = (i < baseLimbs) ? mpz_getlimbn(baseToUse, i) : 0;
+    }
+
+    context.square(value, plainBase, productScratch);
+    for(int i = 1; i < 16; i++){
+        context.square(value, value, productScratch);
+    }
+    context.multiply(value, value, plainBase, productScratch);
+    mp_limb_t *resultLimbs = mpz_limbs_write(result, numberOfLimbs);
+    context.multiply(resultLimbs, value, fermatCorrection.data(), productScratch);
+    mpz_limbs_finish(result, numberOfLimbs);
+}
@@ -0,0 +1,44 @@
+#ifndef EXPONENTIATIONCONTEXT_H
+#define EXPONENTIATIONCONTEXT_H
+
+#include "montgomerycontext.h"
+#include "multibuffermodexp.h"
+#include <gmpxx.h>
+#include <vector>
+
+class ExponentiationContext
+{
+public:
+    static const unsigned long FERMAT_EXPONENT = 65537; // 2^16 + 1, the public exponent used by every key this program makes.
+
+    ExponentiationContext();
+    ExponentiationContext(const mpz_t modulus, const mpz_t exponent);
+    void setKey(const mpz_t modulus, const mpz_t exponent);
+    void exponentiate(mpz_t result, const mpz_t base, std::vector<mp_limb_t> &scratch) const;
+    void exponentiateBatch(mpz_ptr *results, const mpz_srcptr *bases, int count, std::vector<mp_limb_t> &scratch) const;
+    int getBatchSize() const;
+    int getScratchSize() const;
+
+private:
+    struct ExponentWindow{
+        int squarings;
+        int tableIndex;
+    };
+
+    MontgomeryContext context;
+    mpz_class modulus;
+    mpz_class exponent;
+    bool useMontgomery;
+    bool useFermatExponent;
+    bool useMultiBuffer;
+    MultiBufferModExp multiBuffer;
+    std::vector<mp_limb_t> fermatCorrection;
+    int windowSize;
+    std::vector<ExponentWindow> windows;
+    int trailingSquarings;
+
+    void recodeExponent();
+    void exponentiateFermat(mpz_t result, const mpz_t base, mp_limb_t *scratch) const;
+};
+
+#endif // EXPONENTIATIONCONTEXT_H
@@ -0,0 +1,174 @@
+#include "filedecryptor.h"
+#include "decryptionengine.h"
+#include "decryptionstream.h"
+#include <gmpxx.h>
+#include <includes/base64.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+FileDecryptor::FileDecryptor(const privateKey* privateKeyStruct, unsigned int numberOfThreads, JobProgress *progress, WorkScheduler *scheduler)
+    : decryptionStream(privateKeyStruct->modulus, privateKeyStruct->publicExponent, privateKeyStruct->privateExponent,
+                       privateKeyStruct->prime1, privateKeyStruct->prime2,
+                       privateKeyStruct->exponent1, privateKeyStruct->exponent2, privateKeyStruct->coefficient, numberOfThreads, scheduler){
+/***********************************************************************
+* Constructor for the FileDecryptor class, which decrypts files encrypted for one private key.
+* The key is copied into the DecryptionStream, whose DecryptionEngine also decrypts files from
+* older versions of the program, so the key is only set up once and the privateKey structure can
+* be cleared straight after. Every FileDecryptor has its own buffers, so several can run at the same time.
+* The CRT values of the key should have been prepared with KeyFile::prepareCRTParameters(),
+* which KeyFile::loadPrivateKey() does.
+*
+* Arguments:
+* @ privateKeyStruct: The private key the files are decrypted with.
+* @ numberOfThreads: The number of threads the blocks are decrypted on, 0 (the default) uses one per core.
+* @ progress: Counts the blocks (or hybrid chunks) as they are decrypted and can cancel the decryption, or nullptr.
+* @ scheduler: The WorkScheduler shared by every file being decrypted at the same time, or nullptr.
+***********************************************************************/
+    this->unreadableInput = false;
+    this->progress = progress;
+}
+
+bool FileDecryptor::decryptFile(const std::string &inputFilepath, const std::string &outputFilepath){
+/***********************************************************************
+* Decrypts the file at inputFilepath into outputFilepath.
+* Containers are decrypted straight to the output file a chunk at a time, while files
+* from older versions of the program are still decrypted in memory.
+*
+* Arguments:
+* @ inputFilepath: The filepath of the encrypted file.
+* @ outputFilepath: The filepath the decrypted, plain-text file is written to.
+*
+* Returns:
+*  True: If the decrypted file has been written.
+*  False: If the input could not be read (see couldNotReadInput()), or was not encrypted for this key
+*         (see wasEncryptedForDifferentKey()), or has been damaged, or the JobProgress was cancelled.
+*         Any partly written output file is deleted.
+***********************************************************************/
+    unreadableInput = false;
+    std::ifstream inputFileStream(inputFilepath, std::ios::binary);
+    if(inputFileStream.is_open() == false){
+        unreadableInput = true;
+        return false;
+    }
+    if(DecryptionStream::isStreamable(inputFileStream) == true){
+        return FileDecryptor::decryptContainer(inputFileStream, outputFilepath);
+    }
+    return FileDecryptor::decryptOldFile(inputFileStream, outputFilepath);
+}
+
+bool FileDecryptor::decrypt(std::istream &input, std::ostream &output){
+/***********************************************************************
+* Decrypts a CiphertextContainer (binary or armoured) from any stream, e.g. stdin, into the
+* output a chunk at a time. The input does not have to be seekable, so files from older
+* versions of the program, which have to be recognised first, can only be decrypted with decryptFile().
+*
+* Arguments:
+* @ input: The stream the container is read from.
+* @ output: The stream the plaintext is written to.
+*
+* Returns:
+*  True: If all of the container has been decrypted and written.
+*  False: If it was not encrypted for this key (see wasEncryptedForDifferentKey()), or has been
+*         damaged, or the output could not be written, or the JobProgress was cancelled.
+*         Some plaintext may already have been written.
+***********************************************************************/
+    unreadableInput = false;
+    return decryptionStream.decrypt(input, output, progress);
+}
+
+bool FileDecryptor::couldNotReadInput() const{
+/***********************************************************************
+* Returns:
+*  True: If the last decryptFile() failed because the encrypted file could not be opened.
+*  False: If it did not.
+***********************************************************************/
+    return unreadableInput;
+}
+
+bool FileDecryptor::wasEncryptedForDifferentKey() const{
+/***********************************************************************
+* Returns:
+*  True: If the last container failed because its header has the fingerprint of a different key.
+*  False: If it did not.
+***********************************************************************/
+    return decryptionStream.wasEncryptedForDifferentKey();
+}
+
+bool FileDecryptor::decryptContainer(std::istream &inputStream, const std::string &outputFilepath){
+/***********************************************************************
+* A function which decrypts a CiphertextContainer (binary or armoured) into the file at
+* outputFilepath. The DecryptionStream reads, decrypts and writes the file a chunk at a
+* time, so files of any size are decrypted using a fixed amount of memory.
+*
+* Arguments:
+*  @ inputStream: The stream of the encrypted file.
+*  @ outputFilepath: The filepath the decrypted file is written to.
+*
+* Returns:
+*  True: If the decrypted file has been written.
+*  False: If the file could not be decrypted or written, any partly written output file is deleted.
+***********************************************************************/
+    std::ofstream outputFileStream(outputFilepath, std::ios::binary | std::ios::trunc);
+    if(outputFileStream.is_open() == false){
+        return false;
+    }
+    bool decrypted = decryptionStream.decrypt(inputStream, outputFileStream, progress);
+    outputFileStream.close();
+    if(decrypted == false || outputFileStream.fail() == true){
+        std::remove(outputFilepath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FileDecryptor::decryptOldFile(std::istream &inputStream, const std::string &outputFilepath){
+/***********************************************************************
+* Decrypts a file from an older version of the program, which is base64 encoded decimal
+* blocks. The whole file is read, decrypted into a buffer and then written to outputFilepath.
+*
+* Arguments:
+*  @ inputStream: The stream of the encrypted file.
+*  @ outputFilepath: The filepath the decrypted file is written to.
+*
+* Returns:
+*  True: If the decrypted file has been written.
+*  False: If the file could not be decrypted with this key, or could not be written.
+***********************************************************************/
+    std::stringstream bufferStream;
+    bufferStream << inputStream.rdbuf();
+    std::string textFromFile;
+    macaron::Base64::Decode(bufferStream.str(), textFromFile);
+    std::string decryptedString;
+    if(FileDecryptor::decryptString(textFromFile, decryptedString) == false){
+        return false;
+    }
+
+    std::ofstream outputFileStream(outputFilepath);
+    if(outputFileStream.is_open() == false){
+        return false;
+    }
+    outputFileStream << decryptedString;
+    outputFileStream.close();
+    return outputFileStream.fail() == false;
+}
+
+bool FileDecryptor::decryptString(const std::string &stringToDecrypt, std::string &decryptedString){
+/***********************************************************************
+* A function which decrypts files written by older versions of the program.
+* The blocks are split at the delimiter, which in this case is a forward slash ('/'),
+* and are decrypted on every core by the DecryptionStream's DecryptionEngine. These files always used
+* 32 character blocks, which are written out without any padding.
+*
+* Arguments:
+*  @ stringToDecrypt: The entire string, from the encrypted file, once it has been base64 decoded.
+*  @ decryptedString: The buffer the decrypted text is written to.
+*
+* Returns:
+*  True: If the string has been decrypted.
+*  False: If a block is not valid for this key.
+***********************************************************************/
+    return decryptionStream.getDecryptionEngine().decryptBlocks(stringToDecrypt, decryptedString, progress);
+}
@@ -0,0 +1,34 @@
+#ifndef FILEDECRYPTOR_H
+#define FILEDECRYPTOR_H
+
+#include "keyfile.h"
+#include "decryptionengine.h"
+#include "decryptionstream.h"
+#include "jobprogress.h"
+#include "workscheduler.h"
+#include <gmpxx.h>
+#include <istream>
+#include <ostream>
+#include <string>
+
+class FileDecryptor
+{
+public:
+    FileDecryptor(const privateKey* privateKeyStruct, unsigned int numberOfThreads = 0, JobProgress *progress = nullptr,
+                  WorkScheduler *scheduler = nullptr);
+    bool decryptFile(const std::string &inputFilepath, const std::string &outputFilepath);
+    bool decrypt(std::istream &input, std::ostream &output);
+    bool couldNotReadInput() const;
+    bool wasEncryptedForDifferentKey() const;
+
+private:
+    DecryptionStream decryptionStream;
+    bool unreadableInput;
+    JobProgress *progress;
+
+    bool decryptContainer(std::istream &inputStream, const std::string &outputFilepath);
+    bool decryptOldFile(std::istream &inputStream, const std::string &outputFilepath);
+    bool decryptString(const std::string &stringToDecrypt, std::string &decryptedString);
+};
+
+#endif // FILEDECRYPTOR_H
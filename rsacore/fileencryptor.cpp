@@ -0,0 +1,131 @@
+#include "fileencryptor.h"
+#include "encryptionstream.h"
+#include "hybridengine.h"
+#include <gmpxx.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+const int FileEncryptor::MODE_AES_GCM;
+const int FileEncryptor::MODE_CHACHA20_POLY1305;
+const int FileEncryptor::MODE_RSA_BLOCKS;
+
+FileEncryptor::FileEncryptor(const publicKey* publicKeyStruct, const encryptionConfig &config)
+    : encryptionStream(publicKeyStruct->modulus, publicKeyStruct->publicExponent, config.numberOfThreads, config.scheduler){
+/***********************************************************************
+* Constructor for the FileEncryptor class, which encrypts files (or text) for one public key
+* into CiphertextContainers. The key is copied into the EncryptionStream, so the publicKey
+* structure can be cleared straight after, and every FileEncryptor has its own buffers,
+* so several can run at the same time.
+*
+* Arguments:
+* @ publicKeyStruct: The public key the files are encrypted for.
+* @ config: The encryption mode, whether the output is armoured, the number of threads, the WorkScheduler and the JobProgress.
+***********************************************************************/
+    this->config = config;
+}
+
+bool FileEncryptor::encryptFile(const std::string &inputFilepath, const std::string &outputFilepath){
+/***********************************************************************
+* Encrypts the file at inputFilepath into a CiphertextContainer at outputFilepath.
+*
+* Arguments:
+* @ inputFilepath: The filepath of the plaintext file.
+* @ outputFilepath: The filepath the container is written to, including its extension.
+*
+* Returns:
+*  True: If the encrypted file has been written.
+*  False: If the input could not be read, the output could not be written or the JobProgress
+*         was cancelled, any partly written output file is deleted.
+***********************************************************************/
+    std::ifstream inputFileStream(inputFilepath, std::ios::binary | std::ios::ate);
+    if(inputFileStream.is_open() == false){
+        return false;
+    }
+    unsigned long long inputSize = static_cast<unsigned long long>(inputFileStream.tellg());
+    inputFileStream.seekg(0);
+    return FileEncryptor::encryptToFile(inputFileStream, inputSize, outputFilepath);
+}
+
+bool FileEncryptor::encryptText(const std::string &plaintext, const std::string &outputFilepath){
+/***********************************************************************
+* Encrypts a string (e.g. from a text box) into a CiphertextContainer at outputFilepath.
+*
+* Arguments:
+* @ plaintext: The text to encrypt.
+* @ outputFilepath: The filepath the container is written to, including its extension.
+*
+* Returns:
+*  True: If the encrypted file has been written.
+*  False: If the output could not be written or the JobProgress was cancelled, any partly
+*         written output file is deleted.
+***********************************************************************/
+    std::istringstream inputTextStream(plaintext);
+    return FileEncryptor::encryptToFile(inputTextStream, plaintext.size(), outputFilepath);
+}
+
+bool FileEncryptor::encrypt(std::istream &input, unsigned long long inputSize, std::ostream &output){
+/***********************************************************************
+* Runs the EncryptionStream in the mode chosen in the config. The hybrid modes only encrypt
+* a random key with RSA and the data itself with AES-256-GCM or ChaCha20-Poly1305 (which is
+* far faster), MODE_RSA_BLOCKS encrypts every block of the data with RSA. The config's
+* JobProgress, if there is one, is passed on to the EncryptionStream.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ output: The stream the container is written to.
+*
+* Returns:
+*  True: If the input has been encrypted and written.
+*  False: If it has not, or the JobProgress was cancelled.
+***********************************************************************/
+    if(config.encryptionMode == MODE_AES_GCM){
+        return encryptionStream.encryptHybrid(input, inputSize, output, config.armoured, HybridEngine::AES_GCM, config.progress);
+    }
+    if(config.encryptionMode == MODE_CHACHA20_POLY1305){
+        return encryptionStream.encryptHybrid(input, inputSize, output, config.armoured, HybridEngine::CHACHA20_POLY1305, config.progress);
+    }
+    return encryptionStream.encrypt(input, inputSize, output, config.armoured, config.progress);
+}
+
+std::string FileEncryptor::getExtension(bool armoured){
+/***********************************************************************
+* Arguments:
+* @ armoured: Whether the container is written as ASCII armour.
+*
+* Returns:
+* @ extension: ".txt" for armoured containers, and ".rsa" for binary ones.
+***********************************************************************/
+    return armoured ? ".txt" : ".rsa";
+}
+
+bool FileEncryptor::encryptToFile(std::istream &input, unsigned long long inputSize, const std::string &outputFilepath){
+/***********************************************************************
+* Encrypts the input into the file at outputFilepath. The EncryptionStream reads, encrypts
+* and writes the file a chunk at a time, so files of any size are encrypted using a fixed
+* amount of memory.
+*
+* Arguments:
+* @ input: The stream the plaintext is read from.
+* @ inputSize: The number of bytes in the input.
+* @ outputFilepath: The filepath the container is written to.
+*
+* Returns:
+*  True: If the encrypted file has been written.
+*  False: If it has not, any partly written output file is deleted.
+***********************************************************************/
+    std::ofstream outputFileStream(outputFilepath, std::ios::binary | std::ios::trunc);
+    if(outputFileStream.is_open() == false){
+        return false;
+    }
+    bool encrypted = FileEncryptor::encrypt(input, inputSize, outputFileStream);
+    outputFileStream.close();
+    if(encrypted == false || outputFileStream.fail() == true){
+        std::remove(outputFilepath.c_str());
+        return false;
+    }
+    return true;
+}
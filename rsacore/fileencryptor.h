@@ -0,0 +1,41 @@
+#ifndef FILEENCRYPTOR_H
+#define FILEENCRYPTOR_H
+
+#include "keyfile.h"
+#include "encryptionstream.h"
+#include "jobprogress.h"
+#include "workscheduler.h"
+#include <gmpxx.h>
+#include <istream>
+#include <ostream>
+#include <string>
+
+struct encryptionConfig{
+    int encryptionMode = 0; // One of the FileEncryptor modes, hybrid RSA + AES-256-GCM by default.
+    bool armoured = false; // Whether the container is written as ASCII armour instead of binary.
+    unsigned int numberOfThreads = 0; // The number of threads each chunk is encrypted on, 0 uses one per core.
+    WorkScheduler *scheduler = nullptr; // The WorkScheduler shared by every file being encrypted at the same time, if there is one.
+    JobProgress *progress = nullptr; // Counts the blocks (or hybrid chunks) as they are encrypted and can cancel the encryption, if there is one.
+};
+
+class FileEncryptor
+{
+public:
+    static const int MODE_AES_GCM = 0;
+    static const int MODE_CHACHA20_POLY1305 = 1;
+    static const int MODE_RSA_BLOCKS = 2;
+
+    FileEncryptor(const publicKey* publicKeyStruct, const encryptionConfig &config);
+    bool encryptFile(const std::string &inputFilepath, const std::string &outputFilepath);
+    bool encryptText(const std::string &plaintext, const std::string &outputFilepath);
+    bool encrypt(std::istream &input, unsigned long long inputSize, std::ostream &output);
+    static std::string getExtension(bool armoured);
+
+private:
+    encryptionConfig config;
+    EncryptionStream encryptionStream;
+
+    bool encryptToFile(std::istream &input, unsigned long long inputSize, const std::string &outputFilepath);
+};
+
+#endif // FILEENCRYPTOR_H
@@ -0,0 +1,278 @@
+#include "hybridengine.h"
+
+#include <algorithm>
+#include <thread>
+#include <cryptopp/aes.h>
+#include <cryptopp/gcm.h>
+#include <cryptopp/chachapoly.h>
+#include <cryptopp/hkdf.h>
+#include <cryptopp/sha.h>
+
+static const std::string KEY_DERIVATION_INFO = "RSA_Project hybrid session key"; // Binds the session key to this use of the shared secret.
+
+const unsigned int HybridEngine::AES_GCM;
+const unsigned int HybridEngine::CHACHA20_POLY1305;
+const size_t HybridEngine::KEY_SIZE;
+const size_t HybridEngine::NONCE_SIZE;
+const size_t HybridEngine::TAG_SIZE;
+const size_t HybridEngine::CHUNK_SIZE;
+const size_t HybridEngine::MAX_CHUNK_SIZE;
+
+HybridEngine::HybridEngine(unsigned int cipher, const std::string &sharedSecret, const std::string &associatedData,
+                           size_t chunkSize, unsigned int numberOfThreads, WorkScheduler *scheduler) : sessionKey(KEY_SIZE){
+/***********************************************************************
+* Constructor for the HybridEngine class, which encrypts the payload of a hybrid container
+* with an authenticated symmetric cipher (AES-256-GCM or ChaCha20-Poly1305), one chunk per
+* worker at a time, on every core of the machine.
+* The session key is derived from the RSA encrypted shared secret with HKDF-SHA256, using the
+* container's header as part of the info, so the key is only ever used for this one file.
+*
+* Arguments:
+* @ cipher: AES_GCM or CHACHA20_POLY1305.
+* @ sharedSecret: The random secret which is RSA encrypted into the container.
+* @ associatedData: The container's header, which every chunk's tag authenticates.
+* @ chunkSize: The number of plaintext bytes in each chunk (the last one can be shorter).
+* @ numberOfThreads: The number of worker threads to use, 0 uses one per core.
+* @ scheduler: The WorkScheduler the workers run on, or nullptr to start threads for each batch of chunks.
+***********************************************************************/
+    this->cipher = cipher;
+    this->scheduler = scheduler;
+    this->associatedData = associatedData;
+    this->chunkSize = (chunkSize == 0) ? CHUNK_SIZE : chunkSize;
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 when the number of cores cannot be worked out.
+    this->numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+
+    std::string info = KEY_DERIVATION_INFO + associatedData;
+    CryptoPP::HKDF<CryptoPP::SHA256> keyDerivation;
+    keyDerivation.DeriveKey(sessionKey.data(), sessionKey.size(),
+                            reinterpret_cast<const CryptoPP::byte*>(sharedSecret.data()), sharedSecret.size(),
+                            nullptr, 0, reinterpret_cast<const CryptoPP::byte*>(info.data()), info.size());
+}
+
+size_t HybridEngine::getChunkSize() const{
+/***********************************************************************
+* Returns:
+*  chunkSize: The number of plaintext bytes in each chunk.
+***********************************************************************/
+    return chunkSize;
+}
+
+unsigned int HybridEngine::getNumberOfThreads() const{
+/***********************************************************************
+* Returns:
+*  numberOfThreads: The number of worker threads the chunks are shared between.
+***********************************************************************/
+    return numberOfThreads;
+}
+
+bool HybridEngine::isSupportedCipher(unsigned int cipher){
+/***********************************************************************
+* Returns:
+*  True: If the cipher number (from a container's header) is one this version can decrypt.
+*  False: If it is not.
+***********************************************************************/
+    return cipher == AES_GCM || cipher == CHACHA20_POLY1305;
+}
+
+unsigned long long HybridEngine::getNumberOfChunks(unsigned long long plaintextSize, size_t chunkSize){
+/***********************************************************************
+* Works out how many chunks a payload is split into. An empty payload is still one
+* (empty) chunk, so that its tag proves nothing has been cut off the end.
+*
+* Arguments:
+* @ plaintextSize: The number of bytes in the payload.
+* @ chunkSize: The number of plaintext bytes in each chunk.
+*
+* Returns:
+* @ numberOfChunks: The number of chunks, at least one.
+***********************************************************************/
+    unsigned long long numberOfChunks = (plaintextSize + chunkSize - 1) / chunkSize;
+    return (numberOfChunks == 0) ? 1 : numberOfChunks;
+}
+
+void HybridEngine::encryptChunks(const std::string &plaintext, unsigned long long firstChunk, bool lastBatch, std::string &ciphertext){
+/***********************************************************************
+* Encrypts a batch of chunks. Every chunk is encrypted under its own nonce (made from its
+* index) and is followed by its TAG_SIZE byte tag, so each one has its own slot in the
+* ciphertext, made before the workers start, like the blocks in the EncryptionEngine.
+*
+* Arguments:
+* @ plaintext: The plaintext of the batch, a multiple of the chunk size unless it is the last batch.
+* @ firstChunk: The index of the batch's first chunk within the whole payload.
+* @ lastBatch: Whether this batch ends the payload, its last chunk is then marked as the final one.
+* @ ciphertext: The string the encrypted chunks are added onto.
+***********************************************************************/
+    size_t numberOfChunks = lastBatch ? static_cast<size_t>(getNumberOfChunks(plaintext.length(), chunkSize)) : plaintext.length() / chunkSize;
+    if(numberOfChunks == 0){
+        return;
+    }
+    std::vector<ChunkPosition> chunks(numberOfChunks);
+    for(size_t i = 0; i < numberOfChunks; i++){
+        chunks[i].inputStart = i * chunkSize;
+        chunks[i].inputLength = std::min(chunkSize, plaintext.length() - chunks[i].inputStart);
+        chunks[i].outputStart = i * (chunkSize + TAG_SIZE);
+        chunks[i].index = firstChunk + i;
+        chunks[i].last = lastBatch && i == numberOfChunks - 1;
+    }
+    size_t ciphertextStart = ciphertext.length();
+    ciphertext.resize(ciphertextStart + chunks.back().outputStart + chunks.back().inputLength + TAG_SIZE);
+    std::atomic<bool> failed(false);
+    HybridEngine::runWorkers(plaintext.data(), chunks, true, &ciphertext[ciphertextStart], &failed);
+}
+
+bool HybridEngine::decryptChunks(const std::string &ciphertext, size_t start, size_t length, unsigned long long firstChunk, bool lastBatch, std::string &plaintext){
+/***********************************************************************
+* Decrypts and checks a batch of chunks. Every chunk but the payload's last one is exactly
+* chunk size + TAG_SIZE bytes, so the chunks are found from their index and decrypted in parallel.
+*
+* Arguments:
+* @ ciphertext: The data containing the encrypted chunks.
+* @ start: The position in the ciphertext where the batch's first chunk starts.
+* @ length: The number of bytes in the batch.
+* @ firstChunk: The index of the batch's first chunk within the whole payload.
+* @ lastBatch: Whether this batch ends the payload, its last chunk must then be marked as the final one.
+* @ plaintext: The string the decrypted chunks are added onto.
+*
+* Returns:
+*  True: If every chunk has been decrypted and its tag is valid.
+*  False: If a chunk has been changed, is in the wrong place or the batch is cut short,
+*         in which case none of the batch is added to the plaintext.
+***********************************************************************/
+    size_t recordSize = chunkSize + TAG_SIZE;
+    if(start > ciphertext.length() || length > ciphertext.length() - start
+            || (lastBatch == false && length % recordSize != 0) || (lastBatch == true && length == 0)){
+        return false;
+    }
+    size_t numberOfChunks = (length + recordSize - 1) / recordSize;
+    if(numberOfChunks == 0){
+        return true;
+    }
+    std::vector<ChunkPosition> chunks(numberOfChunks);
+    for(size_t i = 0; i < numberOfChunks; i++){
+        size_t recordLength = std::min(recordSize, length - i * recordSize);
+        if(recordLength < TAG_SIZE){
+            return false;
+        }
+        chunks[i].inputStart = start + i * recordSize;
+        chunks[i].inputLength = recordLength - TAG_SIZE;
+        chunks[i].outputStart = i * chunkSize;
+        chunks[i].index = firstChunk + i;
+        chunks[i].last = lastBatch && i == numberOfChunks - 1;
+    }
+    size_t plaintextStart = plaintext.length();
+    plaintext.resize(plaintextStart + chunks.back().outputStart + chunks.back().inputLength);
+    std::atomic<bool> failed(false);
+    // An empty final chunk has no plaintext, so there may be no byte for the pointer to point to.
+    HybridEngine::runWorkers(ciphertext.data(), chunks, false, &plaintext[0] + plaintextStart, &failed);
+    if(failed == true){
+        plaintext.resize(plaintextStart);
+        return false;
+    }
+    return true;
+}
+
+void HybridEngine::runWorkers(const char *input, const std::vector<ChunkPosition> &chunks, bool encrypting, char *output, std::atomic<bool> *failed){
+/***********************************************************************
+* Shares the chunks out between the workers, the calling thread works as well.
+*
+* Arguments:
+* @ input: The data the chunks are read from.
+* @ chunks: Where each chunk is read from and written to.
+* @ encrypting: Whether the chunks are being encrypted or decrypted.
+* @ output: The slots the chunks are written to.
+* @ failed: A flag which is set if any chunk's tag is not valid.
+***********************************************************************/
+    unsigned int workersNeeded = static_cast<unsigned int>(std::min<size_t>(numberOfThreads, chunks.size()));
+    std::atomic<size_t> nextChunk(0);
+    WorkScheduler::runWorkers(scheduler, workersNeeded, [&](){
+        HybridEngine::chunkWorker(input, &chunks, encrypting, output, &nextChunk, failed);
+    });
+}
+
+void HybridEngine::chunkWorker(const char *input, const std::vector<ChunkPosition> *chunks, bool encrypting, char *output,
+                               std::atomic<size_t> *nextChunk, std::atomic<bool> *failed){
+/***********************************************************************
+* The function that each worker thread runs. Each worker keys its own cipher once
+* (the cipher objects cannot be shared between threads), then keeps taking the next
+* chunk until there are none left, or until any chunk has failed to decrypt.
+*
+* Arguments:
+* @ input: The data the chunks are read from.
+* @ chunks: Where each chunk is read from and written to.
+* @ encrypting: Whether the chunks are being encrypted or decrypted.
+* @ output: The slots the chunks are written to.
+* @ nextChunk: The index of the next chunk which no worker has taken yet.
+* @ failed: A flag which is set if any chunk's tag is not valid.
+***********************************************************************/
+    std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher> authenticatedCipher = HybridEngine::createCipher(encrypting);
+    CryptoPP::byte nonce[NONCE_SIZE];
+    const CryptoPP::byte *header = reinterpret_cast<const CryptoPP::byte*>(associatedData.data());
+    HybridEngine::chunkNonce(0, false, nonce);
+    authenticatedCipher->SetKeyWithIV(sessionKey.data(), sessionKey.size(), nonce, NONCE_SIZE);
+
+    while(*failed == false){
+        size_t chunkIndex = nextChunk->fetch_add(1);
+        if(chunkIndex >= chunks->size()){
+            break;
+        }
+        const ChunkPosition &chunk = (*chunks)[chunkIndex];
+        HybridEngine::chunkNonce(chunk.index, chunk.last, nonce);
+        const CryptoPP::byte *chunkInput = reinterpret_cast<const CryptoPP::byte*>(input + chunk.inputStart);
+        CryptoPP::byte *chunkOutput = reinterpret_cast<CryptoPP::byte*>(output + chunk.outputStart);
+        if(encrypting == true){
+            authenticatedCipher->EncryptAndAuthenticate(chunkOutput, chunkOutput + chunk.inputLength, TAG_SIZE, nonce, NONCE_SIZE,
+                                                        header, associatedData.size(), chunkInput, chunk.inputLength);
+        }
+        else if(authenticatedCipher->DecryptAndVerify(chunkOutput, chunkInput + chunk.inputLength, TAG_SIZE, nonce, NONCE_SIZE,
+                                                      header, associatedData.size(), chunkInput, chunk.inputLength) == false){
+            *failed = true;
+        }
+    }
+}
+
+std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher> HybridEngine::createCipher(bool encrypting){
+/***********************************************************************
+* Makes an (unkeyed) cipher object for the engine's cipher. Crypto++ picks the AES-NI,
+* or the SIMD ChaCha20, code at run time when the processor supports it.
+*
+* Arguments:
+* @ encrypting: Whether the cipher is for encryption or decryption.
+*
+* Returns:
+* @ authenticatedCipher: The cipher object.
+***********************************************************************/
+    if(cipher == CHACHA20_POLY1305){
+        if(encrypting == true){
+            return std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher>(new CryptoPP::ChaCha20Poly1305::Encryption());
+        }
+        return std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher>(new CryptoPP::ChaCha20Poly1305::Decryption());
+    }
+    if(encrypting == true){
+        return std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher>(new CryptoPP::GCM<CryptoPP::AES>::Encryption());
+    }
+    return std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher>(new CryptoPP::GCM<CryptoPP::AES>::Decryption());
+}
+
+void HybridEngine::chunkNonce(unsigned long long index, bool last, CryptoPP::byte *nonce){
+/***********************************************************************
+* Makes the NONCE_SIZE byte nonce for a chunk: its index as 8 big endian bytes, three zero
+* bytes, then 1 for the payload's final chunk and 0 for every other one. The session key
+* is never used for another file, so the index alone keeps the nonces unique, and the final
+* flag means removing chunks from the end (or adding any after it) is caught.
+*
+* Arguments:
+* @ index: The index of the chunk within the payload.
+* @ last: Whether this is the payload's final chunk.
+* @ nonce: The NONCE_SIZE bytes the nonce is written to.
+***********************************************************************/
+    for(int i = 0; i < 8; i++){
+        nonce[i] = static_cast<CryptoPP::byte>((index >> (8 * (7 - i))) & 0xFF);
+    }
+    nonce[8] = 0;
+    nonce[9] = 0;
+    nonce[10] = 0;
+    nonce[11] = last ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#ifndef HYBRIDENGINE_H
+#define HYBRIDENGINE_H
+
+#include "workscheduler.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/secblock.h>
+
+class HybridEngine
+{
+public:
+    static const unsigned int AES_GCM = 1;
+    static const unsigned int CHACHA20_POLY1305 = 2;
+    static const size_t KEY_SIZE = 32;
+    static const size_t NONCE_SIZE = 12;
+    static const size_t TAG_SIZE = 16;
+    static const size_t CHUNK_SIZE = 1 << 16;
+    static const size_t MAX_CHUNK_SIZE = 1 << 24;
+
+    HybridEngine(unsigned int cipher, const std::string &sharedSecret, const std::string &associatedData,
+                 size_t chunkSize = CHUNK_SIZE, unsigned int numberOfThreads = 0, WorkScheduler *scheduler = nullptr);
+    void encryptChunks(const std::string &plaintext, unsigned long long firstChunk, bool lastBatch, std::string &ciphertext);
+    bool decryptChunks(const std::string &ciphertext, size_t start, size_t length, unsigned long long firstChunk, bool lastBatch, std::string &plaintext);
+    size_t getChunkSize() const;
+    unsigned int getNumberOfThreads() const;
+    static bool isSupportedCipher(unsigned int cipher);
+    static unsigned long long getNumberOfChunks(unsigned long long plaintextSize, size_t chunkSize);
+
+private:
+    struct ChunkPosition{
+        size_t inputStart;
+        size_t inputLength;
+        size_t outputStart;
+        unsigned long long index;
+        bool last;
+    };
+
+    unsigned int cipher;
+    CryptoPP::SecByteBlock sessionKey;
+    std::string associatedData;
+    size_t chunkSize;
+    unsigned int numberOfThreads;
+    WorkScheduler *scheduler;
+
+    void runWorkers(const char *input, const std::vector<ChunkPosition> &chunks, bool encrypting, char *output, std::atomic<bool> *failed);
+    void chunkWorker(const char *input, const std::vector<ChunkPosition> *chunks, bool encrypting, char *output,
+                     std::atomic<size_t> *nextChunk, std::atomic<bool> *failed);
+    std::unique_ptr<CryptoPP::AuthenticatedSymmetricCipher> createCipher(bool encrypting);
+    void chunkNonce(unsigned long long index, bool last, CryptoPP::byte *nonce);
+};
+
+#endif // HYBRIDENGINE_H
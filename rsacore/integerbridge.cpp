@@ -0,0 +1,48 @@
+#include "integerbridge.h"
+#include <gmpxx.h>
+
+#include <cryptopp/integer.h>
+#include <cryptopp/secblock.h>
+
+CryptoPP::Integer IntegerBridge::mpzToInteger(const mpz_t input){
+/***********************************************************************
+* Copies the value of a multiprecision variable into a CryptoPP Integer.
+* The magnitude is exported as big endian bytes and decoded straight into the Integer,
+* which avoids converting the number to (and parsing it from) a decimal string.
+*
+* Arguments:
+* @ input: The multiprecision variable to copy.
+*
+* Returns:
+* @ output: The CryptoPP Integer with the same value.
+***********************************************************************/
+    size_t numberOfBytes = (mpz_sizeinbase(input, 2) + 7) / 8;
+    // SecByteBlock wipes the bytes when it is freed, as they are often part of a private key.
+    CryptoPP::SecByteBlock bytes(numberOfBytes);
+    size_t bytesWritten = 0;
+    mpz_export(bytes.data(), &bytesWritten, 1, 1, 0, 0, input);
+    CryptoPP::Integer output(bytes.data(), bytesWritten, CryptoPP::Integer::UNSIGNED, CryptoPP::BIG_ENDIAN_ORDER);
+    if(mpz_sgn(input) < 0){
+        output.Negate();
+    }
+    return output;
+}
+
+void IntegerBridge::integerToMpz(mpz_t output, const CryptoPP::Integer &input){
+/***********************************************************************
+* Copies the value of a CryptoPP Integer into a multiprecision variable.
+* The magnitude is encoded as big endian bytes and imported straight into the variable,
+* which avoids converting the number to (and parsing it from) a decimal string.
+*
+* Arguments:
+* @ output: The initialised multiprecision variable which the value is written to.
+* @ input: The CryptoPP Integer to copy, such as one read from a .pem file.
+***********************************************************************/
+    size_t numberOfBytes = input.MinEncodedSize(CryptoPP::Integer::UNSIGNED);
+    CryptoPP::SecByteBlock bytes(numberOfBytes);
+    input.Encode(bytes.data(), numberOfBytes, CryptoPP::Integer::UNSIGNED);
+    mpz_import(output, numberOfBytes, 1, 1, 0, 0, bytes.data());
+    if(input.IsNegative() == true){
+        mpz_neg(output, output);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef INTEGERBRIDGE_H
+#define INTEGERBRIDGE_H
+
+#include <gmpxx.h>
+#include <cryptopp/integer.h>
+
+class IntegerBridge
+{
+public:
+    static CryptoPP::Integer mpzToInteger(const mpz_t input);
+    static void integerToMpz(mpz_t output, const CryptoPP::Integer &input);
+};
+
+#endif // INTEGERBRIDGE_H
@@ -0,0 +1,135 @@
+#include "jobprogress.h"
+
+#include <chrono>
+#include <functional>
+
+JobProgress::JobProgress(std::function<void(const JobProgress&)> listener, unsigned int reportInterval){
+/***********************************************************************
+* Constructor for the JobProgress class, which counts how far a long running job
+* (encrypting or decrypting a file, or generating keys) has got, and lets another
+* thread cancel it. The engines take a pointer to one and, when they are given one:
+* - Add the number of blocks (or hybrid chunks, or primes) they will work through to the total.
+* - Advance it as each range of blocks (or chunk, or prime) is finished, on whichever worker finished it.
+* - Count every candidate which is put through the primality checks.
+* - Stop taking new work once it has been cancelled, and return false.
+* Every counter is atomic, so the workers never wait on each other to update it.
+*
+* Arguments:
+* @ listener: Called with this JobProgress when it changes, from whichever worker changed it,
+*             or nullptr to only read the counters. It must be safe to call from any thread.
+* @ reportInterval: The least number of milliseconds between calls to the listener, so it
+*                   is not called for every block. The last block is always reported.
+***********************************************************************/
+    this->listener = listener;
+    this->startTime = std::chrono::steady_clock::now();
+    this->reportInterval = reportInterval;
+    this->lastReport = -static_cast<long long>(reportInterval);
+    this->done = 0;
+    this->total = 0;
+    this->candidates = 0;
+    this->cancelled = false;
+}
+
+void JobProgress::addToTotal(unsigned long long units){
+/***********************************************************************
+* Adds to the amount of work the job has to do. A job which works through several
+* containers or keys adds each one's share once it knows it.
+*
+* Arguments:
+* @ units: The number of blocks, hybrid chunks or primes to add.
+***********************************************************************/
+    total += units;
+    JobProgress::report(false);
+}
+
+void JobProgress::advance(unsigned long long units){
+/***********************************************************************
+* Arguments:
+* @ units: The number of blocks, hybrid chunks or primes which have just been finished.
+***********************************************************************/
+    unsigned long long nowDone = (done += units);
+    JobProgress::report(nowDone >= total);
+}
+
+void JobProgress::countCandidate(){
+/***********************************************************************
+* Counts a candidate which has passed the sieve and is being put through the primality checks.
+* There is no total for these, as the number needed before a prime is found is random.
+***********************************************************************/
+    candidates++;
+    JobProgress::report(false);
+}
+
+void JobProgress::cancel(){
+/***********************************************************************
+* Asks the job to stop, from any thread. The workers finish the range of blocks (or the
+* candidate) they are on and then stop, so the job returns shortly afterwards.
+***********************************************************************/
+    cancelled = true;
+}
+
+bool JobProgress::isCancelled() const{
+/***********************************************************************
+* Returns:
+*  True: If cancel() has been called.
+*  False: If it has not.
+***********************************************************************/
+    return cancelled;
+}
+
+unsigned long long JobProgress::getDone() const{
+/***********************************************************************
+* Returns:
+* @ done: The number of blocks, hybrid chunks or primes which have been finished.
+***********************************************************************/
+    return done;
+}
+
+unsigned long long JobProgress::getTotal() const{
+/***********************************************************************
+* Returns:
+* @ total: The number of blocks, hybrid chunks or primes the job has to do, as far as is known so far.
+***********************************************************************/
+    return total;
+}
+
+unsigned long long JobProgress::getCandidates() const{
+/***********************************************************************
+* Returns:
+* @ candidates: The number of prime candidates which have been put through the primality checks.
+***********************************************************************/
+    return candidates;
+}
+
+double JobProgress::getSeconds() const{
+/***********************************************************************
+* Returns:
+* @ seconds: The time since the JobProgress was made.
+***********************************************************************/
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+void JobProgress::report(bool finished){
+/***********************************************************************
+* Calls the listener if reportInterval has passed since it was last called. Only the worker
+* which wins the compare and swap of lastReport calls it, so it is never called twice for
+* the same interval.
+*
+* Arguments:
+* @ finished: Whether the last unit has just been done, which is reported straight away.
+***********************************************************************/
+    if(!listener){
+        return;
+    }
+    long long now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    long long previousReport = lastReport;
+    if(finished == false && now - previousReport < reportInterval){
+        return;
+    }
+    if(finished == false && lastReport.compare_exchange_strong(previousReport, now) == false){
+        return;
+    }
+    lastReport = now;
+    listener(*this);
+}
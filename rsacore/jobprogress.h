@@ -0,0 +1,35 @@
+#ifndef JOBPROGRESS_H
+#define JOBPROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+class JobProgress
+{
+public:
+    explicit JobProgress(std::function<void(const JobProgress&)> listener = nullptr, unsigned int reportInterval = 50);
+    void addToTotal(unsigned long long units);
+    void advance(unsigned long long units);
+    void countCandidate();
+    void cancel();
+    bool isCancelled() const;
+    unsigned long long getDone() const;
+    unsigned long long getTotal() const;
+    unsigned long long getCandidates() const;
+    double getSeconds() const;
+
+private:
+    std::function<void(const JobProgress&)> listener;
+    std::chrono::steady_clock::time_point startTime;
+    long long reportInterval;
+    std::atomic<long long> lastReport;
+    std::atomic<unsigned long long> done;
+    std::atomic<unsigned long long> total;
+    std::atomic<unsigned long long> candidates;
+    std::atomic<bool> cancelled;
+
+    void report(bool finished);
+};
+
+#endif // JOBPROGRESS_H
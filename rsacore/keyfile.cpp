@@ -0,0 +1,364 @@
+#include "keyfile.h"
+#include "integerbridge.h"
+#include "ciphertextcontainer.h"
+#include <gmpxx.h>
+
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/integer.h>
+#include <cryptopp/files.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/rsa.h>
+#include <cryptopp/pem.h>
+#include <fstream>
+#include <string>
+
+publicKey KeyFile::initializePublicKey(){
+/***********************************************************************
+* A function which creates a publicKey structure, and initializes each
+* multiprecision variable.
+*
+* Returns:
+* @ publicKeyStruct: A publicKey structure, named publicKeyStruct, that has been initialised.
+***********************************************************************/
+    publicKey publicKeyStruct;
+    mpz_init(publicKeyStruct.modulus);
+    mpz_init(publicKeyStruct.publicExponent);
+    return publicKeyStruct;
+}
+
+privateKey KeyFile::initializePrivateKey(){
+/***********************************************************************
+* A function which creates a privateKey structure, and initializes each
+* multiprecision variable.
+*
+* Returns:
+* @ privateKeyStruct: A privateKey structure, named privateKeyStruct, that has been initialised.
+***********************************************************************/
+    privateKey privateKeyStruct;
+    mpz_init(privateKeyStruct.modulus);
+    mpz_init(privateKeyStruct.publicExponent);
+    mpz_init(privateKeyStruct.privateExponent);
+    mpz_init(privateKeyStruct.prime1);
+    mpz_init(privateKeyStruct.prime2);
+    mpz_init(privateKeyStruct.exponent1);
+    mpz_init(privateKeyStruct.exponent2);
+    mpz_init(privateKeyStruct.coefficient);
+    return privateKeyStruct;
+}
+
+void KeyFile::clearPublicKey(publicKey* publicKeyStruct){
+/***********************************************************************
+* Frees the multiprecision variables of a public key once it is no longer needed.
+*
+* Arguments:
+* @ publicKeyStruct: The public key which is no longer needed.
+***********************************************************************/
+    mpz_clear(publicKeyStruct->modulus);
+    mpz_clear(publicKeyStruct->publicExponent);
+}
+
+void KeyFile::clearPrivateKey(privateKey* privateKeyStruct){
+/***********************************************************************
+* Frees the multiprecision variables of a private key once it is no longer needed.
+*
+* Arguments:
+* @ privateKeyStruct: The private key which is no longer needed.
+***********************************************************************/
+    mpz_clear(privateKeyStruct->modulus);
+    mpz_clear(privateKeyStruct->publicExponent);
+    mpz_clear(privateKeyStruct->privateExponent);
+    mpz_clear(privateKeyStruct->prime1);
+    mpz_clear(privateKeyStruct->prime2);
+    mpz_clear(privateKeyStruct->exponent1);
+    mpz_clear(privateKeyStruct->exponent2);
+    mpz_clear(privateKeyStruct->coefficient);
+}
+
+void KeyFile::getPublicKey(publicKey* publicKeyStruct, const privateKey* privateKeyStruct){
+/***********************************************************************
+* Sets the publicKey publicExponent and modulus to the values of a private key.
+*
+* Arguments:
+* @ publicKeyStruct: The initialised public key which the values are copied into.
+* @ privateKeyStruct: The private key the public key belongs to.
+***********************************************************************/
+    mpz_set(publicKeyStruct->publicExponent, privateKeyStruct->publicExponent);
+    mpz_set(publicKeyStruct->modulus, privateKeyStruct->modulus);
+}
+
+bool KeyFile::loadPublicKey(const std::string &filename, publicKey* publicKeyStruct){
+/***********************************************************************
+* Loads a public key from a .pem file and assigns the publicExponent and modulus
+* values to the publicKey structure.
+*
+* Arguments:
+* @ filename: The full path of the .pem file to read.
+* @ publicKeyStruct: The initialised publicKey structure which the values are assigned to.
+*
+* Returns:
+*  True: If the key has been loaded.
+*  False: If the file could not be read or is not a PEM encoded RSA public key.
+***********************************************************************/
+    try {
+        CryptoPP::FileSource publicKeySource(filename.c_str(), true);
+        CryptoPP::RSA::PublicKey cryptoPublicKey;
+        CryptoPP::PEM_Load(publicKeySource, cryptoPublicKey);
+
+        IntegerBridge::integerToMpz(publicKeyStruct->publicExponent, cryptoPublicKey.GetPublicExponent());
+        IntegerBridge::integerToMpz(publicKeyStruct->modulus, cryptoPublicKey.GetModulus());
+        return true;
+    }
+    catch (const std::exception &e){
+        return false;
+    }
+}
+
+bool KeyFile::loadPrivateKey(const std::string &filename, privateKey* privateKeyStruct){
+/***********************************************************************
+* Loads a private key from a .pem file and assigns the privateExponent, modulus and the
+* Chinese Remainder Theorem (CRT) values (prime1, prime2, exponent1, exponent2 and coefficient)
+* to the privateKey structure.
+* The CRT values are loaded once here so that every block can be decrypted with two
+* half-size exponentiations instead of one full-size exponentiation.
+*
+* Arguments:
+* @ filename: The full path of the .pem file to read.
+* @ privateKeyStruct: The initialised privateKey structure which the values are assigned to.
+*
+* Returns:
+*  True: If the key has been loaded.
+*  False: If the file could not be read or is not a PEM encoded RSA private key.
+***********************************************************************/
+    try {
+        CryptoPP::FileSource privateKeySource(filename.c_str(), true);
+        CryptoPP::RSA::PrivateKey cryptoPrivateKey;
+        CryptoPP::PEM_Load(privateKeySource, cryptoPrivateKey);
+
+        IntegerBridge::integerToMpz(privateKeyStruct->modulus, cryptoPrivateKey.GetModulus());
+        IntegerBridge::integerToMpz(privateKeyStruct->publicExponent, cryptoPrivateKey.GetPublicExponent());
+        IntegerBridge::integerToMpz(privateKeyStruct->privateExponent, cryptoPrivateKey.GetPrivateExponent());
+        IntegerBridge::integerToMpz(privateKeyStruct->prime1, cryptoPrivateKey.GetPrime1());
+        IntegerBridge::integerToMpz(privateKeyStruct->prime2, cryptoPrivateKey.GetPrime2());
+        IntegerBridge::integerToMpz(privateKeyStruct->exponent1, cryptoPrivateKey.GetModPrime1PrivateExponent());
+        IntegerBridge::integerToMpz(privateKeyStruct->exponent2, cryptoPrivateKey.GetModPrime2PrivateExponent());
+        IntegerBridge::integerToMpz(privateKeyStruct->coefficient, cryptoPrivateKey.GetMultiplicativeInverseOfPrime2ModPrime1());
+    }
+    catch (const std::exception &e){
+        return false;
+    }
+    KeyFile::prepareCRTParameters(privateKeyStruct);
+    return true;
+}
+
+bool KeyFile::savePublicKey(const std::string &filename, const publicKey* publicKeyStruct){
+/***********************************************************************
+* Loads the following variables from publicKeyStruct into the cryptoPP PublicKey Class,
+* and saves it to a .pem file with PEM_Save():
+* Letters in the brackets are what each value is usually displayed as in RSA equations.
+* - Modulus (n)
+* - Public Exponent (e)
+*
+* Arguments:
+* @ filename: The full path of the .pem file to write.
+* @ publicKeyStruct: The structure which contains the values needed for a RSA public Key
+*
+* Returns:
+*  True: If the key has been saved.
+*  False: If there was an error writing the file.
+***********************************************************************/
+    try {
+        CryptoPP::RSA::PublicKey cryptoPublicKey;
+        cryptoPublicKey.SetModulus(IntegerBridge::mpzToInteger(publicKeyStruct->modulus));
+        cryptoPublicKey.SetPublicExponent(IntegerBridge::mpzToInteger(publicKeyStruct->publicExponent));
+
+        CryptoPP::FileSink file(filename.c_str(), true);
+        CryptoPP::PEM_Save(file, cryptoPublicKey);
+        return true;
+    }
+    catch (const std::exception &e){
+        return false;
+    }
+}
+
+bool KeyFile::savePrivateKey(const std::string &filename, const privateKey* privateKeyStruct){
+/***********************************************************************
+* Loads the following variables from privateKeyStruct into the cryptoPP PrivateKey Class,
+* and saves it to a .pem file with PEM_Save():
+* Letters in the brackets are what each value is usually displayed as in RSA equations.
+* Example - https://simple.wikipedia.org/wiki/RSA_algorithm
+* - Modulus (n)
+* - Public Exponent (e)
+* - Private Exponent (d)
+* - Prime 1 (p)
+* - Prime 2 (q)
+* - Exponent 1 (dP)
+* - Exponent 2 (dQ)
+* - Coefficient (qInv)
+*
+* Arguments:
+* @ filename: The full path of the .pem file to write.
+* @ privateKeyStruct: The structure which contains the values needed for a RSA private Key
+*
+* Returns:
+*  True: If the key has been saved.
+*  False: If there was an error writing the file.
+***********************************************************************/
+    try {
+        CryptoPP::RSA::PrivateKey cryptoPrivateKey;
+        cryptoPrivateKey.SetModulus(IntegerBridge::mpzToInteger(privateKeyStruct->modulus));
+        cryptoPrivateKey.SetPublicExponent(IntegerBridge::mpzToInteger(privateKeyStruct->publicExponent));
+        cryptoPrivateKey.SetPrivateExponent(IntegerBridge::mpzToInteger(privateKeyStruct->privateExponent));
+        cryptoPrivateKey.SetPrime1(IntegerBridge::mpzToInteger(privateKeyStruct->prime1));
+        cryptoPrivateKey.SetPrime2(IntegerBridge::mpzToInteger(privateKeyStruct->prime2));
+        cryptoPrivateKey.SetModPrime1PrivateExponent(IntegerBridge::mpzToInteger(privateKeyStruct->exponent1));
+        cryptoPrivateKey.SetModPrime2PrivateExponent(IntegerBridge::mpzToInteger(privateKeyStruct->exponent2));
+        cryptoPrivateKey.SetMultiplicativeInverseOfPrime2ModPrime1(IntegerBridge::mpzToInteger(privateKeyStruct->coefficient));
+
+        CryptoPP::FileSink file(filename.c_str(), true);
+        CryptoPP::PEM_Save(file, cryptoPrivateKey);
+        return true;
+    }
+    catch (const std::exception &e){
+        return false;
+    }
+}
+
+bool KeyFile::prepareCRTParameters(privateKey* privateKeyStruct){
+/***********************************************************************
+* Makes sure the Chinese Remainder Theorem values are available for the DecryptionEngine.
+* Keys generated by the KeyGenerator already contain exponent1, exponent2 and coefficient,
+* so they are used directly. Older keys which were saved without them (these are written
+* as zero) have them derived once here from the primes and the private exponent:
+* - exponent1 (dP) = privateExponent mod (prime1 - 1)
+* - exponent2 (dQ) = privateExponent mod (prime2 - 1)
+* - coefficient (qInv) = prime2^-1 mod prime1
+* If the primes are not present in the key the coefficient is set to zero, which
+* makes the DecryptionEngine fall back to a full exponentiation modulo the modulus.
+*
+* Arguments:
+* @ privateKeyStruct: The privateKey structure, which has been loaded from the .pem file.
+*
+* Returns:
+*  True: If the CRT values are available for decryption.
+*  False: If the key can only be used with a full exponentiation.
+***********************************************************************/
+    if(mpz_sgn(privateKeyStruct->prime1) == 0 || mpz_sgn(privateKeyStruct->prime2) == 0){
+        mpz_set_ui(privateKeyStruct->coefficient, 0);
+        return false;
+    }
+    if(mpz_sgn(privateKeyStruct->exponent1) != 0 && mpz_sgn(privateKeyStruct->exponent2) != 0
+            && mpz_sgn(privateKeyStruct->coefficient) != 0){
+        return true;
+    }
+
+    mpz_t primeMinusOne; mpz_init(primeMinusOne);
+    mpz_sub_ui(primeMinusOne, privateKeyStruct->prime1, 1);
+    mpz_mod(privateKeyStruct->exponent1, privateKeyStruct->privateExponent, primeMinusOne);
+    mpz_sub_ui(primeMinusOne, privateKeyStruct->prime2, 1);
+    mpz_mod(privateKeyStruct->exponent2, privateKeyStruct->privateExponent, primeMinusOne);
+    mpz_clear(primeMinusOne);
+
+    if(mpz_invert(privateKeyStruct->coefficient, privateKeyStruct->prime2, privateKeyStruct->prime1) == 0){
+        mpz_set_ui(privateKeyStruct->coefficient, 0);
+        return false;
+    }
+    return true;
+}
+
+std::string KeyFile::fingerprint(const publicKey* publicKeyStruct){
+/***********************************************************************
+* Works out the fingerprint of a public key, which is used to name the files in batch mode.
+* The fingerprint is the SHA-256 hash of the DER encoded public key, the first 16
+* hexadecimal characters are used. This is the same fingerprint which is stored in the
+* header of every file encrypted with the key.
+*
+* Arguments:
+* @ publicKeyStruct: The structure which contains the values needed for a RSA public Key
+*
+* Returns:
+* @ fingerprint: The first 16 hexadecimal characters of the key's SHA-256 hash.
+***********************************************************************/
+    std::string fingerprintBytes = CiphertextContainer::keyFingerprint(publicKeyStruct->modulus, publicKeyStruct->publicExponent);
+    std::string fingerprint;
+    CryptoPP::StringSource(fingerprintBytes, true, new CryptoPP::HexEncoder(new CryptoPP::StringSink(fingerprint), false));
+    return fingerprint;
+}
+
+std::string KeyFile::batchKeyName(const publicKey* publicKeyStruct, int keyNumber, int numberOfKeys, bool fingerprintNames){
+/***********************************************************************
+* Works out the name a key from a batch is saved under, which goes between "PublicKey_" or
+* "PrivateKey_" and ".pem". The name is either the fingerprint of the public key, or the
+* number of the key padded with zeros to the width of numberOfKeys (001, 002, ...).
+*
+* Arguments:
+* @ publicKeyStruct: The public key of the keypair being saved.
+* @ keyNumber: The number of the key in the batch, starting from 1.
+* @ numberOfKeys: The number of keys in the batch.
+* @ fingerprintNames: Whether the key is named by fingerprint instead of by number.
+*
+* Returns:
+* @ keyName: The name of the keypair.
+***********************************************************************/
+    if(fingerprintNames == true){
+        return KeyFile::fingerprint(publicKeyStruct);
+    }
+    std::string keyName = std::to_string(keyNumber);
+    size_t numberWidth = std::to_string(numberOfKeys).length();
+    if(keyName.length() < numberWidth){
+        keyName.insert(0, numberWidth - keyName.length(), '0');
+    }
+    return keyName;
+}
+
+std::string KeyFile::findExistingKeyFile(const std::string &folder, const std::string &keyName){
+/***********************************************************************
+* Checks whether saving a keypair as PublicKey<keyName>.pem and PrivateKey<keyName>.pem
+* in folder would write over a key which is already there.
+*
+* Arguments:
+* @ folder: The folder the keypair would be saved to.
+* @ keyName: The text added to the end of the file names, "" for a single keypair.
+*
+* Returns:
+* @ filepath: The path of the first of the two files which already exists, or "" if neither does.
+***********************************************************************/
+    std::string filepaths[2] = {folder + "/PublicKey" + keyName + ".pem", folder + "/PrivateKey" + keyName + ".pem"};
+    for(int i = 0; i < 2; i++){
+        std::ifstream keyFile(filepaths[i]);
+        if(keyFile.is_open() == true){
+            return filepaths[i];
+        }
+    }
+    return "";
+}
+
+std::string KeyFile::findExistingBatchKeyFile(const std::string &folder, int numberOfKeys, bool fingerprintNames){
+/***********************************************************************
+* Checks, before any keys are generated, whether saving numberOfKeys keypairs in folder
+* would write over keys which are already there, such as the keys from an earlier batch.
+* Fingerprint names are only known once the keys have been generated, so they can only be
+* checked with findExistingKeyFile() as each key is saved.
+*
+* Arguments:
+* @ folder: The folder the keys would be saved to.
+* @ numberOfKeys: The number of keypairs, a single keypair is saved without a name.
+* @ fingerprintNames: Whether the keys are named by fingerprint instead of by number.
+*
+* Returns:
+* @ filepath: The path of the first key file which already exists, or "" if none do.
+***********************************************************************/
+    if(numberOfKeys == 1){
+        return KeyFile::findExistingKeyFile(folder, "");
+    }
+    if(fingerprintNames == true){
+        return "";
+    }
+    for(int i = 0; i < numberOfKeys; i++){
+        std::string filepath = KeyFile::findExistingKeyFile(folder, "_" + KeyFile::batchKeyName(nullptr, i + 1, numberOfKeys, false));
+        if(filepath.empty() == false){
+            return filepath;
+        }
+    }
+    return "";
+}
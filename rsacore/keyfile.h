@@ -0,0 +1,42 @@
+#ifndef KEYFILE_H
+#define KEYFILE_H
+
+#include <gmpxx.h>
+#include <string>
+
+struct publicKey{
+    mpz_t modulus;
+    mpz_t publicExponent;
+};
+
+struct privateKey{
+    mpz_t modulus;
+    mpz_t publicExponent;
+    mpz_t privateExponent;
+    mpz_t prime1;
+    mpz_t prime2;
+    mpz_t exponent1;
+    mpz_t exponent2;
+    mpz_t coefficient;
+};
+
+class KeyFile
+{
+public:
+    static publicKey initializePublicKey();
+    static privateKey initializePrivateKey();
+    static void clearPublicKey(publicKey* publicKeyStruct);
+    static void clearPrivateKey(privateKey* privateKeyStruct);
+    static void getPublicKey(publicKey* publicKeyStruct, const privateKey* privateKeyStruct);
+    static bool loadPublicKey(const std::string &filename, publicKey* publicKeyStruct);
+    static bool loadPrivateKey(const std::string &filename, privateKey* privateKeyStruct);
+    static bool savePublicKey(const std::string &filename, const publicKey* publicKeyStruct);
+    static bool savePrivateKey(const std::string &filename, const privateKey* privateKeyStruct);
+    static bool prepareCRTParameters(privateKey* privateKeyStruct);
+    static std::string fingerprint(const publicKey* publicKeyStruct);
+    static std::string batchKeyName(const publicKey* publicKeyStruct, int keyNumber, int numberOfKeys, bool fingerprintNames);
+    static std::string findExistingKeyFile(const std::string &folder, const std::string &keyName);
+    static std::string findExistingBatchKeyFile(const std::string &folder, int numberOfKeys, bool fingerprintNames);
+};
+
+#endif // KEYFILE_H
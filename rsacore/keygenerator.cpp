@@ -0,0 +1,215 @@
+#include "keygenerator.h"
+#include "primesearch.h"
+#include "primalitytester.h"
+#include <gmpxx.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+KeyGenerator::KeyGenerator(const keyGenerationConfig &config){
+/***********************************************************************
+* Constructor for the KeyGenerator, which generates RSA keypairs of the size in config.
+* The number of Miller-Rabin rounds is picked once here from the schedule for the size
+* of the primes, unless config asks for paranoid checks.
+* Nothing is shared between KeyGenerators apart from the PrimePool, which is locked,
+* so several can be used at the same time.
+*
+* Arguments:
+* @ config: The key size, public exponent, primality checks and PrimePool to use.
+***********************************************************************/
+    this->config = config;
+    this->sizeOfPrimes = config.sizeOfKey / 2;
+    this->numberOfChecks = PrimalityTester::getNumberOfChecks(sizeOfPrimes, config.useLucasTest, config.paranoidChecks);
+}
+
+bool KeyGenerator::generatePrivateKey(privateKey* privateKeyStruct, unsigned int numberOfThreads) const{
+/***********************************************************************
+* Generates a single keypair, searching for its primes on numberOfThreads threads.
+* The config's JobProgress, if there is one, has the two primes added to its total.
+*
+* Arguments:
+* @ privateKeyStruct: the structure which contains all of the values needed to generate an RSA key
+* @ numberOfThreads: the number of threads used to search for the primes, 0 (the default) uses every core.
+*
+* Returns:
+*  True: If the key has been generated.
+*  False: If the JobProgress was cancelled first, the key should not be used.
+***********************************************************************/
+    if(config.progress != nullptr){
+        config.progress->addToTotal(2);
+    }
+    return KeyGenerator::generateKey(privateKeyStruct, numberOfThreads);
+}
+
+bool KeyGenerator::generateKey(privateKey* privateKeyStruct, unsigned int numberOfThreads) const{
+/***********************************************************************
+* This generates all the values needed for the variables in the privateKeyStruct
+* The primes are taken from the PrimePool when it has a pair of the right size ready,
+* otherwise they are searched for straight away. If the public exponent has no inverse
+* mod phi for the primes, they are thrown away and a new pair is found.
+* This includes the Chinese Remainder Theorem values (exponent1, exponent2 and coefficient),
+* so that they are written into the PEM file and do not need re-deriving when the key is loaded.
+* The struct's values are updated / set rather than returned.
+*
+* Arguments:
+* @ privateKeyStruct: the structure which contains all of the values needed to generate an RSA key
+* @ numberOfThreads: the number of threads used to search for the primes, 0 uses every core.
+*
+* Returns:
+*  True: If the key has been generated.
+*  False: If the JobProgress was cancelled during the search for the primes, or the public exponent is even.
+***********************************************************************/
+    // An even exponent shares a factor of 2 with every (prime - 1), so no key could ever be made with it.
+    if(config.publicExponent < 3 || config.publicExponent % 2 == 0){
+        return false;
+    }
+    mpz_set_ui(privateKeyStruct->publicExponent, config.publicExponent);
+    // The pool's primes are checked with the default schedule, so they are skipped when paranoid checks are asked for.
+    bool usePool = (config.primePool != nullptr && config.paranoidChecks == false && config.useLucasTest == true);
+
+    mpz_t phi; mpz_init(phi);
+    mpz_t temp1; mpz_init(temp1);
+    mpz_t temp2; mpz_init(temp2);
+    bool firstPair = true;
+    while(true){
+        if(firstPair == false && config.progress != nullptr){
+            config.progress->addToTotal(2);
+        }
+        firstPair = false;
+        bool primesFromPool = false;
+        if(usePool == true){
+            primesFromPool = config.primePool->takePrimePair(sizeOfPrimes, config.publicExponent, privateKeyStruct->prime1, privateKeyStruct->prime2);
+        }
+        if(primesFromPool == true && config.progress != nullptr){
+            config.progress->advance(2);
+        }
+        if(primesFromPool == false){
+            // Both primes are searched for at the same time.
+            PrimeSearch primeSearch(sizeOfPrimes, numberOfChecks, numberOfThreads, config.useLucasTest, config.progress, config.publicExponent);
+            if(primeSearch.findPrimePair(privateKeyStruct->prime1, privateKeyStruct->prime2) == false){
+                mpz_clear(phi);
+                mpz_clear(temp1);
+                mpz_clear(temp2);
+                return false;
+            }
+        }
+        mpz_mul(privateKeyStruct->modulus, privateKeyStruct->prime1, privateKeyStruct->prime2);
+
+        // Calculate phi(modulus) = (prime1 - 1) * (prime2 - 1)
+        mpz_sub_ui(temp1, privateKeyStruct->prime1, 1);
+        mpz_sub_ui(temp2, privateKeyStruct->prime2, 1);
+        mpz_mul(phi, temp1, temp2);
+
+        // The inverse only fails to exist when e shares a factor with phi, the primes are then
+        // thrown away and a new pair is found, as every value below would be wrong.
+        if(mpz_invert(privateKeyStruct->privateExponent, privateKeyStruct->publicExponent, phi) != 0){
+            break;
+        }
+    }
+
+    // Calculate the Chinese Remainder Theorem values, so they can be saved and reused by the decryption.
+    // exponent1 = privateExponent mod (prime1 - 1), exponent2 = privateExponent mod (prime2 - 1)
+    mpz_sub_ui(temp1, privateKeyStruct->prime1, 1);
+    mpz_sub_ui(temp2, privateKeyStruct->prime2, 1);
+    mpz_mod(privateKeyStruct->exponent1, privateKeyStruct->privateExponent, temp1);
+    mpz_mod(privateKeyStruct->exponent2, privateKeyStruct->privateExponent, temp2);
+    // coefficient = prime2^-1 mod prime1
+    mpz_invert(privateKeyStruct->coefficient, privateKeyStruct->prime2, privateKeyStruct->prime1);
+
+    mpz_clear(phi);
+    mpz_clear(temp1);
+    mpz_clear(temp2);
+    return true;
+}
+
+unsigned int KeyGenerator::generateKeyBatch(std::vector<privateKey> &privateKeyStructs, unsigned int numberOfThreads) const{
+/***********************************************************************
+* Generates a keypair into every (initialised) privateKey in privateKeyStructs, on a pool
+* of worker threads. Each worker takes the next key which hasn't been started yet and
+* searches for its primes on a single thread, so the cores are kept busy with different
+* keys instead of sharing the search for one key.
+* The config's JobProgress, if there is one, has every key's primes added to its total up front,
+* and once it has been cancelled the workers stop, leaving the keys they had not finished unusable.
+*
+* Arguments:
+* @ privateKeyStructs: The initialised private keys to generate.
+* @ numberOfThreads: The number of worker threads, 0 (the default) uses one per core.
+*
+* Returns:
+* @ numberOfThreads: The number of worker threads which were used.
+***********************************************************************/
+    int numberOfKeys = static_cast<int>(privateKeyStructs.size());
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    if(numberOfThreads == 0){
+        numberOfThreads = 1;
+    }
+    if(numberOfThreads > static_cast<unsigned int>(numberOfKeys)){
+        numberOfThreads = numberOfKeys;
+    }
+
+    if(config.progress != nullptr){
+        config.progress->addToTotal(2ULL * numberOfKeys);
+    }
+
+    std::atomic<int> nextKey(0);
+    std::vector<std::thread> workers;
+    for(unsigned int i = 0; i < numberOfThreads; i++){
+        workers.emplace_back([this, &privateKeyStructs, &nextKey, numberOfKeys](){
+            for(int keyIndex = nextKey++; keyIndex < numberOfKeys; keyIndex = nextKey++){
+                if(KeyGenerator::generateKey(&privateKeyStructs[keyIndex], 1) == false){
+                    break;
+                }
+            }
+        });
+    }
+    for(unsigned int i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+    return numberOfThreads;
+}
+
+std::string KeyGenerator::describePrimeChecks() const{
+/***********************************************************************
+* Describes the primality checks which are used for the primes, so that
+* it can be shown to the user with the key generation output.
+*
+* Returns:
+* @ description: The number of Miller-Rabin rounds, whether a Lucas test was used and where the numbers came from.
+***********************************************************************/
+    std::string description = "Prime checks: base 2 + " + std::to_string(numberOfChecks)
+            + " random Miller-Rabin rounds";
+    if(config.useLucasTest == true){
+        description += " + strong Lucas test";
+    }
+    description += " per " + std::to_string(sizeOfPrimes) + " bit prime";
+    if(config.paranoidChecks == true){
+        description += " (paranoid schedule).";
+    }
+    else if(sizeOfPrimes >= 512){
+        description += " (FIPS 186-4 Table C.3 schedule).";
+    }
+    else{
+        description += " (worst case schedule for small primes).";
+    }
+    return description;
+}
+
+int KeyGenerator::getSizeOfPrimes() const{
+/***********************************************************************
+* Returns:
+* @ sizeOfPrimes: The size of each prime in bits, half of the key size.
+***********************************************************************/
+    return sizeOfPrimes;
+}
+
+int KeyGenerator::getNumberOfChecks() const{
+/***********************************************************************
+* Returns:
+* @ numberOfChecks: The number of random Miller-Rabin rounds each prime goes through.
+***********************************************************************/
+    return numberOfChecks;
+}
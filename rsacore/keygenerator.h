@@ -0,0 +1,38 @@
+#ifndef KEYGENERATOR_H
+#define KEYGENERATOR_H
+
+#include "keyfile.h"
+#include "primepool.h"
+#include "jobprogress.h"
+#include <gmpxx.h>
+#include <string>
+#include <vector>
+
+struct keyGenerationConfig{
+    int sizeOfKey = 4096; // Size of the keys in bits.
+    int publicExponent = 65537; // Needs to be a constant prime, 65537 used as default as stored nicely as hex (0x10001).
+    bool useLucasTest = true; // Whether each prime also has to pass a strong Lucas test (Baillie-PSW).
+    bool paranoidChecks = false; // Whether the maximum number of Miller-Rabin rounds is used.
+    PrimePool *primePool = nullptr; // The pool ready made primes are taken from, if there is one.
+    JobProgress *progress = nullptr; // Counts the primes (two per key) and the candidates tested and can cancel the generation, if there is one.
+};
+
+class KeyGenerator
+{
+public:
+    explicit KeyGenerator(const keyGenerationConfig &config);
+    bool generatePrivateKey(privateKey* privateKeyStruct, unsigned int numberOfThreads = 0) const;
+    unsigned int generateKeyBatch(std::vector<privateKey> &privateKeyStructs, unsigned int numberOfThreads = 0) const;
+    std::string describePrimeChecks() const;
+    int getSizeOfPrimes() const;
+    int getNumberOfChecks() const;
+
+private:
+    keyGenerationConfig config;
+    int sizeOfPrimes;
+    int numberOfChecks;
+
+    bool generateKey(privateKey* privateKeyStruct, unsigned int numberOfThreads) const;
+};
+
+#endif // KEYGENERATOR_H
@@ -0,0 +1,262 @@
+#include "montgomerycontext.h"
+#include <gmpxx.h>
+
+#include <vector>
+
+MontgomeryContext::MontgomeryContext(){
+/***********************************************************************
+* Constructor for an empty MontgomeryContext, setModulus() has to be called
+* before any of the arithmetic functions are used.
+***********************************************************************/
+    numberOfLimbs = 0;
+    inverse = 0;
+}
+
+MontgomeryContext::MontgomeryContext(const mpz_t modulus){
+/***********************************************************************
+* Constructor for the MontgomeryContext, which works out all of the constants
+* needed for Montgomery multiplication modulo the given (odd) modulus.
+*
+* Arguments:
+* @ modulus: The odd modulus which all of the arithmetic is done modulo.
+***********************************************************************/
+    MontgomeryContext::setModulus(modulus);
+}
+
+void MontgomeryContext::setModulus(const mpz_t modulus){
+/***********************************************************************
+* Works out the constants for a new modulus, so the same context (and its memory)
+* can be reused for many different numbers. With R = 2^(64 * numberOfLimbs):
+* - inverse = -modulus^-1 mod 2^64, used by reduce() to clear one limb at a time.
+* - rSquared = R^2 mod modulus, used to convert numbers into Montgomery form.
+* - one = R mod modulus, which is the number 1 in Montgomery form.
+*
+* Arguments:
+* @ modulus: The odd modulus which all of the arithmetic is done modulo.
+***********************************************************************/
+    modulusValue = mpz_class(modulus);
+    numberOfLimbs = static_cast<int>(mpz_size(modulus));
+    this->modulus.assign(numberOfLimbs, 0);
+    for(int i = 0; i < numberOfLimbs; i++){
+        this->modulus[i] = mpz_getlimbn(modulus, i);
+    }
+
+    // Newton's iteration doubles the number of correct bits each time, starting from 5 bits.
+    mp_limb_t lowestLimb = this->modulus[0];
+    mp_limb_t modulusInverse = (3 * lowestLimb) ^ 2;
+    for(int i = 0; i < 4; i++){
+        modulusInverse *= 2 - lowestLimb * modulusInverse;
+    }
+    inverse = -modulusInverse;
+
+    mpz_class value;
+    mpz_setbit(value.get_mpz_t(), 2 * GMP_NUMB_BITS * numberOfLimbs);
+    mpz_mod(value.get_mpz_t(), value.get_mpz_t(), modulus);
+    rSquared.assign(numberOfLimbs, 0);
+    for(int i = 0; i < static_cast<int>(mpz_size(value.get_mpz_t())); i++){
+        rSquared[i] = mpz_getlimbn(value.get_mpz_t(), i);
+    }
+
+    value = 0;
+    mpz_setbit(value.get_mpz_t(), GMP_NUMB_BITS * numberOfLimbs);
+    mpz_mod(value.get_mpz_t(), value.get_mpz_t(), modulus);
+    one.assign(numberOfLimbs, 0);
+    for(int i = 0; i < static_cast<int>(mpz_size(value.get_mpz_t())); i++){
+        one[i] = mpz_getlimbn(value.get_mpz_t(), i);
+    }
+}
+
+int MontgomeryContext::getNumberOfLimbs() const{
+/***********************************************************************
+* Returns:
+*  numberOfLimbs: The number of 64 bit limbs every number in Montgomery form takes up.
+***********************************************************************/
+    return numberOfLimbs;
+}
+
+int MontgomeryContext::getScratchSize() const{
+/***********************************************************************
+* Returns:
+*  The number of limbs the scratch buffer passed to multiply(), square(),
+*  toMontgomery() and fromMontgomery() must have.
+***********************************************************************/
+    return 3 * numberOfLimbs;
+}
+
+const mp_limb_t *MontgomeryContext::getModulus() const{
+/***********************************************************************
+* Returns:
+*  The limbs of the modulus, least significant limb first.
+***********************************************************************/
+    return modulus.data();
+}
+
+const mp_limb_t *MontgomeryContext::getOne() const{
+/***********************************************************************
+* Returns:
+*  The number 1 in Montgomery form (R mod modulus).
+***********************************************************************/
+    return one.data();
+}
+
+void MontgomeryContext::toMontgomery(mp_limb_t *result, const mpz_t value, mp_limb_t *scratch) const{
+/***********************************************************************
+* Converts a number into Montgomery form (value * R mod modulus), by multiplying
+* it by R^2 and reducing once.
+*
+* Arguments:
+* @ result: The numberOfLimbs limbs which the number in Montgomery form is written to.
+* @ value: The number which is converted, it is reduced modulo the modulus first if needed.
+* @ scratch: A buffer of getScratchSize() limbs.
+***********************************************************************/
+    mpz_class reducedValue;
+    mpz_srcptr valueToConvert = value;
+    if(mpz_sgn(value) < 0 || mpz_cmp(value, modulusValue.get_mpz_t()) >= 0){
+        mpz_mod(reducedValue.get_mpz_t(), value, modulusValue.get_mpz_t());
+        valueToConvert = reducedValue.get_mpz_t();
+    }
+    int valueLimbs = static_cast<int>(mpz_size(valueToConvert));
+    for(int i = 0; i < numberOfLimbs; i++){
+        result[i] = (i < valueLimbs) ? mpz_getlimbn(valueToConvert, i) : 0;
+    }
+    MontgomeryContext::multiply(result, result, rSquared.data(), scratch);
+}
+
+void MontgomeryContext::fromMontgomery(mpz_t result, const mp_limb_t *value, mp_limb_t *scratch) const{
+/***********************************************************************
+* Converts a number out of Montgomery form, by reducing it once (value * R^-1 mod modulus).
+*
+* Arguments:
+* @ result: The initialised multiprecision variable which the number is written to.
+* @ value: The number in Montgomery form.
+* @ scratch: A buffer of getScratchSize() limbs.
+***********************************************************************/
+    for(int i = 0; i < numberOfLimbs; i++){
+        scratch[i] = value[i];
+        scratch[numberOfLimbs + i] = 0;
+    }
+    mp_limb_t *resultLimbs = mpz_limbs_write(result, numberOfLimbs);
+    MontgomeryContext::reduce(resultLimbs, scratch);
+    mpz_limbs_finish(result, numberOfLimbs);
+}
+
+void MontgomeryContext::multiply(mp_limb_t *result, const mp_limb_t *firstValue, const mp_limb_t *secondValue, mp_limb_t *scratch) const{
+/***********************************************************************
+* Montgomery multiplication, result = firstValue * secondValue * R^-1 mod modulus.
+* The result is allowed to be the same buffer as either of the inputs.
+*
+* Arguments:
+* @ result: The numberOfLimbs limbs which the product is written to.
+* @ firstValue: The first number in Montgomery form.
+* @ secondValue: The second number in Montgomery form.
+* @ scratch: A buffer of getScratchSize() limbs.
+***********************************************************************/
+    mpn_mul_n(scratch, firstValue, secondValue, numberOfLimbs);
+    MontgomeryContext::reduce(result, scratch);
+}
+
+void MontgomeryContext::square(mp_limb_t *result, const mp_limb_t *value, mp_limb_t *scratch) const{
+/***********************************************************************
+* Montgomery squaring, result = value * value * R^-1 mod modulus.
+* The result is allowed to be the same buffer as the input.
+*
+* Arguments:
+* @ result: The numberOfLimbs limbs which the square is written to.
+* @ value: The number in Montgomery form.
+* @ scratch: A buffer of getScratchSize() limbs.
+***********************************************************************/
+    mpn_sqr(scratch, value, numberOfLimbs);
+    MontgomeryContext::reduce(result, scratch);
+}
+
+void MontgomeryContext::exponentiate(mp_limb_t *result, const mp_limb_t *base, const mpz_t exponent, std::vector<mp_limb_t> &scratch) const{
+/***********************************************************************
+* Raises a number in Montgomery form to the power of exponent, using a left to right
+* sliding window. The odd powers base^1, base^3, ... base^(2^windowSize - 1) are
+* worked out first, then each window of the exponent costs windowSize squarings
+* and a single multiplication.
+*
+* Arguments:
+* @ result: The numberOfLimbs limbs which base^exponent (in Montgomery form) is written to.
+* @ base: The number in Montgomery form.
+* @ exponent: The non-negative exponent.
+* @ scratch: A vector which is resized as needed, so it can be reused between calls.
+***********************************************************************/
+    long exponentBits = (mpz_sgn(exponent) == 0) ? 0 : static_cast<long>(mpz_sizeinbase(exponent, 2));
+    int windowSize = (exponentBits > 671) ? 6 : (exponentBits > 239) ? 5 : (exponentBits > 79) ? 4 : (exponentBits > 23) ? 3 : 1;
+    int tableSize = 1 << (windowSize - 1);
+    scratch.resize(static_cast<size_t>(tableSize + 1) * numberOfLimbs + getScratchSize());
+    mp_limb_t *table = scratch.data();
+    mp_limb_t *baseSquared = table + static_cast<size_t>(tableSize) * numberOfLimbs;
+    mp_limb_t *productScratch = baseSquared + numberOfLimbs;
+
+    // table[i] = base^(2i + 1)
+    for(int i = 0; i < numberOfLimbs; i++){
+        table[i] = base[i];
+    }
+    if(tableSize > 1){
+        MontgomeryContext::square(baseSquared, base, productScratch);
+        for(int i = 1; i < tableSize; i++){
+            MontgomeryContext::multiply(table + i * numberOfLimbs, table + (i - 1) * numberOfLimbs, baseSquared, productScratch);
+        }
+    }
+
+    for(int i = 0; i < numberOfLimbs; i++){
+        result[i] = one[i];
+    }
+    long bitIndex = exponentBits - 1;
+    while(bitIndex >= 0){
+        if(mpz_tstbit(exponent, bitIndex) == 0){
+            MontgomeryContext::square(result, result, productScratch);
+            bitIndex--;
+            continue;
+        }
+        // Find the longest window (up to windowSize bits) which starts here and ends in a 1 bit.
+        long windowEnd = (bitIndex - windowSize + 1 < 0) ? 0 : bitIndex - windowSize + 1;
+        while(mpz_tstbit(exponent, windowEnd) == 0){
+            windowEnd++;
+        }
+        int windowValue = 0;
+        for(long i = bitIndex; i >= windowEnd; i--){
+            windowValue = (windowValue << 1) | mpz_tstbit(exponent, i);
+            MontgomeryContext::square(result, result, productScratch);
+        }
+        MontgomeryContext::multiply(result, result, table + (windowValue >> 1) * numberOfLimbs, productScratch);
+        bitIndex = windowEnd - 1;
+    }
+}
+
+bool MontgomeryContext::isEqual(const mp_limb_t *firstValue, const mp_limb_t *secondValue) const{
+/***********************************************************************
+* Compares two numbers in Montgomery form. Both are fully reduced, so equal
+* numbers always have equal limbs.
+*
+* Returns:
+*  True: If the numbers are equal.
+*  False: If the numbers are different.
+***********************************************************************/
+    return mpn_cmp(firstValue, secondValue, numberOfLimbs) == 0;
+}
+
+void MontgomeryContext::reduce(mp_limb_t *result, mp_limb_t *product) const{
+/***********************************************************************
+* Montgomery reduction (REDC), result = product * R^-1 mod modulus.
+* Each step adds a multiple of the modulus which clears the lowest limb, the carry out of
+* each step is stored in the limb that has just been cleared. The carries are added
+* onto the top half at the end, followed by at most one subtraction of the modulus.
+*
+* Arguments:
+* @ result: The numberOfLimbs limbs which the reduced number is written to.
+* @ product: The 2 * numberOfLimbs limb product, which is overwritten.
+***********************************************************************/
+    mp_limb_t *currentLimb = product;
+    for(int i = 0; i < numberOfLimbs; i++){
+        mp_limb_t multiple = currentLimb[0] * inverse;
+        currentLimb[0] = mpn_addmul_1(currentLimb, modulus.data(), numberOfLimbs, multiple);
+        currentLimb++;
+    }
+    mp_limb_t carry = mpn_add_n(result, currentLimb, product, numberOfLimbs);
+    if(carry != 0 || mpn_cmp(result, modulus.data(), numberOfLimbs) >= 0){
+        mpn_sub_n(result, result, modulus.data(), numberOfLimbs);
+    }
+}
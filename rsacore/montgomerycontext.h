@@ -0,0 +1,34 @@
+#ifndef MONTGOMERYCONTEXT_H
+#define MONTGOMERYCONTEXT_H
+
+#include <gmpxx.h>
+#include <vector>
+
+class MontgomeryContext
+{
+public:
+    MontgomeryContext();
+    explicit MontgomeryContext(const mpz_t modulus);
+    void setModulus(const mpz_t modulus);
+    int getNumberOfLimbs() const;
+    int getScratchSize() const;
+    const mp_limb_t *getModulus() const;
+    const mp_limb_t *getOne() const;
+    void toMontgomery(mp_limb_t *result, const mpz_t value, mp_limb_t *scratch) const;
+    void fromMontgomery(mpz_t result, const mp_limb_t *value, mp_limb_t *scratch) const;
+    void multiply(mp_limb_t *result, const mp_limb_t *firstValue, const mp_limb_t *secondValue, mp_limb_t *scratch) const;
+    void square(mp_limb_t *result, const mp_limb_t *value, mp_limb_t *scratch) const;
+    void exponentiate(mp_limb_t *result, const mp_limb_t *base, const mpz_t exponent, std::vector<mp_limb_t> &scratch) const;
+    bool isEqual(const mp_limb_t *firstValue, const mp_limb_t *secondValue) const;
+
+private:
+    int numberOfLimbs;
+    mp_limb_t inverse;
+    mpz_class modulusValue;
+    std::vector<mp_limb_t> modulus;
+    std::vector<mp_limb_t> rSquared;
+    std::vector<mp_limb_t> one;
+    void reduce(mp_limb_t *result, mp_limb_t *product) const;
+};
+
+#endif // MONTGOMERYCONTEXT_H
@@ -0,0 +1,305 @@
+#include "multibuffermodexp.h"
+#include <gmpxx.h>
+#include <cryptopp/cpu.h>
+
+#include <cstdint>
+#include <vector>
+
+#ifdef MULTI_BUFFER_MOD_EXP_SUPPORTED
+#include <immintrin.h>
+#endif
+
+static const mp_limb_t DIGIT_MASK = (static_cast<mp_limb_t>(1) << 52) - 1; // The low DIGIT_BITS bits of a limb.
+
+MultiBufferModExp::MultiBufferModExp(){
+/***********************************************************************
+* Constructor for an empty MultiBufferModExp, setModulus() has to be called
+* before exponentiate() is used.
+***********************************************************************/
+    numberOfDigits = 0;
+    inverse = 0;
+}
+
+void MultiBufferModExp::setModulus(const mpz_t modulus){
+/***********************************************************************
+* Works out the constants of the modulus in radix 2^52, the size of number the AVX-512
+* IFMA instructions multiply. Each number is held as numberOfDigits digits of 52 bits in
+* the low bits of a 64 bit limb, and there are enough digits that R = 2^(52 * numberOfDigits)
+* is over 4 times the modulus, which keeps every result of multiply() below twice the
+* modulus without a subtraction:
+* - inverse = -modulus^-1 mod 2^52, which clears one digit at a time.
+* - rSquared = R^2 mod modulus, used to convert the bases into Montgomery form.
+*
+* Arguments:
+* @ modulus: The odd modulus which all of the arithmetic is done modulo.
+***********************************************************************/
+    this->modulus = mpz_class(modulus);
+    numberOfDigits = static_cast<int>((mpz_sizeinbase(modulus, 2) + 2 + DIGIT_BITS - 1) / DIGIT_BITS);
+    size_t digitsWritten = 0;
+    modulusDigits.assign(numberOfDigits, 0);
+    mpz_export(modulusDigits.data(), &digitsWritten, -1, sizeof(mp_limb_t), 0, GMP_NUMB_BITS - DIGIT_BITS, modulus);
+
+    // Newton's iteration doubles the number of correct bits each time, starting from 5 bits.
+    mp_limb_t lowestDigit = modulusDigits[0];
+    mp_limb_t modulusInverse = (3 * lowestDigit) ^ 2;
+    for(int i = 0; i < 4; i++){
+        modulusInverse *= 2 - lowestDigit * modulusInverse;
+    }
+    inverse = (0 - modulusInverse) & DIGIT_MASK;
+
+    mpz_class rSquared;
+    mpz_setbit(rSquared.get_mpz_t(), 2 * DIGIT_BITS * numberOfDigits);
+    mpz_mod(rSquared.get_mpz_t(), rSquared.get_mpz_t(), modulus);
+    rSquaredDigits.assign(numberOfDigits, 0);
+    mpz_export(rSquaredDigits.data(), &digitsWritten, -1, sizeof(mp_limb_t), 0, GMP_NUMB_BITS - DIGIT_BITS, rSquared.get_mpz_t());
+}
+
+int MultiBufferModExp::getScratchSize(const mpz_t exponent) const{
+/***********************************************************************
+* Arguments:
+* @ exponent: The exponent which exponentiate() will be called with.
+*
+* Returns:
+*  The number of limbs exponentiate() needs in its scratch buffer: the table of odd powers,
+*  the base squared, the running result, the bases, R^2 and 1, the product of multiply(),
+*  the limbs read from each base, and room to line the buffer up on 64 bytes.
+***********************************************************************/
+    long exponentBits = (mpz_sgn(exponent) == 0) ? 0 : static_cast<long>(mpz_sizeinbase(exponent, 2));
+    int tableSize = 1 << (MultiBufferModExp::getWindowSize(exponentBits) - 1);
+    return LANES * (numberOfDigits * (tableSize + 5) + 2 * numberOfDigits + 1 + numberOfDigits) + LANES;
+}
+
+bool MultiBufferModExp::isSupported(){
+/***********************************************************************
+* Checks, once, whether the processor has AVX-512 IFMA and the operating system saves
+* the AVX-512 registers. The CPUID leaves are read through Crypto++'s feature detection,
+* which already checks the operating system saves the AVX registers for HasAVX2().
+*
+* Returns:
+*  True: If exponentiate() can be used on this machine.
+*  False: If it cannot, or the compiler cannot build it.
+***********************************************************************/
+#ifdef MULTI_BUFFER_MOD_EXP_SUPPORTED
+    static const bool supported = [](){
+        CryptoPP::word32 registers[4] = {0, 0, 0, 0};
+        if(CryptoPP::HasAVX2() == false || CryptoPP::CpuId(7, 0, registers) == false){
+            return false;
+        }
+        bool hasAVX512F = (registers[1] & (1u << 16)) != 0;
+        bool hasAVX512IFMA = (registers[1] & (1u << 21)) != 0;
+        if(hasAVX512F == false || hasAVX512IFMA == false){
+            return false;
+        }
+        // XCR0 bits 5 to 7 are set when the operating system saves the AVX-512 mask and register state.
+        std::uint32_t xcr0Low = 0;
+        std::uint32_t xcr0High = 0;
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        return (xcr0Low & 0xE6) == 0xE6;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void MultiBufferModExp::exponentiate(mpz_ptr *results, const mpz_srcptr *bases, int count, const mpz_t exponent, std::vector<mp_limb_t> &scratch) const{
+/***********************************************************************
+* Works out results[i] = bases[i]^exponent mod modulus for up to LANES bases at once.
+* Every number is stored a digit at a time across the lanes: digit j of all eight
+* numbers sits in one 64 byte vector, so each IFMA instruction works on the same digit
+* of eight independent exponentiations and the lanes never have to be shuffled. The
+* exponent is the same for every lane, so they all follow the same left to right sliding
+* window and the cost of a batch is the same as the cost of one exponentiation.
+* Unused lanes are filled with zero. Must only be called when isSupported() is true.
+*
+* Arguments:
+* @ results: count initialised multiprecision variables the results are written to.
+* @ bases: count numbers to raise to the power of the exponent.
+* @ count: The number of bases, from 1 to LANES.
+* @ exponent: The non-negative exponent.
+* @ scratch: The worker's scratch vector, resized to getScratchSize() limbs if needed.
+***********************************************************************/
+    long exponentBits = (mpz_sgn(exponent) == 0) ? 0 : static_cast<long>(mpz_sizeinbase(exponent, 2));
+    int windowSize = MultiBufferModExp::getWindowSize(exponentBits);
+    int tableSize = 1 << (windowSize - 1);
+    size_t vectorLimbs = static_cast<size_t>(LANES) * numberOfDigits;
+    if(scratch.size() < static_cast<size_t>(getScratchSize(exponent))){
+        scratch.resize(getScratchSize(exponent));
+    }
+    // The IFMA loads and stores need the vectors to start on a 64 byte boundary.
+    std::uintptr_t scratchAddress = reinterpret_cast<std::uintptr_t>(scratch.data());
+    mp_limb_t *table = scratch.data() + ((64 - scratchAddress % 64) % 64) / sizeof(mp_limb_t);
+    mp_limb_t *baseSquared = table + tableSize * vectorLimbs;
+    mp_limb_t *value = baseSquared + vectorLimbs;
+    mp_limb_t *baseValues = value + vectorLimbs;
+    mp_limb_t *rSquared = baseValues + vectorLimbs;
+    mp_limb_t *one = rSquared + vectorLimbs;
+    mp_limb_t *product = one + vectorLimbs;
+    mp_limb_t *laneDigits = product + LANES * (2 * numberOfDigits + 1);
+
+    // Spread the digits of each base across the lanes.
+    mpz_class reducedBase;
+    for(int lane = 0; lane < LANES; lane++){
+        for(int i = 0; i < numberOfDigits; i++){
+            laneDigits[i] = 0;
+        }
+        if(lane < count){
+            mpz_srcptr baseToUse = bases[lane];
+            if(mpz_sgn(baseToUse) < 0 || mpz_cmp(baseToUse, modulus.get_mpz_t()) >= 0){
+                mpz_mod(reducedBase.get_mpz_t(), baseToUse, modulus.get_mpz_t());
+                baseToUse = reducedBase.get_mpz_t();
+            }
+            size_t digitsWritten = 0;
+            mpz_export(laneDigits, &digitsWritten, -1, sizeof(mp_limb_t), 0, GMP_NUMB_BITS - DIGIT_BITS, baseToUse);
+        }
+        for(int i = 0; i < numberOfDigits; i++){
+            baseValues[i * LANES + lane] = laneDigits[i];
+        }
+    }
+    MultiBufferModExp::broadcast(rSquared, rSquaredDigits.data());
+    for(size_t i = 0; i < vectorLimbs; i++){
+        one[i] = (i < static_cast<size_t>(LANES)) ? 1 : 0;
+    }
+
+    // table[i] = base^(2i + 1), in Montgomery form.
+    MultiBufferModExp::multiply(table, baseValues, rSquared, product);
+    if(tableSize > 1){
+        MultiBufferModExp::multiply(baseSquared, table, table, product);
+        for(int i = 1; i < tableSize; i++){
+            MultiBufferModExp::multiply(table + i * vectorLimbs, table + (i - 1) * vectorLimbs, baseSquared, product);
+        }
+    }
+
+    // value starts as 1 in Montgomery form (R mod modulus) for a zero exponent, otherwise
+    // the first window starts straight from its table entry, rather than squaring 1.
+    bool started = false;
+    MultiBufferModExp::multiply(value, one, rSquared, product);
+    long bitIndex = exponentBits - 1;
+    while(bitIndex >= 0){
+        if(mpz_tstbit(exponent, bitIndex) == 0){
+            MultiBufferModExp::multiply(value, value, value, product);
+            bitIndex--;
+            continue;
+        }
+        long windowEnd = (bitIndex - windowSize + 1 < 0) ? 0 : bitIndex - windowSize + 1;
+        while(mpz_tstbit(exponent, windowEnd) == 0){
+            windowEnd++;
+        }
+        int windowValue = 0;
+        for(long i = bitIndex; i >= windowEnd; i--){
+            windowValue = (windowValue << 1) | mpz_tstbit(exponent, i);
+            if(started == true){
+                MultiBufferModExp::multiply(value, value, value, product);
+            }
+        }
+        const mp_limb_t *tableEntry = table + (windowValue >> 1) * vectorLimbs;
+        if(started == true){
+            MultiBufferModExp::multiply(value, value, tableEntry, product);
+        }
+        else{
+            for(size_t i = 0; i < vectorLimbs; i++){
+                value[i] = tableEntry[i];
+            }
+            started = true;
+        }
+        bitIndex = windowEnd - 1;
+    }
+
+    // Multiplying by a plain 1 takes the values out of Montgomery form, leaving each below twice the modulus.
+    MultiBufferModExp::multiply(value, value, one, product);
+    for(int lane = 0; lane < count; lane++){
+        for(int i = 0; i < numberOfDigits; i++){
+            laneDigits[i] = value[i * LANES + lane];
+        }
+        mpz_import(results[lane], numberOfDigits, -1, sizeof(mp_limb_t), 0, GMP_NUMB_BITS - DIGIT_BITS, laneDigits);
+        if(mpz_cmp(results[lane], modulus.get_mpz_t()) >= 0){
+            mpz_sub(results[lane], results[lane], modulus.get_mpz_t());
+        }
+    }
+}
+
+void MultiBufferModExp::broadcast(mp_limb_t *result, const mp_limb_t *digits) const{
+/***********************************************************************
+* Copies a number into every lane, e.g. R^2 mod modulus.
+*
+* Arguments:
+* @ result: The LANES * numberOfDigits limbs which the number is written to.
+* @ digits: The numberOfDigits digits of the number.
+***********************************************************************/
+    for(int i = 0; i < numberOfDigits; i++){
+        for(int lane = 0; lane < LANES; lane++){
+            result[i * LANES + lane] = digits[i];
+        }
+    }
+}
+
+#ifdef MULTI_BUFFER_MOD_EXP_SUPPORTED
+__attribute__((target("avx512f,avx512ifma")))
+#endif
+void MultiBufferModExp::multiply(mp_limb_t *result, const mp_limb_t *firstValue, const mp_limb_t *secondValue, mp_limb_t *product) const{
+/***********************************************************************
+* Montgomery multiplication of eight pairs of numbers at once, result = firstValue * secondValue * R^-1,
+* with both inputs below twice the modulus and a result below twice the modulus.
+* vpmadd52luq and vpmadd52huq add the low and high 52 bits of each 52 by 52 bit product
+* to a 64 bit column of the product. The columns are left unnormalised, each one has room for
+* thousands of products, until the carries are added along once at the end. For each digit of
+* firstValue, a multiple of the modulus is added which clears the lowest column, and the next
+* digit works one column up, so the result ends up in the top half of the product.
+* The result can be the same buffer as either of the inputs.
+*
+* Arguments:
+* @ result: The LANES * numberOfDigits limbs which the products are written to.
+* @ firstValue: The first numbers, LANES * numberOfDigits limbs.
+* @ secondValue: The second numbers, LANES * numberOfDigits limbs.
+* @ product: LANES * (2 * numberOfDigits + 1) limbs for the unnormalised product.
+***********************************************************************/
+#ifdef MULTI_BUFFER_MOD_EXP_SUPPORTED
+    const __m512i *first = reinterpret_cast<const __m512i*>(firstValue);
+    const __m512i *second = reinterpret_cast<const __m512i*>(secondValue);
+    __m512i *columns = reinterpret_cast<__m512i*>(product);
+    __m512i zero = _mm512_setzero_si512();
+    __m512i digitMask = _mm512_set1_epi64(static_cast<long long>(DIGIT_MASK));
+    __m512i modulusInverse = _mm512_set1_epi64(static_cast<long long>(inverse));
+    for(int i = 0; i <= 2 * numberOfDigits; i++){
+        columns[i] = zero;
+    }
+
+    for(int i = 0; i < numberOfDigits; i++){
+        __m512i *column = columns + i;
+        __m512i firstDigit = first[i];
+        for(int j = 0; j < numberOfDigits; j++){
+            column[j] = _mm512_madd52lo_epu64(column[j], firstDigit, second[j]);
+            column[j + 1] = _mm512_madd52hi_epu64(column[j + 1], firstDigit, second[j]);
+        }
+        __m512i multiple = _mm512_madd52lo_epu64(zero, column[0], modulusInverse);
+        for(int j = 0; j < numberOfDigits; j++){
+            __m512i modulusDigit = _mm512_set1_epi64(static_cast<long long>(modulusDigits[j]));
+            column[j] = _mm512_madd52lo_epu64(column[j], multiple, modulusDigit);
+            column[j + 1] = _mm512_madd52hi_epu64(column[j + 1], multiple, modulusDigit);
+        }
+        // The low 52 bits of the lowest column are now zero, only its carry moves up.
+        column[1] = _mm512_add_epi64(column[1], _mm512_srli_epi64(column[0], DIGIT_BITS));
+    }
+
+    __m512i *output = reinterpret_cast<__m512i*>(result);
+    __m512i carry = zero;
+    for(int j = 0; j < numberOfDigits; j++){
+        __m512i digit = _mm512_add_epi64(columns[numberOfDigits + j], carry);
+        carry = _mm512_srli_epi64(digit, DIGIT_BITS);
+        output[j] = _mm512_and_si512(digit, digitMask);
+    }
+#else
+    (void)result; (void)firstValue; (void)secondValue; (void)product;
+#endif
+}
+
+int MultiBufferModExp::getWindowSize(long exponentBits){
+/***********************************************************************
+* Arguments:
+* @ exponentBits: The number of bits in the exponent.
+*
+* Returns:
+*  The sliding window size, the same thresholds as MontgomeryContext::exponentiate().
+***********************************************************************/
+    return (exponentBits > 671) ? 6 : (exponentBits > 239) ? 5 : (exponentBits > 79) ? 4 : (exponentBits > 23) ? 3 : 1;
+}
@@ -0,0 +1,36 @@
+#ifndef MULTIBUFFERMODEXP_H
+#define MULTIBUFFERMODEXP_H
+
+#include <gmpxx.h>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__) && GMP_NUMB_BITS == 64
+#define MULTI_BUFFER_MOD_EXP_SUPPORTED
+#endif
+
+class MultiBufferModExp
+{
+public:
+    static const int LANES = 8;
+
+    MultiBufferModExp();
+    void setModulus(const mpz_t modulus);
+    int getScratchSize(const mpz_t exponent) const;
+    void exponentiate(mpz_ptr *results, const mpz_srcptr *bases, int count, const mpz_t exponent, std::vector<mp_limb_t> &scratch) const;
+    static bool isSupported();
+
+private:
+    static const int DIGIT_BITS = 52;
+
+    int numberOfDigits;
+    mpz_class modulus;
+    std::vector<mp_limb_t> modulusDigits;
+    std::vector<mp_limb_t> rSquaredDigits;
+    mp_limb_t inverse;
+
+    void multiply(mp_limb_t *result, const mp_limb_t *firstValue, const mp_limb_t *secondValue, mp_limb_t *product) const;
+    void broadcast(mp_limb_t *result, const mp_limb_t *digits) const;
+    static int getWindowSize(long exponentBits);
+};
+
+#endif // MULTIBUFFERMODEXP_H
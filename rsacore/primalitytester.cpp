@@ -0,0 +1,314 @@
+#include "primalitytester.h"
+#include <gmpxx.h>
+
+#include <cstdlib>
+
+static int PARANOID_NUMBER_OF_CHECKS = 64; // Worst case error of 4^-64 = 2^-128 for any number, not just random ones.
+static int SMALL_PRIME_NUMBER_OF_CHECKS = 40; // Worst case error of 4^-40 = 2^-80, for primes smaller than the tables cover.
+
+PrimalityTester::PrimalityTester(bool useLucasTest){
+/***********************************************************************
+* Constructor for the PrimalityTester class. All of the multiprecision variables,
+* the random state and the buffers are set up once here and reused for every
+* number that is tested, so testing a number does not allocate any memory once
+* the buffers have grown to the size of the numbers being tested.
+*
+* Arguments:
+* @ useLucasTest: Whether a strong Lucas test is run after the Miller-Rabin checks (Baillie-PSW).
+***********************************************************************/
+    this->useLucasTest = useLucasTest;
+    gmp_randinit_mt(randomState);
+    mpz_init(number);
+    mpz_init(oddPart);
+    mpz_init(upperBound);
+    mpz_init(witness);
+    mpz_init(lucasExponent);
+    mpz_init(lucasU);
+    mpz_init(lucasV);
+    mpz_init(lucasQk);
+    mpz_init(lucasTemp);
+    powerOfTwo = 0;
+    statistics = primalityStatistics();
+}
+
+PrimalityTester::~PrimalityTester(){
+/***********************************************************************
+* Destructor for the PrimalityTester class, frees the multiprecision variables.
+***********************************************************************/
+    gmp_randclear(randomState);
+    mpz_clear(number);
+    mpz_clear(oddPart);
+    mpz_clear(upperBound);
+    mpz_clear(witness);
+    mpz_clear(lucasExponent);
+    mpz_clear(lucasU);
+    mpz_clear(lucasV);
+    mpz_clear(lucasQk);
+    mpz_clear(lucasTemp);
+}
+
+void PrimalityTester::seed(const mpz_t seedValue){
+/***********************************************************************
+* Seeds the random state which the Miller-Rabin witnesses are picked with.
+*
+* Arguments:
+* @ seedValue: The seed, which should come from a secure random source.
+***********************************************************************/
+    gmp_randseed(randomState, seedValue);
+}
+
+bool PrimalityTester::isProbablePrime(const mpz_t numberToCheck, int numberOfChecks, const std::atomic<bool> *cancelled){
+/***********************************************************************
+* Tests whether a number is prime.
+* A Miller-Rabin check with the witness 2 is always run first, as it rejects nearly every
+* composite with a single exponentiation. It is followed by numberOfChecks checks with
+* random witnesses. If useLucasTest is set, a strong Lucas test is run last; together
+* with the base 2 check this is the Baillie-PSW test, which has no known counterexample.
+*
+* Probability of returning a non prime (i.e incorrect output) is at most 4^(-numberOfChecks)
+* for the Miller-Rabin checks alone, and is much lower for random candidates.
+*
+* Arguments:
+* @ numberToCheck: The number which is checked to see if it is prime.
+* @ numberOfChecks: The number of Miller-Rabin checks with random witnesses to run.
+* @ cancelled: An optional flag, once it is set the test stops and returns false.
+*
+* Returns:
+*  True: If the number has passed all of the checks (i.e. prime).
+*  False: If the number has been proven to be composite, or the test has been cancelled.
+***********************************************************************/
+    if(mpz_cmp_ui(numberToCheck, 3) <= 0){
+        return mpz_cmp_ui(numberToCheck, 2) >= 0;
+    }
+    if(mpz_even_p(numberToCheck)){
+        return false;
+    }
+    statistics.candidatesTested++;
+    PrimalityTester::setNumber(numberToCheck);
+
+    mpz_set_ui(witness, 2);
+    if(PrimalityTester::strongProbablePrimeCheck(witness) == false){
+        return false;
+    }
+    for(int i = 0; i < numberOfChecks; i++){
+        if(cancelled != nullptr && *cancelled == true){
+            return false;
+        }
+        // The reason we subtract 3 from the upper bound, then add 2 after random generation
+        // Is to ensure the witness falls between 2 =< witness =< numberToCheck - 2 (bounds inclusive)
+        mpz_urandomm(witness, randomState, upperBound);
+        mpz_add_ui(witness, witness, 2);
+        if(PrimalityTester::strongProbablePrimeCheck(witness) == false){
+            return false;
+        }
+    }
+    if(useLucasTest == true){
+        if(cancelled != nullptr && *cancelled == true){
+            return false;
+        }
+        if(PrimalityTester::strongLucasCheck() == false){
+            return false;
+        }
+    }
+    statistics.primesAccepted++;
+    return true;
+}
+
+primalityStatistics PrimalityTester::getStatistics() const{
+/***********************************************************************
+* Returns:
+*  statistics: The number of candidates, exponentiations, Lucas tests and primes
+*              this tester has seen since it was created.
+***********************************************************************/
+    return statistics;
+}
+
+int PrimalityTester::getNumberOfChecks(int sizeOfPrimes, bool useLucasTest, bool paranoid){
+/***********************************************************************
+* Works out how many random Miller-Rabin checks are needed for a prime of the given size.
+* The numbers follow FIPS 186-4 Appendix C (Table C.3), which gives the number of rounds
+* needed for randomly generated candidates to reach the error probability that matches
+* the security strength of the key:
+*
+*   Prime size     Error     M-R only     M-R + Lucas
+*   >= 1536 bits   2^-128        4             2
+*   >= 1024 bits   2^-112        5             3
+*   >=  512 bits   2^-100        7             4
+*
+* Smaller primes (the 128, 256 and 512 bit key sizes) are not covered by the table, so the
+* worst case bound of 4^-40 is used. The paranoid setting ignores the tables and uses 64
+* checks, which is a worst case bound of 2^-128 even for numbers that were not chosen at random.
+*
+* Arguments:
+* @ sizeOfPrimes: The size of the primes in bits.
+* @ useLucasTest: Whether the Miller-Rabin checks are followed by a strong Lucas test.
+* @ paranoid: Whether the user has asked for the maximum number of checks.
+*
+* Returns:
+*  The number of Miller-Rabin checks with random witnesses to pass to isProbablePrime().
+***********************************************************************/
+    if(paranoid == true){
+        return PARANOID_NUMBER_OF_CHECKS;
+    }
+    if(sizeOfPrimes >= 1536){
+        return (useLucasTest == true) ? 2 : 4;
+    }
+    if(sizeOfPrimes >= 1024){
+        return (useLucasTest == true) ? 3 : 5;
+    }
+    if(sizeOfPrimes >= 512){
+        return (useLucasTest == true) ? 4 : 7;
+    }
+    return SMALL_PRIME_NUMBER_OF_CHECKS;
+}
+
+void PrimalityTester::setNumber(const mpz_t numberToCheck){
+/***********************************************************************
+* Works out everything about the number being tested which does not depend on the witness,
+* so it is only done once for all of the checks:
+* - numberToCheck - 1 = oddPart * 2^powerOfTwo
+* - The Montgomery context for numberToCheck, and numberToCheck - 1 in Montgomery form.
+*
+* Arguments:
+* @ numberToCheck: The odd number which is going to be tested.
+***********************************************************************/
+    mpz_set(number, numberToCheck);
+    mpz_sub_ui(oddPart, number, 1);
+    powerOfTwo = mpz_scan1(oddPart, 0);
+    mpz_fdiv_q_2exp(oddPart, oddPart, powerOfTwo);
+    mpz_sub_ui(upperBound, number, 3);
+
+    context.setModulus(number);
+    int numberOfLimbs = context.getNumberOfLimbs();
+    montgomeryValue.resize(numberOfLimbs);
+    minusOne.resize(numberOfLimbs);
+    scratch.resize(context.getScratchSize());
+    // In Montgomery form -1 is modulus - R mod modulus.
+    mpn_sub_n(minusOne.data(), context.getModulus(), context.getOne(), numberOfLimbs);
+}
+
+bool PrimalityTester::strongProbablePrimeCheck(const mpz_t witnessValue){
+/***********************************************************************
+* A single Miller-Rabin check. With numberToCheck - 1 = oddPart * 2^powerOfTwo, a prime
+* must have witness^oddPart = 1, or witness^(oddPart * 2^r) = -1 for some r < powerOfTwo.
+* The exponentiation is done once, and each following power is found by squaring
+* the previous one.
+*
+* Arguments:
+* @ witnessValue: The witness, between 2 and numberToCheck - 2.
+*
+* Returns:
+*  True: If numberToCheck is potentially prime.
+*  False: If the witness proves that numberToCheck is composite.
+***********************************************************************/
+    mp_limb_t *value = montgomeryValue.data();
+    context.toMontgomery(value, witnessValue, scratch.data());
+    context.exponentiate(value, value, oddPart, exponentScratch);
+    statistics.modularExponentiations++;
+
+    if(context.isEqual(value, context.getOne()) || context.isEqual(value, minusOne.data())){
+        return true;
+    }
+    for(unsigned long r = 1; r < powerOfTwo; r++){
+        context.square(value, value, scratch.data());
+        if(context.isEqual(value, minusOne.data())){
+            return true;
+        }
+        if(context.isEqual(value, context.getOne())){
+            // 1 was reached without passing through -1, so a non-trivial square root of 1 exists.
+            return false;
+        }
+    }
+    return false;
+}
+
+bool PrimalityTester::strongLucasCheck(){
+/***********************************************************************
+* The strong Lucas probable prime test, using Selfridge's parameters: D is the first of
+* 5, -7, 9, -11, ... with Jacobi symbol (D / n) = -1, P = 1 and Q = (1 - D) / 4.
+* With n + 1 = d * 2^s, a prime must have U_d = 0, or V_(d * 2^r) = 0 for some r < s.
+* U_d and V_d are worked out with the doubling formulas, one bit of d at a time:
+* - U_2k = U_k * V_k, V_2k = V_k^2 - 2Q^k
+* - U_(k+1) = (P * U_k + V_k) / 2, V_(k+1) = (D * U_k + P * V_k) / 2
+*
+* Returns:
+*  True: If the number is a strong Lucas probable prime.
+*  False: If the number is composite.
+***********************************************************************/
+    statistics.lucasTests++;
+    // A perfect square has no D with (D / n) = -1, so it has to be ruled out first.
+    if(mpz_perfect_square_p(number)){
+        return false;
+    }
+    long d = 5;
+    while(true){
+        mpz_set_si(lucasTemp, d);
+        int jacobi = mpz_jacobi(lucasTemp, number);
+        if(jacobi == -1){
+            break;
+        }
+        if(jacobi == 0 && mpz_cmpabs_ui(number, labs(d)) != 0){
+            return false;
+        }
+        d = (d > 0) ? -(d + 2) : -(d - 2);
+    }
+    long q = (1 - d) / 4;
+
+    mpz_add_ui(lucasExponent, number, 1);
+    unsigned long lucasPowerOfTwo = mpz_scan1(lucasExponent, 0);
+    mpz_fdiv_q_2exp(lucasExponent, lucasExponent, lucasPowerOfTwo);
+
+    // Start from k = 1: U_1 = 1, V_1 = P = 1, Q^1 = Q.
+    mpz_set_ui(lucasU, 1);
+    mpz_set_ui(lucasV, 1);
+    mpz_set_si(lucasQk, q);
+    mpz_mod(lucasQk, lucasQk, number);
+    long exponentBits = static_cast<long>(mpz_sizeinbase(lucasExponent, 2));
+    for(long bitIndex = exponentBits - 2; bitIndex >= 0; bitIndex--){
+        mpz_mul(lucasU, lucasU, lucasV);
+        mpz_mod(lucasU, lucasU, number);
+        mpz_mul(lucasV, lucasV, lucasV);
+        mpz_submul_ui(lucasV, lucasQk, 2);
+        mpz_mod(lucasV, lucasV, number);
+        mpz_mul(lucasQk, lucasQk, lucasQk);
+        mpz_mod(lucasQk, lucasQk, number);
+
+        if(mpz_tstbit(lucasExponent, bitIndex) == 1){
+            // Both of the new values use the old U_k and V_k, so V_(k+1) is kept in lucasTemp until U_(k+1) is done.
+            // Halving modulo n: n is odd, so adding n to an odd value makes it even.
+            mpz_mul_si(lucasTemp, lucasU, d);
+            mpz_add(lucasTemp, lucasTemp, lucasV);
+            mpz_mod(lucasTemp, lucasTemp, number);
+            if(mpz_odd_p(lucasTemp)){
+                mpz_add(lucasTemp, lucasTemp, number);
+            }
+            mpz_fdiv_q_2exp(lucasTemp, lucasTemp, 1);
+
+            mpz_add(lucasU, lucasU, lucasV);
+            mpz_mod(lucasU, lucasU, number);
+            if(mpz_odd_p(lucasU)){
+                mpz_add(lucasU, lucasU, number);
+            }
+            mpz_fdiv_q_2exp(lucasU, lucasU, 1);
+            mpz_swap(lucasV, lucasTemp);
+
+            mpz_mul_si(lucasQk, lucasQk, q);
+            mpz_mod(lucasQk, lucasQk, number);
+        }
+    }
+
+    if(mpz_sgn(lucasU) == 0 || mpz_sgn(lucasV) == 0){
+        return true;
+    }
+    for(unsigned long r = 1; r < lucasPowerOfTwo; r++){
+        mpz_mul(lucasV, lucasV, lucasV);
+        mpz_submul_ui(lucasV, lucasQk, 2);
+        mpz_mod(lucasV, lucasV, number);
+        if(mpz_sgn(lucasV) == 0){
+            return true;
+        }
+        mpz_mul(lucasQk, lucasQk, lucasQk);
+        mpz_mod(lucasQk, lucasQk, number);
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+#ifndef PRIMALITYTESTER_H
+#define PRIMALITYTESTER_H
+
+#include "montgomerycontext.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <vector>
+
+struct primalityStatistics{
+    unsigned long long candidatesTested;
+    unsigned long long modularExponentiations;
+    unsigned long long lucasTests;
+    unsigned long long primesAccepted;
+};
+
+class PrimalityTester
+{
+public:
+    explicit PrimalityTester(bool useLucasTest = true);
+    ~PrimalityTester();
+    PrimalityTester(const PrimalityTester &) = delete;
+    PrimalityTester &operator=(const PrimalityTester &) = delete;
+    void seed(const mpz_t seedValue);
+    bool isProbablePrime(const mpz_t numberToCheck, int numberOfChecks, const std::atomic<bool> *cancelled = nullptr);
+    primalityStatistics getStatistics() const;
+    static int getNumberOfChecks(int sizeOfPrimes, bool useLucasTest, bool paranoid);
+
+private:
+    bool useLucasTest;
+    gmp_randstate_t randomState;
+    MontgomeryContext context;
+    mpz_t number;
+    mpz_t oddPart;
+    mpz_t upperBound;
+    mpz_t witness;
+    mpz_t lucasExponent;
+    mpz_t lucasU;
+    mpz_t lucasV;
+    mpz_t lucasQk;
+    mpz_t lucasTemp;
+    unsigned long powerOfTwo;
+    std::vector<mp_limb_t> montgomeryValue;
+    std::vector<mp_limb_t> minusOne;
+    std::vector<mp_limb_t> scratch;
+    std::vector<mp_limb_t> exponentScratch;
+    primalityStatistics statistics;
+
+    void setNumber(const mpz_t numberToCheck);
+    bool strongProbablePrimeCheck(const mpz_t witnessValue);
+    bool strongLucasCheck();
+};
+
+#endif // PRIMALITYTESTER_H
@@ -0,0 +1,534 @@
+#include "primepool.h"
+#include "primalitytester.h"
+#include <gmpxx.h>
+
+#include <cryptopp/aes.h>
+#include <cryptopp/gcm.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/secblock.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+const std::string CACHE_MAGIC = "RSAPOOL1"; // The first bytes of every prime cache file.
+const int CACHE_KEY_SIZE = 32; // Size of the AES-256 key which encrypts the cache, in bytes.
+const int CACHE_IV_SIZE = 12; // Size of the AES-GCM nonce stored at the start of the cache, in bytes.
+
+PrimePool::PrimePool(std::string cacheFilepath, std::vector<int> primeSizes, int depth, int refillThreshold, unsigned int numberOfWorkers){
+/***********************************************************************
+* Constructor for the PrimePool, which keeps a stock of ready made primes for each
+* key size so that generating a key does not have to wait for the prime search.
+* Nothing is loaded or generated until start() is called.
+*
+* Arguments:
+* @ cacheFilepath: The file the encrypted primes are stored in between runs, the AES key
+*                  is kept next to it in cacheFilepath + ".key", and cacheFilepath + ".lock"
+*                  is locked by the PrimePool which owns the cache.
+* @ primeSizes: The sizes (in bits) of the primes that are kept in the pool.
+* @ depth: The number of primes of each size the workers fill the pool up to.
+* @ refillThreshold: Once a size drops below this many primes, the workers refill it back up to depth.
+* @ numberOfWorkers: The number of background threads generating primes.
+***********************************************************************/
+    this->cacheFilepath = cacheFilepath;
+    this->keyFilepath = cacheFilepath + ".key";
+    this->primeSizes = primeSizes;
+    this->depth = std::max(depth, 2);
+    this->refillThreshold = std::min(std::max(refillThreshold, 2), this->depth);
+    this->numberOfWorkers = std::max(numberOfWorkers, 1u);
+    this->stopping = false;
+    this->ownsCache = false;
+#ifdef _WIN32
+    this->cacheLock = INVALID_HANDLE_VALUE;
+#else
+    this->cacheLock = -1;
+#endif
+    // Larger primes take the longest to find on demand, so they are refilled first.
+    std::sort(this->primeSizes.rbegin(), this->primeSizes.rend());
+    for(unsigned int i = 0; i < this->primeSizes.size(); i++){
+        primes[this->primeSizes[i]];
+        primesInProgress[this->primeSizes[i]] = 0;
+        refilling[this->primeSizes[i]] = true;
+    }
+}
+
+PrimePool::~PrimePool(){
+/***********************************************************************
+* Destructor for the PrimePool, stops the workers so none are left running
+* against a pool that no longer exists.
+***********************************************************************/
+    PrimePool::stop();
+}
+
+void PrimePool::start(){
+/***********************************************************************
+* Locks the cache, loads the primes left over from the last run and starts the
+* background workers, which fill every size up to the configured depth.
+* If another PrimePool (such as one in a second copy of the program) already owns
+* the cache, this pool runs without it and its primes are only ever held in memory,
+* so the two pools can never hand out the same prime.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if(workers.empty() == false){
+        return;
+    }
+    stopping = false;
+    ownsCache = PrimePool::lockCache();
+    if(ownsCache == true){
+        PrimePool::loadCache();
+    }
+    for(unsigned int i = 0; i < numberOfWorkers; i++){
+        workers.emplace_back(&PrimePool::refillWorker, this);
+    }
+}
+
+void PrimePool::stop(){
+/***********************************************************************
+* Stops the background workers, cancelling any prime search which is still running,
+* and waits for them to finish. The primes in the pool are already saved, so they are
+* dropped from memory and the cache is unlocked for the next PrimePool to load.
+***********************************************************************/
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+        for(unsigned int i = 0; i < activeSearches.size(); i++){
+            activeSearches[i]->cancel();
+        }
+    }
+    refillNeeded.notify_all();
+    for(unsigned int i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if(ownsCache == true){
+        for(std::map<int, std::vector<std::string>>::iterator pool = primes.begin(); pool != primes.end(); ++pool){
+            pool->second.clear();
+        }
+        PrimePool::unlockCache();
+        ownsCache = false;
+    }
+}
+
+bool PrimePool::takePrimePair(int sizeOfPrimes, unsigned long publicExponent, mpz_t prime1, mpz_t prime2){
+/***********************************************************************
+* Takes two different primes of the given size out of the pool. The cache file is
+* rewritten before the primes are handed out, and they are only handed out once it has
+* been saved, so a prime is never used for two keys, even if the program is closed straight
+* afterwards. If the cache can't be saved, the primes go back into the pool and false is returned.
+* Primes with prime mod publicExponent == 1 can't be used in a key, so they are thrown away.
+*
+* Arguments:
+* @ sizeOfPrimes: The size of the primes in bits.
+* @ publicExponent: The public exponent (e) of the key the primes are for.
+* @ prime1: The initialised multiprecision variable which the first prime is written to.
+* @ prime2: The initialised multiprecision variable which the second prime is written to.
+*
+* Returns:
+*  True: If both primes were taken from the pool.
+*  False: If the pool does not hold two usable primes of this size, so they have to be searched for.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::map<int, std::vector<std::string>>::iterator pool = primes.find(sizeOfPrimes);
+    if(pool == primes.end() || pool->second.size() < 2){
+        return false;
+    }
+    std::vector<std::string> takenPrimes;
+    while(takenPrimes.size() < 2 && pool->second.empty() == false){
+        std::string bytes = pool->second.back();
+        pool->second.pop_back();
+        mpz_import(prime1, bytes.size(), 1, 1, 0, 0, bytes.data());
+        if(publicExponent > 1 && mpz_fdiv_ui(prime1, publicExponent) == 1){
+            continue;
+        }
+        if(takenPrimes.empty() == false && takenPrimes[0] == bytes){
+            continue;
+        }
+        takenPrimes.push_back(bytes);
+    }
+    // The cache has to be saved without the primes before they are used, unless this pool
+    // doesn't own the cache, in which case they were never saved anywhere.
+    if(takenPrimes.size() < 2 || (ownsCache == true && PrimePool::saveCache() == false)){
+        pool->second.insert(pool->second.end(), takenPrimes.begin(), takenPrimes.end());
+        takenPrimes.clear();
+    }
+    PrimePool::updateRefillState(sizeOfPrimes);
+    refillNeeded.notify_all();
+
+    if(takenPrimes.empty() == true){
+        return false;
+    }
+    mpz_import(prime1, takenPrimes[0].size(), 1, 1, 0, 0, takenPrimes[0].data());
+    mpz_import(prime2, takenPrimes[1].size(), 1, 1, 0, 0, takenPrimes[1].data());
+    return true;
+}
+
+int PrimePool::getNumberOfPrimes(int sizeOfPrimes){
+/***********************************************************************
+* Arguments:
+* @ sizeOfPrimes: The size of the primes in bits.
+*
+* Returns:
+*  The number of primes of this size which are ready in the pool.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::map<int, std::vector<std::string>>::iterator pool = primes.find(sizeOfPrimes);
+    if(pool == primes.end()){
+        return 0;
+    }
+    return static_cast<int>(pool->second.size());
+}
+
+void PrimePool::refillWorker(){
+/***********************************************************************
+* The function that each background worker runs. It searches for one prime at a time
+* (on a single thread, so the interactive key generation keeps the other cores) for the
+* size which needs it most, and sleeps while every size is full enough.
+***********************************************************************/
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while(stopping == false){
+        int sizeOfPrimes = PrimePool::chooseSizeToRefill();
+        if(sizeOfPrimes == 0){
+            refillNeeded.wait(lock);
+            continue;
+        }
+
+        PrimeSearch primeSearch(sizeOfPrimes, PrimalityTester::getNumberOfChecks(sizeOfPrimes, true, false), 1, true);
+        activeSearches.push_back(&primeSearch);
+        primesInProgress[sizeOfPrimes]++;
+        lock.unlock();
+
+        mpz_t prime; mpz_init(prime);
+        bool found = primeSearch.findPrime(prime);
+
+        lock.lock();
+        activeSearches.erase(std::find(activeSearches.begin(), activeSearches.end(), &primeSearch));
+        primesInProgress[sizeOfPrimes]--;
+        if(found == true){
+            std::string bytes((mpz_sizeinbase(prime, 2) + 7) / 8, '\0');
+            mpz_export(&bytes[0], NULL, 1, 1, 0, 0, prime);
+            primes[sizeOfPrimes].push_back(bytes);
+            PrimePool::updateRefillState(sizeOfPrimes);
+            if(ownsCache == true){
+                PrimePool::saveCache();
+            }
+        }
+        mpz_clear(prime);
+    }
+}
+
+int PrimePool::chooseSizeToRefill(){
+/***********************************************************************
+* Picks the size the next prime should be generated for. Only sizes which are being
+* refilled are considered, and the one with the fewest primes (counting those already
+* being searched for) is chosen. Must be called with the poolMutex held.
+*
+* Returns:
+*  sizeOfPrimes: The size of the prime to generate, or 0 if nothing needs refilling.
+***********************************************************************/
+    int chosenSize = 0;
+    int fewestPrimes = depth;
+    for(unsigned int i = 0; i < primeSizes.size(); i++){
+        int sizeOfPrimes = primeSizes[i];
+        int numberOfPrimes = static_cast<int>(primes[sizeOfPrimes].size()) + primesInProgress[sizeOfPrimes];
+        if(refilling[sizeOfPrimes] == true && numberOfPrimes < fewestPrimes){
+            chosenSize = sizeOfPrimes;
+            fewestPrimes = numberOfPrimes;
+        }
+    }
+    return chosenSize;
+}
+
+void PrimePool::updateRefillState(int sizeOfPrimes){
+/***********************************************************************
+* Applies the refill policy to one size: refilling starts once the size drops below
+* the refillThreshold, and stops again once it is back up to depth. The gap between
+* the two stops the workers from waking up every time a single key is generated.
+* Must be called with the poolMutex held.
+*
+* Arguments:
+* @ sizeOfPrimes: The size of the primes in bits.
+***********************************************************************/
+    int numberOfPrimes = static_cast<int>(primes[sizeOfPrimes].size());
+    if(numberOfPrimes < refillThreshold){
+        refilling[sizeOfPrimes] = true;
+    }
+    else if(numberOfPrimes >= depth){
+        refilling[sizeOfPrimes] = false;
+    }
+}
+
+bool PrimePool::lockCache(){
+/***********************************************************************
+* Takes an exclusive lock on cacheFilepath + ".lock", which is held until unlockCache()
+* is called (or the program exits). Only the PrimePool holding it reads or writes the cache.
+*
+* Returns:
+*  True: If this PrimePool now owns the cache.
+*  False: If another PrimePool owns it, or the lock file can't be created.
+***********************************************************************/
+    std::string lockFilepath = cacheFilepath + ".lock";
+#ifdef _WIN32
+    // No other process can open the file while this handle, which shares nothing, is open.
+    HANDLE lockHandle = CreateFileA(lockFilepath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(lockHandle == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    cacheLock = lockHandle;
+#else
+    int lockDescriptor = open(lockFilepath.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if(lockDescriptor < 0){
+        return false;
+    }
+    if(flock(lockDescriptor, LOCK_EX | LOCK_NB) != 0){
+        close(lockDescriptor);
+        return false;
+    }
+    cacheLock = lockDescriptor;
+#endif
+    return true;
+}
+
+void PrimePool::unlockCache(){
+/***********************************************************************
+* Releases the lock taken by lockCache(), so another PrimePool can own the cache.
+***********************************************************************/
+#ifdef _WIN32
+    if(cacheLock != INVALID_HANDLE_VALUE){
+        CloseHandle(cacheLock);
+        cacheLock = INVALID_HANDLE_VALUE;
+    }
+#else
+    if(cacheLock >= 0){
+        flock(cacheLock, LOCK_UN);
+        close(cacheLock);
+        cacheLock = -1;
+    }
+#endif
+}
+
+void PrimePool::loadCache(){
+/***********************************************************************
+* Reads the primes saved by the last run. The file is laid out as the CACHE_MAGIC,
+* a random nonce and the AES-GCM encrypted list of primes, so a cache which has been
+* changed or is unreadable is detected by the authentication tag and ignored.
+* Must be called with the poolMutex held.
+***********************************************************************/
+    std::string key = PrimePool::loadCacheKey(false);
+    std::ifstream cacheFile(cacheFilepath, std::ios::binary);
+    if(key.empty() == true || cacheFile.is_open() == false){
+        return;
+    }
+    std::stringstream fileContents;
+    fileContents << cacheFile.rdbuf();
+    std::string contents = fileContents.str();
+    if(contents.size() < CACHE_MAGIC.size() + CACHE_IV_SIZE || contents.compare(0, CACHE_MAGIC.size(), CACHE_MAGIC) != 0){
+        return;
+    }
+
+    std::string plaintext;
+    try{
+        CryptoPP::GCM<CryptoPP::AES>::Decryption decryption;
+        decryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte*>(key.data()), key.size(),
+                                reinterpret_cast<const CryptoPP::byte*>(contents.data() + CACHE_MAGIC.size()), CACHE_IV_SIZE);
+        CryptoPP::StringSource(contents.substr(CACHE_MAGIC.size() + CACHE_IV_SIZE), true,
+                               new CryptoPP::AuthenticatedDecryptionFilter(decryption, new CryptoPP::StringSink(plaintext)));
+    }
+    catch(const CryptoPP::Exception &){
+        return;
+    }
+
+    // The plaintext is a list of (size in bits, number of primes, primes) records, sizes are big endian.
+    size_t position = 0;
+    while(position + 8 <= plaintext.size()){
+        unsigned int sizeOfPrimes = 0;
+        unsigned int numberOfPrimes = 0;
+        for(int i = 0; i < 4; i++){
+            sizeOfPrimes = (sizeOfPrimes << 8) | static_cast<unsigned char>(plaintext[position + i]);
+            numberOfPrimes = (numberOfPrimes << 8) | static_cast<unsigned char>(plaintext[position + 4 + i]);
+        }
+        position += 8;
+        size_t primeBytes = (sizeOfPrimes + 7) / 8;
+        if(primeBytes == 0 || numberOfPrimes > (plaintext.size() - position) / primeBytes){
+            return;
+        }
+        for(unsigned int i = 0; i < numberOfPrimes; i++){
+            if(primes.count(static_cast<int>(sizeOfPrimes)) != 0){
+                primes[static_cast<int>(sizeOfPrimes)].push_back(plaintext.substr(position, primeBytes));
+            }
+            position += primeBytes;
+        }
+    }
+    for(unsigned int i = 0; i < primeSizes.size(); i++){
+        PrimePool::updateRefillState(primeSizes[i]);
+    }
+}
+
+bool PrimePool::saveCache(){
+/***********************************************************************
+* Encrypts the primes in the pool with AES-GCM under a fresh nonce and writes them
+* to the cache file. The file is written to a temporary file first, flushed to the disk
+* and then renamed over the old cache, so a crash part way through never leaves a half
+* written cache. Must be called with the poolMutex held, by the PrimePool which owns the cache.
+*
+* Returns:
+*  True: If the cache file on the disk now holds exactly the primes in the pool.
+*  False: If the cache couldn't be saved, so the old cache file is still there.
+***********************************************************************/
+    std::string key = PrimePool::loadCacheKey(true);
+    if(key.empty() == true){
+        return false;
+    }
+
+    std::string plaintext;
+    for(std::map<int, std::vector<std::string>>::iterator pool = primes.begin(); pool != primes.end(); ++pool){
+        unsigned int sizeOfPrimes = static_cast<unsigned int>(pool->first);
+        unsigned int numberOfPrimes = static_cast<unsigned int>(pool->second.size());
+        for(int i = 3; i >= 0; i--){
+            plaintext += static_cast<char>((sizeOfPrimes >> (8 * i)) & 0xFF);
+        }
+        for(int i = 3; i >= 0; i--){
+            plaintext += static_cast<char>((numberOfPrimes >> (8 * i)) & 0xFF);
+        }
+        for(unsigned int i = 0; i < numberOfPrimes; i++){
+            plaintext += pool->second[i];
+        }
+    }
+
+    CryptoPP::AutoSeededRandomPool randomPool;
+    CryptoPP::byte iv[CACHE_IV_SIZE];
+    randomPool.GenerateBlock(iv, sizeof(iv));
+    std::string ciphertext;
+    CryptoPP::GCM<CryptoPP::AES>::Encryption encryption;
+    encryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte*>(key.data()), key.size(), iv, sizeof(iv));
+    CryptoPP::StringSource(plaintext, true, new CryptoPP::AuthenticatedEncryptionFilter(encryption, new CryptoPP::StringSink(ciphertext)));
+    std::fill(plaintext.begin(), plaintext.end(), '\0');
+
+    std::string contents = CACHE_MAGIC + std::string(reinterpret_cast<const char*>(iv), sizeof(iv)) + ciphertext;
+    std::string temporaryFilepath = cacheFilepath + ".tmp";
+    if(PrimePool::writePrivateFile(temporaryFilepath, contents) == false){
+        std::remove(temporaryFilepath.c_str());
+        return false;
+    }
+    if(PrimePool::replaceFile(temporaryFilepath, cacheFilepath) == false){
+        std::remove(temporaryFilepath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string PrimePool::loadCacheKey(bool createIfMissing){
+/***********************************************************************
+* Reads the AES key the cache is encrypted with. The key is kept next to the cache and
+* the two files are only readable by the current user, so the primes (and so every key
+* made from them) are only protected by those file permissions: anyone who can read the
+* cache can read the key too. The encryption makes a cache which has been changed or cut
+* short detectable, it does not keep the primes secret on its own.
+*
+* Arguments:
+* @ createIfMissing: Whether a new random key is made and saved if there is no key file yet.
+*
+* Returns:
+* @ key: The CACHE_KEY_SIZE byte key, or an empty string if there is no usable key.
+***********************************************************************/
+    std::ifstream keyFile(keyFilepath, std::ios::binary);
+    std::string key(CACHE_KEY_SIZE, '\0');
+    if(keyFile.is_open() == true && keyFile.read(&key[0], CACHE_KEY_SIZE) && keyFile.gcount() == CACHE_KEY_SIZE){
+        return key;
+    }
+    keyFile.close();
+    if(createIfMissing == false){
+        return "";
+    }
+
+    CryptoPP::AutoSeededRandomPool randomPool;
+    randomPool.GenerateBlock(reinterpret_cast<CryptoPP::byte*>(&key[0]), key.size());
+    if(PrimePool::writePrivateFile(keyFilepath, key) == false){
+        std::remove(keyFilepath.c_str());
+        return "";
+    }
+    // Any old cache was encrypted with a different key, so it can't be read any more.
+    std::remove(cacheFilepath.c_str());
+    return key;
+}
+
+bool PrimePool::writePrivateFile(const std::string &filepath, const std::string &contents){
+/***********************************************************************
+* Writes contents to a new file which only the current user can read or write, and flushes
+* it to the disk. The file is created with those permissions, rather than having them set
+* afterwards, so there is no moment where another user could open it. Any old file is removed first.
+*
+* Arguments:
+* @ filepath: The path of the file to write.
+* @ contents: The bytes to write to the file.
+*
+* Returns:
+*  True: If every byte has been written and flushed.
+*  False: If the file couldn't be created or written.
+***********************************************************************/
+    std::remove(filepath.c_str());
+#ifdef _WIN32
+    int descriptor = _open(filepath.c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int descriptor = open(filepath.c_str(), O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR);
+#endif
+    if(descriptor < 0){
+        return false;
+    }
+    bool succeeded = true;
+    size_t written = 0;
+    while(succeeded == true && written < contents.size()){
+#ifdef _WIN32
+        int result = _write(descriptor, contents.data() + written, static_cast<unsigned int>(contents.size() - written));
+#else
+        ssize_t result = write(descriptor, contents.data() + written, contents.size() - written);
+#endif
+        succeeded = (result > 0);
+        if(succeeded == true){
+            written += static_cast<size_t>(result);
+        }
+    }
+#ifdef _WIN32
+    succeeded = succeeded && _commit(descriptor) == 0;
+    succeeded = (_close(descriptor) == 0) && succeeded;
+#else
+    succeeded = succeeded && fsync(descriptor) == 0;
+    succeeded = (close(descriptor) == 0) && succeeded;
+#endif
+    return succeeded;
+}
+
+bool PrimePool::replaceFile(const std::string &temporaryFilepath, const std::string &filepath){
+/***********************************************************************
+* Renames temporaryFilepath over filepath in a single step, so filepath always holds
+* either the old or the new file.
+*
+* Arguments:
+* @ temporaryFilepath: The new file, which has already been written and flushed.
+* @ filepath: The file which is replaced.
+*
+* Returns:
+*  True: If filepath has been replaced.
+*  False: If the rename failed, so filepath is unchanged.
+***********************************************************************/
+#ifdef _WIN32
+    // std::rename fails on Windows when filepath exists, MoveFileEx replaces it instead.
+    return MoveFileExA(temporaryFilepath.c_str(), filepath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(temporaryFilepath.c_str(), filepath.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef PRIMEPOOL_H
+#define PRIMEPOOL_H
+
+#include "primesearch.h"
+#include <gmpxx.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PrimePool
+{
+public:
+    PrimePool(std::string cacheFilepath, std::vector<int> primeSizes, int depth, int refillThreshold, unsigned int numberOfWorkers = 1);
+    ~PrimePool();
+    PrimePool(const PrimePool &) = delete;
+    PrimePool &operator=(const PrimePool &) = delete;
+    void start();
+    void stop();
+    bool takePrimePair(int sizeOfPrimes, unsigned long publicExponent, mpz_t prime1, mpz_t prime2);
+    int getNumberOfPrimes(int sizeOfPrimes);
+
+private:
+    std::string cacheFilepath;
+    std::string keyFilepath;
+    std::vector<int> primeSizes;
+    int depth;
+    int refillThreshold;
+    unsigned int numberOfWorkers;
+    std::map<int, std::vector<std::string>> primes;
+    std::map<int, int> primesInProgress;
+    std::map<int, bool> refilling;
+    std::vector<PrimeSearch*> activeSearches;
+    std::vector<std::thread> workers;
+    std::mutex poolMutex;
+    std::condition_variable refillNeeded;
+    bool stopping;
+    bool ownsCache;
+#ifdef _WIN32
+    void *cacheLock;
+#else
+    int cacheLock;
+#endif
+
+    void refillWorker();
+    int chooseSizeToRefill();
+    void updateRefillState(int sizeOfPrimes);
+    bool lockCache();
+    void unlockCache();
+    void loadCache();
+    bool saveCache();
+    std::string loadCacheKey(bool createIfMissing);
+    static bool writePrivateFile(const std::string &filepath, const std::string &contents);
+    static bool replaceFile(const std::string &temporaryFilepath, const std::string &filepath);
+};
+
+#endif // PRIMEPOOL_H
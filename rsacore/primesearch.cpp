@@ -0,0 +1,361 @@
+#include "primesearch.h"
+#include <gmpxx.h>
+
+#include <thread>
+#include <vector>
+#include <cryptopp/osrng.h>
+#include <cryptopp/nbtheory.h>
+
+static unsigned int MAX_SIEVE_PRIMES = 2048; // The number of small primes the candidates are sieved by.
+static unsigned long MAX_SIEVE_DISTANCE = 1 << 16; // How far past a random start the sieve steps before picking a new start.
+
+PrimeSearch::PrimeSearch(int sizeOfPrimes, int numberOfChecks, unsigned int numberOfThreads, bool useLucasTest, JobProgress *progress,
+                         unsigned long publicExponent){
+/***********************************************************************
+* Constructor for the PrimeSearch class, which searches for random primes
+* of a given size using every core of the machine.
+*
+* Arguments:
+* @ sizeOfPrimes: The size of the primes to search for in bits.
+* @ numberOfChecks: The number of Miller-Rabin rounds with random witnesses a candidate has to pass.
+* @ numberOfThreads: The number of worker threads to use, 0 uses one per core.
+* @ useLucasTest: Whether the candidates which pass the Miller-Rabin rounds also have to pass a strong Lucas test.
+* @ progress: Counts every candidate tested and is advanced for every prime found, or nullptr. Cancelling
+*             it cancels the search, the same as cancel().
+* @ publicExponent: The public exponent (e) of the keys the primes are for, primes with prime mod e == 1 are skipped
+*                   as e has no inverse mod (prime - 1) for them. 0 accepts every prime.
+***********************************************************************/
+    // The first entry of CryptoPP's table is 2, which is skipped as every candidate is odd.
+    unsigned int primeTableSize = 0;
+    const CryptoPP::word16 *primeTable = CryptoPP::GetPrimeTable(primeTableSize);
+    this->sievePrimes = primeTable + 1;
+    this->numberOfSievePrimes = (primeTableSize - 1 < MAX_SIEVE_PRIMES) ? primeTableSize - 1 : MAX_SIEVE_PRIMES;
+
+    this->sizeOfPrimes = sizeOfPrimes;
+    this->numberOfChecks = numberOfChecks;
+    this->useLucasTest = useLucasTest;
+    this->publicExponent = publicExponent;
+    this->statistics = primalityStatistics();
+    this->candidatesSieved = 0;
+    this->cancelled = false;
+    this->progress = progress;
+    this->activeTargets = nullptr;
+    this->numberOfActiveTargets = 0;
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 when the number of cores cannot be worked out.
+    this->numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+}
+
+bool PrimeSearch::findPrime(mpz_t prime){
+/***********************************************************************
+* Searches for a single prime number on all of the worker threads.
+* The first worker to find a prime stores it, and the other workers stop.
+*
+* Arguments:
+* @ prime: The initialised multiprecision variable which the prime is written to.
+*
+* Returns:
+*  True: If a prime has been found.
+*  False: If the search was cancelled before a prime was found.
+***********************************************************************/
+    SearchTarget targets[1];
+    targets[0].found = false;
+    targets[0].result = prime;
+    return PrimeSearch::runWorkers(targets, 1);
+}
+
+bool PrimeSearch::findPrimePair(mpz_t prime1, mpz_t prime2){
+/***********************************************************************
+* Searches for two different prime numbers at the same time.
+* The workers are split evenly between the two primes. Once one of the primes
+* has been found, the workers that were searching for it move over to the other one.
+*
+* Arguments:
+* @ prime1: The initialised multiprecision variable which the first prime is written to.
+* @ prime2: The initialised multiprecision variable which the second prime is written to.
+*
+* Returns:
+*  True: If both primes have been found.
+*  False: If the search was cancelled before both primes were found.
+***********************************************************************/
+    SearchTarget targets[2];
+    targets[0].found = false;
+    targets[0].result = prime1;
+    targets[1].found = false;
+    targets[1].result = prime2;
+    return PrimeSearch::runWorkers(targets, 2);
+}
+
+void PrimeSearch::cancel(){
+/***********************************************************************
+* Stops the search which is running (or the next one to start) from another thread.
+* Every target is marked as found, which stops the workers the same way as when
+* a prime has been found, including in the middle of the primality checks.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(resultMutex);
+    cancelled = true;
+    for(int i = 0; i < numberOfActiveTargets; i++){
+        activeTargets[i].found = true;
+    }
+}
+
+bool PrimeSearch::runWorkers(SearchTarget *targets, int numberOfTargets){
+/***********************************************************************
+* Starts the worker threads and waits for all of them to finish, which happens
+* once every target has been found or the search has been cancelled.
+*
+* Arguments:
+* @ targets: The array of primes that are being searched for.
+* @ numberOfTargets: The number of primes in the targets array.
+*
+* Returns:
+*  True: If every target has been found.
+*  False: If the search was cancelled.
+***********************************************************************/
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if(cancelled == true){
+            return false;
+        }
+        activeTargets = targets;
+        numberOfActiveTargets = numberOfTargets;
+    }
+
+    std::vector<std::thread> workers;
+    for(unsigned int i = 0; i < numberOfThreads; i++){
+        workers.emplace_back(&PrimeSearch::searchWorker, this, targets, numberOfTargets, i % numberOfTargets);
+    }
+    for(unsigned int i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    activeTargets = nullptr;
+    numberOfActiveTargets = 0;
+    return cancelled == false;
+}
+
+void PrimeSearch::searchWorker(SearchTarget *targets, int numberOfTargets, int firstTarget){
+/***********************************************************************
+* The function that each worker thread runs. Each worker has its own random
+* number generator, so no state is shared between the threads apart from the targets.
+* The worker keeps sieving from random starting points for a target that has not been
+* found yet, and returns once all of the targets have been found.
+*
+* Arguments:
+* @ targets: The array of primes that are being searched for.
+* @ numberOfTargets: The number of primes in the targets array.
+* @ firstTarget: The index of the target this worker starts searching for.
+***********************************************************************/
+    CryptoPP::AutoSeededRandomPool randomPool;
+    PrimalityTester primalityTester(useLucasTest);
+    unsigned long long sieved = 0;
+
+    // Seed the witness generator from the operating system's random pool.
+    unsigned char seedBuffer[32];
+    randomPool.GenerateBlock(seedBuffer, sizeof(seedBuffer));
+    mpz_t seed; mpz_init(seed);
+    mpz_import(seed, sizeof(seedBuffer), 1, 1, 0, 0, seedBuffer);
+    primalityTester.seed(seed);
+    mpz_clear(seed);
+
+    mpz_t candidate; mpz_init(candidate);
+    mpz_t startNumber; mpz_init(startNumber);
+    int currentTarget = firstTarget;
+    while(true){
+        // Pick the next target which hasn't been found yet, starting with the current one.
+        int chosenTarget = -1;
+        for(int i = 0; i < numberOfTargets; i++){
+            int targetIndex = (currentTarget + i) % numberOfTargets;
+            if(targets[targetIndex].found == false){
+                chosenTarget = targetIndex;
+                break;
+            }
+        }
+        if(chosenTarget == -1){
+            break;
+        }
+        currentTarget = chosenTarget;
+
+        PrimeSearch::generateRandomNumber(startNumber, randomPool);
+        if(PrimeSearch::sieveSearch(candidate, startNumber, primalityTester, targets[currentTarget].found, sieved) == true){
+            PrimeSearch::acceptPrime(targets, numberOfTargets, currentTarget, candidate);
+        }
+    }
+
+    mpz_clear(candidate);
+    mpz_clear(startNumber);
+    PrimeSearch::addStatistics(primalityTester.getStatistics(), sieved);
+}
+
+bool PrimeSearch::acceptPrime(SearchTarget *targets, int numberOfTargets, int targetIndex, mpz_t prime){
+/***********************************************************************
+* Stores a prime which a worker has found, unless another worker has already
+* found this target, or the prime is the same as one found for another target.
+* Setting the found flag cancels the other workers searching for this target.
+*
+* Arguments:
+* @ targets: The array of primes that are being searched for.
+* @ numberOfTargets: The number of primes in the targets array.
+* @ targetIndex: The index of the target the prime was found for.
+* @ prime: The prime number which has been found.
+*
+* Returns:
+*  True: If the prime has been stored.
+*  False: If the prime has been thrown away.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(resultMutex);
+    if(targets[targetIndex].found == true){
+        return false;
+    }
+    for(int i = 0; i < numberOfTargets; i++){
+        if(i != targetIndex && targets[i].found == true && mpz_cmp(targets[i].result, prime) == 0){
+            return false;
+        }
+    }
+    mpz_set(targets[targetIndex].result, prime);
+    targets[targetIndex].found = true;
+    if(progress != nullptr){
+        progress->advance(1);
+    }
+    return true;
+}
+
+void PrimeSearch::generateRandomNumber(mpz_t number, CryptoPP::AutoSeededRandomPool &randomPool){
+/***********************************************************************
+* Randomly generates a number which is sizeOfPrimes bits long.
+* This function also guarantees the number it returns is odd as this is a criteria
+* for prime numbers > 2.
+*
+* Arguments:
+* @ number: The initialised multiprecision variable which the random number is written to.
+* @ randomPool: The worker's random number generator.
+***********************************************************************/
+    int bufferSize = sizeOfPrimes / 8;
+    std::vector<unsigned char> hexArray(bufferSize);
+    randomPool.GenerateBlock(hexArray.data(), bufferSize);
+    // Applys a bitwise or operation to ensure the 2 most significant bits are 1's.
+    // Without this there is a chance the number it generates could be small.
+    hexArray[0] |= 0xC0;
+    // bitwise or operator to the last bit in the array to ensure odd.
+    hexArray[bufferSize - 1] |= 0x01;
+    mpz_import(number, bufferSize, 1, sizeof(hexArray[0]), 0, 0, hexArray.data());
+}
+
+bool PrimeSearch::sieveSearch(mpz_t candidate, mpz_t startNumber, PrimalityTester &primalityTester, const std::atomic<bool> &cancelled, unsigned long long &sieved){
+/***********************************************************************
+* Searches upwards from a random odd starting number using an incremental sieve.
+* The remainder of the starting number is worked out once for each of the small sieve
+* primes. Stepping to the next odd number only needs each remainder to be increased
+* by 2, so a candidate which has a small factor is thrown away without any modular
+* exponentiation. Only the candidates which survive the sieve are passed to
+* the primalityTester.
+* If no prime is found within MAX_SIEVE_DISTANCE of the start, the function returns
+* so that the worker can pick a new random starting number.
+*
+* Arguments:
+* @ candidate: The initialised multiprecision variable which the prime is written to.
+* @ startNumber: The random odd number which the search starts from.
+* @ primalityTester: The worker's primality tester, which is reused for every candidate.
+* @ cancelled: A flag which is set once another worker has found a prime for this target.
+*              A cancelled JobProgress is checked at every step too, and cancels the whole search.
+* @ sieved: The worker's count of numbers which have been through the sieve.
+*
+* Returns:
+*  True: If candidate contains a number which has passed the sieve and the primality checks.
+*  False: If no prime was found, or the search has been cancelled.
+***********************************************************************/
+    std::vector<unsigned int> residues(numberOfSievePrimes);
+    PrimeSearch::calculateResidues(startNumber, residues);
+
+    for(unsigned long distance = 0; distance < MAX_SIEVE_DISTANCE; distance += 2){
+        if(cancelled == true){
+            return false;
+        }
+        if(progress != nullptr && progress->isCancelled() == true){
+            PrimeSearch::cancel();
+            return false;
+        }
+        sieved++;
+        bool passedSieve = true;
+        for(unsigned int i = 0; i < numberOfSievePrimes; i++){
+            if(residues[i] == 0){
+                passedSieve = false;
+            }
+            // Move the remainder on to the next odd number (startNumber + distance + 2).
+            residues[i] += 2;
+            if(residues[i] >= sievePrimes[i]){
+                residues[i] -= sievePrimes[i];
+            }
+        }
+        if(passedSieve == false){
+            continue;
+        }
+        mpz_add_ui(candidate, startNumber, distance);
+        if(mpz_sizeinbase(candidate, 2) > static_cast<size_t>(sizeOfPrimes)){
+            // Stepped past the largest number of the requested size.
+            return false;
+        }
+        // The key's private exponent would not exist, so the candidate isn't worth testing.
+        if(publicExponent > 1 && mpz_fdiv_ui(candidate, publicExponent) == 1){
+            continue;
+        }
+        if(progress != nullptr){
+            progress->countCandidate();
+        }
+        if(primalityTester.isProbablePrime(candidate, numberOfChecks, &cancelled) == true){
+            return true;
+        }
+    }
+    return false;
+}
+
+void PrimeSearch::calculateResidues(mpz_t number, std::vector<unsigned int> &residues){
+/***********************************************************************
+* Works out the remainder of number divided by each of the small sieve primes.
+*
+* Arguments:
+* @ number: The number which is being divided.
+* @ residues: The vector which each remainder is written to, in the same order as sievePrimes.
+***********************************************************************/
+    for(unsigned int i = 0; i < numberOfSievePrimes; i++){
+        residues[i] = mpz_fdiv_ui(number, sievePrimes[i]);
+    }
+}
+
+void PrimeSearch::addStatistics(const primalityStatistics &workerStatistics, unsigned long long workerSieved){
+/***********************************************************************
+* Adds the counts from a worker which has finished onto the totals for this search.
+*
+* Arguments:
+* @ workerStatistics: The statistics from the worker's primality tester.
+* @ workerSieved: The number of numbers the worker put through the sieve.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(resultMutex);
+    statistics.candidatesTested += workerStatistics.candidatesTested;
+    statistics.modularExponentiations += workerStatistics.modularExponentiations;
+    statistics.lucasTests += workerStatistics.lucasTests;
+    statistics.primesAccepted += workerStatistics.primesAccepted;
+    candidatesSieved += workerSieved;
+}
+
+primalityStatistics PrimeSearch::getStatistics(){
+/***********************************************************************
+* Returns:
+*  statistics: The totals from every worker's primality tester, for all of the searches
+*              this PrimeSearch has run.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return statistics;
+}
+
+unsigned long long PrimeSearch::getCandidatesSieved(){
+/***********************************************************************
+* Returns:
+*  candidatesSieved: The number of odd numbers which have been put through the sieve.
+***********************************************************************/
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return candidatesSieved;
+}
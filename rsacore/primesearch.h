@@ -0,0 +1,54 @@
+#ifndef PRIMESEARCH_H
+#define PRIMESEARCH_H
+
+#include "primalitytester.h"
+#include "jobprogress.h"
+#include <gmpxx.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cryptopp/osrng.h>
+#include <cryptopp/nbtheory.h>
+
+class PrimeSearch
+{
+public:
+    explicit PrimeSearch(int sizeOfPrimes, int numberOfChecks = 25, unsigned int numberOfThreads = 0, bool useLucasTest = true,
+                         JobProgress *progress = nullptr, unsigned long publicExponent = 65537);
+    bool findPrime(mpz_t prime);
+    bool findPrimePair(mpz_t prime1, mpz_t prime2);
+    void cancel();
+    primalityStatistics getStatistics();
+    unsigned long long getCandidatesSieved();
+
+private:
+    struct SearchTarget{
+        std::atomic<bool> found;
+        mpz_ptr result;
+    };
+
+    int sizeOfPrimes;
+    int numberOfChecks;
+    unsigned int numberOfThreads;
+    bool useLucasTest;
+    unsigned long publicExponent;
+    std::mutex resultMutex;
+    std::atomic<bool> cancelled;
+    JobProgress *progress;
+    SearchTarget *activeTargets;
+    int numberOfActiveTargets;
+    primalityStatistics statistics;
+    unsigned long long candidatesSieved;
+    const CryptoPP::word16 *sievePrimes;
+    unsigned int numberOfSievePrimes;
+
+    bool runWorkers(SearchTarget *targets, int numberOfTargets);
+    void searchWorker(SearchTarget *targets, int numberOfTargets, int firstTarget);
+    bool acceptPrime(SearchTarget *targets, int numberOfTargets, int targetIndex, mpz_t prime);
+    void generateRandomNumber(mpz_t number, CryptoPP::AutoSeededRandomPool &randomPool);
+    bool sieveSearch(mpz_t candidate, mpz_t startNumber, PrimalityTester &primalityTester, const std::atomic<bool> &cancelled, unsigned long long &sieved);
+    void calculateResidues(mpz_t number, std::vector<unsigned int> &residues);
+    void addStatistics(const primalityStatistics &workerStatistics, unsigned long long workerSieved);
+};
+
+#endif // PRIMESEARCH_H
@@ -0,0 +1,255 @@
+QT -= gui core
+
+TEMPLATE = lib
+CONFIG += c++11 staticlib
+TARGET = rsacore
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+DEFINES += STATIC
+
+# The RSA logic, with no Qt dependency, shared by the GUI and the benchmark.
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    ciphertextcontainer.cpp \
+    decryptionengine.cpp \
+    decryptionstream.cpp \
+    encryptionengine.cpp \
+    encryptionstream.cpp \
+    exponentiationcontext.cpp \
+    filedecryptor.cpp \
+    fileencryptor.cpp \
+    hybridengine.cpp \
+    integerbridge.cpp \
+    jobprogress.cpp \
+    keyfile.cpp \
+    keygenerator.cpp \
+    montgomerycontext.cpp \
+    multibuffermodexp.cpp \
+    primalitytester.cpp \
+    primepool.cpp \
+    primesearch.cpp \
+    workscheduler.cpp
+
+HEADERS += \
+    boundedqueue.h \
+    ../includes/base64.h \
+    ../cryptopp/3way.h \
+    ../cryptopp/adler32.h \
+    ../cryptopp/adv_simd.h \
+    ../cryptopp/aes.h \
+    ../cryptopp/aes_armv4.h \
+    ../cryptopp/algebra.h \
+    ../cryptopp/algparam.h \
+    ../cryptopp/allocate.h \
+    ../cryptopp/arc4.h \
+    ../cryptopp/argnames.h \
+    ../cryptopp/aria.h \
+    ../cryptopp/arm_simd.h \
+    ../cryptopp/asn.h \
+    ../cryptopp/authenc.h \
+    ../cryptopp/base32.h \
+    ../cryptopp/base64.h \
+    ../cryptopp/basecode.h \
+    ../cryptopp/bench.h \
+    ../cryptopp/blake2.h \
+    ../cryptopp/blowfish.h \
+    ../cryptopp/blumshub.h \
+    ../cryptopp/camellia.h \
+    ../cryptopp/cast.h \
+    ../cryptopp/cbcmac.h \
+    ../cryptopp/ccm.h \
+    ../cryptopp/chacha.h \
+    ../cryptopp/chachapoly.h \
+    ../cryptopp/cham.h \
+    ../cryptopp/channels.h \
+    ../cryptopp/cmac.h \
+    ../cryptopp/config.h \
+    ../cryptopp/config_align.h \
+    ../cryptopp/config_asm.h \
+    ../cryptopp/config_cpu.h \
+    ../cryptopp/config_cxx.h \
+    ../cryptopp/config_dll.h \
+    ../cryptopp/config_int.h \
+    ../cryptopp/config_misc.h \
+    ../cryptopp/config_ns.h \
+    ../cryptopp/config_os.h \
+    ../cryptopp/config_ver.h \
+    ../cryptopp/cpu.h \
+    ../cryptopp/crc.h \
+    ../cryptopp/cryptlib.h \
+    ../cryptopp/darn.h \
+    ../cryptopp/default.h \
+    ../cryptopp/des.h \
+    ../cryptopp/dh.h \
+    ../cryptopp/dh2.h \
+    ../cryptopp/dll.h \
+    ../cryptopp/dmac.h \
+    ../cryptopp/donna.h \
+    ../cryptopp/donna_32.h \
+    ../cryptopp/donna_64.h \
+    ../cryptopp/donna_sse.h \
+    ../cryptopp/drbg.h \
+    ../cryptopp/dsa.h \
+    ../cryptopp/eax.h \
+    ../cryptopp/ec2n.h \
+    ../cryptopp/eccrypto.h \
+    ../cryptopp/ecp.h \
+    ../cryptopp/ecpoint.h \
+    ../cryptopp/elgamal.h \
+    ../cryptopp/emsa2.h \
+    ../cryptopp/eprecomp.h \
+    ../cryptopp/esign.h \
+    ../cryptopp/factory.h \
+    ../cryptopp/fhmqv.h \
+    ../cryptopp/files.h \
+    ../cryptopp/filters.h \
+    ../cryptopp/fips140.h \
+    ../cryptopp/fltrimpl.h \
+    ../cryptopp/gcm.h \
+    ../cryptopp/gf256.h \
+    ../cryptopp/gf2_32.h \
+    ../cryptopp/gf2n.h \
+    ../cryptopp/gfpcrypt.h \
+    ../cryptopp/gost.h \
+    ../cryptopp/gzip.h \
+    ../cryptopp/hashfwd.h \
+    ../cryptopp/hc128.h \
+    ../cryptopp/hc256.h \
+    ../cryptopp/hex.h \
+    ../cryptopp/hight.h \
+    ../cryptopp/hkdf.h \
+    ../cryptopp/hmac.h \
+    ../cryptopp/hmqv.h \
+    ../cryptopp/hrtimer.h \
+    ../cryptopp/ida.h \
+    ../cryptopp/idea.h \
+    ../cryptopp/integer.h \
+    ../cryptopp/iterhash.h \
+    ../cryptopp/kalyna.h \
+    ../cryptopp/keccak.h \
+    ../cryptopp/lea.h \
+    ../cryptopp/lsh.h \
+    ../cryptopp/lubyrack.h \
+    ../cryptopp/luc.h \
+    ../cryptopp/mars.h \
+    ../cryptopp/md2.h \
+    ../cryptopp/md4.h \
+    ../cryptopp/md5.h \
+    ../cryptopp/mdc.h \
+    ../cryptopp/mersenne.h \
+    ../cryptopp/misc.h \
+    ../cryptopp/modarith.h \
+    ../cryptopp/modes.h \
+    ../cryptopp/modexppc.h \
+    ../cryptopp/mqueue.h \
+    ../cryptopp/mqv.h \
+    ../cryptopp/naclite.h \
+    ../cryptopp/nbtheory.h \
+    ../cryptopp/nr.h \
+    ../cryptopp/oaep.h \
+    ../cryptopp/oids.h \
+    ../cryptopp/osrng.h \
+    ../cryptopp/ossig.h \
+    ../cryptopp/padlkrng.h \
+    ../cryptopp/panama.h \
+    ../cryptopp/pch.h \
+    ../cryptopp/pem.h \
+    ../cryptopp/pem_common.h \
+    ../cryptopp/pkcspad.h \
+    ../cryptopp/poly1305.h \
+    ../cryptopp/polynomi.h \
+    ../cryptopp/ppc_simd.h \
+    ../cryptopp/pssr.h \
+    ../cryptopp/pubkey.h \
+    ../cryptopp/pwdbased.h \
+    ../cryptopp/queue.h \
+    ../cryptopp/rabbit.h \
+    ../cryptopp/rabin.h \
+    ../cryptopp/randpool.h \
+    ../cryptopp/rc2.h \
+    ../cryptopp/rc5.h \
+    ../cryptopp/rc6.h \
+    ../cryptopp/rdrand.h \
+    ../cryptopp/resource.h \
+    ../cryptopp/rijndael.h \
+    ../cryptopp/ripemd.h \
+    ../cryptopp/rng.h \
+    ../cryptopp/rsa.h \
+    ../cryptopp/rw.h \
+    ../cryptopp/safer.h \
+    ../cryptopp/salsa.h \
+    ../cryptopp/scrypt.h \
+    ../cryptopp/seal.h \
+    ../cryptopp/secblock.h \
+    ../cryptopp/secblockfwd.h \
+    ../cryptopp/seckey.h \
+    ../cryptopp/seed.h \
+    ../cryptopp/serpent.h \
+    ../cryptopp/serpentp.h \
+    ../cryptopp/sha.h \
+    ../cryptopp/sha1_armv4.h \
+    ../cryptopp/sha256_armv4.h \
+    ../cryptopp/sha3.h \
+    ../cryptopp/sha512_armv4.h \
+    ../cryptopp/shacal2.h \
+    ../cryptopp/shake.h \
+    ../cryptopp/shark.h \
+    ../cryptopp/simeck.h \
+    ../cryptopp/simon.h \
+    ../cryptopp/simple.h \
+    ../cryptopp/siphash.h \
+    ../cryptopp/skipjack.h \
+    ../cryptopp/sm3.h \
+    ../cryptopp/sm4.h \
+    ../cryptopp/smartptr.h \
+    ../cryptopp/sosemanuk.h \
+    ../cryptopp/speck.h \
+    ../cryptopp/square.h \
+    ../cryptopp/stdcpp.h \
+    ../cryptopp/strciphr.h \
+    ../cryptopp/tea.h \
+    ../cryptopp/threefish.h \
+    ../cryptopp/tiger.h \
+    ../cryptopp/trap.h \
+    ../cryptopp/trunhash.h \
+    ../cryptopp/ttmac.h \
+    ../cryptopp/tweetnacl.h \
+    ../cryptopp/twofish.h \
+    ../cryptopp/validate.h \
+    ../cryptopp/vmac.h \
+    ../cryptopp/wake.h \
+    ../cryptopp/whrlpool.h \
+    ../cryptopp/words.h \
+    ../cryptopp/x509cert.h \
+    ../cryptopp/xed25519.h \
+    ../cryptopp/xtr.h \
+    ../cryptopp/xtrcrypt.h \
+    ../cryptopp/xts.h \
+    ../cryptopp/zdeflate.h \
+    ../cryptopp/zinflate.h \
+    ../cryptopp/zlib.h \
+    ciphertextcontainer.h \
+    decryptionengine.h \
+    decryptionstream.h \
+    encryptionengine.h \
+    encryptionstream.h \
+    exponentiationcontext.h \
+    filedecryptor.h \
+    fileencryptor.h \
+    hybridengine.h \
+    integerbridge.h \
+    jobprogress.h \
+    keyfile.h \
+    keygenerator.h \
+    montgomerycontext.h \
+    multibuffermodexp.h \
+    primalitytester.h \
+    primepool.h \
+    primesearch.h \
+    workscheduler.h
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs
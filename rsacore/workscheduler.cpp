@@ -0,0 +1,142 @@
+#include "workscheduler.h"
+
+#include <algorithm>
+
+WorkScheduler::WorkScheduler(unsigned int numberOfThreads){
+/***********************************************************************
+* Constructor for the WorkScheduler class, a set of helper threads shared by every file
+* which is being encrypted or decrypted at the same time.
+* The engines share each chunk out between workers which keep taking the next range of
+* blocks (or hybrid chunks) until there are none left. Instead of starting new threads for
+* every chunk, they post their worker here, and whichever helper threads are idle join in,
+* whichever file the work came from. A helper which finishes one file's ranges goes straight
+* on to the next file's, so a queue of small files never leaves cores idle while a big
+* file is running, and no threads are started or stopped per file.
+*
+* Arguments:
+* @ numberOfThreads: The number of helper threads, 0 uses one per core.
+***********************************************************************/
+    if(numberOfThreads == 0){
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 when the number of cores cannot be worked out.
+    numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+    this->stopping = false;
+    for(unsigned int i = 0; i < numberOfThreads; i++){
+        threads.emplace_back(&WorkScheduler::helperThread, this);
+    }
+}
+
+WorkScheduler::~WorkScheduler(){
+/***********************************************************************
+* Destructor for the WorkScheduler class. Stops the helper threads once they have
+* finished what they are working on, nothing can be running in it by then.
+***********************************************************************/
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        stopping = true;
+    }
+    workPosted.notify_all();
+    for(unsigned int i = 0; i < threads.size(); i++){
+        threads[i].join();
+    }
+}
+
+unsigned int WorkScheduler::getNumberOfThreads() const{
+/***********************************************************************
+* Returns:
+*  numberOfThreads: The number of helper threads.
+***********************************************************************/
+    return static_cast<unsigned int>(threads.size());
+}
+
+void WorkScheduler::run(unsigned int numberOfWorkers, const std::function<void()> &worker){
+/***********************************************************************
+* Runs the worker on the calling thread, and on up to (numberOfWorkers - 1) helper threads
+* as they become free. The worker must take its work from something shared (such as the
+* next range of blocks) and return once there is none left, so it does not matter how
+* many helpers join in or when.
+* Once the calling thread's worker has returned, no more helpers can join, and this waits
+* for the ones which did join to return.
+* The posted work is kept in a queue which the helpers take turns from, so every file
+* running at the same time gets its share of the helpers.
+*
+* Arguments:
+* @ numberOfWorkers: The most workers the work can be shared between, including the calling thread.
+* @ worker: The function every worker runs.
+***********************************************************************/
+    if(numberOfWorkers <= 1){
+        worker();
+        return;
+    }
+    PostedWork work;
+    work.worker = &worker;
+    work.helpersWanted = numberOfWorkers - 1;
+    work.helpersRunning = 0;
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        postedWork.push_back(&work);
+    }
+    workPosted.notify_all();
+
+    // The calling thread does its share of the work too, rather than waiting.
+    worker();
+
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    postedWork.erase(std::remove(postedWork.begin(), postedWork.end(), &work), postedWork.end());
+    helperFinished.wait(lock, [&work]{ return work.helpersRunning == 0; });
+}
+
+void WorkScheduler::runWorkers(WorkScheduler *scheduler, unsigned int numberOfWorkers, const std::function<void()> &worker){
+/***********************************************************************
+* Runs the worker on numberOfWorkers threads, through the scheduler if there is one.
+* Without one, (numberOfWorkers - 1) threads are started for it and joined afterwards,
+* and the calling thread works as well.
+*
+* Arguments:
+* @ scheduler: The WorkScheduler to run the worker on, or nullptr.
+* @ numberOfWorkers: The most workers the work can be shared between, including the calling thread.
+* @ worker: The function every worker runs.
+***********************************************************************/
+    if(scheduler != nullptr){
+        scheduler->run(numberOfWorkers, worker);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < numberOfWorkers; i++){
+        workers.emplace_back(worker);
+    }
+    worker();
+    for(unsigned int i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+}
+
+void WorkScheduler::helperThread(){
+/***********************************************************************
+* The function each helper thread runs. It waits for work to be posted, takes the work
+* at the front of the queue and puts it to the back if it still wants more helpers,
+* so the helpers are shared out between everything which is running.
+***********************************************************************/
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    while(true){
+        workPosted.wait(lock, [this]{ return stopping == true || postedWork.empty() == false; });
+        if(stopping == true){
+            return;
+        }
+        PostedWork *work = postedWork.front();
+        postedWork.pop_front();
+        work->helpersWanted--;
+        work->helpersRunning++;
+        if(work->helpersWanted > 0){
+            postedWork.push_back(work);
+        }
+        lock.unlock();
+        (*work->worker)();
+        lock.lock();
+        work->helpersRunning--;
+        if(work->helpersRunning == 0){
+            helperFinished.notify_all();
+        }
+    }
+}
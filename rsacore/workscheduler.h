@@ -0,0 +1,39 @@
+#ifndef WORKSCHEDULER_H
+#define WORKSCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkScheduler
+{
+public:
+    explicit WorkScheduler(unsigned int numberOfThreads = 0);
+    ~WorkScheduler();
+    WorkScheduler(const WorkScheduler &) = delete;
+    WorkScheduler &operator=(const WorkScheduler &) = delete;
+    void run(unsigned int numberOfWorkers, const std::function<void()> &worker);
+    unsigned int getNumberOfThreads() const;
+    static void runWorkers(WorkScheduler *scheduler, unsigned int numberOfWorkers, const std::function<void()> &worker);
+
+private:
+    struct PostedWork{
+        const std::function<void()> *worker;
+        unsigned int helpersWanted;
+        unsigned int helpersRunning;
+    };
+
+    std::vector<std::thread> threads;
+    std::deque<PostedWork*> postedWork;
+    std::mutex schedulerMutex;
+    std::condition_variable workPosted;
+    std::condition_variable helperFinished;
+    bool stopping;
+
+    void helperThread();
+};
+
+#endif // WORKSCHEDULER_H
@@ -0,0 +1,750 @@
+#include "coretests.h"
+#include "primesearch.h"
+#include "primepool.h"
+#include "primalitytester.h"
+#include "ciphertextcontainer.h"
+#include "encryptionengine.h"
+#include "decryptionengine.h"
+#include "encryptionstream.h"
+#include "decryptionstream.h"
+#include "hybridengine.h"
+#include "exponentiationcontext.h"
+#include "multibuffermodexp.h"
+#include <gmpxx.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+static const int SEARCH_PRIME_SIZE = 256; // The size of the primes the PrimeSearch is checked with, small so that they are found quickly.
+static const int KERNEL_MODULUS_SIZES[] = {512, 1024, 2048, 3072}; // The sizes of the moduli the kernels are checked with, in bits.
+static const int TEST_KEY_SIZE = 1024; // The size of the keys the containers are made with, in bits.
+static const int POOL_PRIME_SIZE = 256; // The size of the primes kept in the test PrimePool, small so that it fills quickly.
+static const char POOL_CACHE_FILEPATH[] = "coretests_primepool.cache"; // The test PrimePool's cache, in the working folder.
+
+int CoreTests::primeSearch(std::ostream &output){
+/***********************************************************************
+* Checks that the PrimeSearch finds two different primes of the requested size, and never
+* finds a prime with prime mod e == 1, as e would have no inverse mod (prime - 1) for it.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    mpz_class prime1;
+    mpz_class prime2;
+    PrimeSearch primeSearch(SEARCH_PRIME_SIZE);
+    primeSearch.findPrimePair(prime1.get_mpz_t(), prime2.get_mpz_t());
+    failures += CoreTests::check(output, "prime search pair",
+                                 prime1 != prime2 && mpz_sizeinbase(prime1.get_mpz_t(), 2) == SEARCH_PRIME_SIZE
+                                 && mpz_sizeinbase(prime2.get_mpz_t(), 2) == SEARCH_PRIME_SIZE
+                                 && mpz_probab_prime_p(prime1.get_mpz_t(), 25) != 0 && mpz_probab_prime_p(prime2.get_mpz_t(), 25) != 0);
+
+    // About half of all primes are 1 mod 3, so e = 3 shows whether they are skipped.
+    PrimeSearch exponentSearch(SEARCH_PRIME_SIZE, 25, 1, true, nullptr, 3);
+    bool usable = true;
+    for(int i = 0; i < 10; i++){
+        exponentSearch.findPrime(prime1.get_mpz_t());
+        usable = usable && mpz_fdiv_ui(prime1.get_mpz_t(), 3) == 2;
+    }
+    failures += CoreTests::check(output, "prime search only finds primes where prime mod e != 1", usable);
+    return failures;
+}
+
+int CoreTests::primePool(std::ostream &output){
+/***********************************************************************
+* Checks that the PrimePool hands out two different primes which can be used with the
+* public exponent, that the cache is rewritten before they are handed out so they never come
+* out of the pool again after a restart, that a second pool can't use a cache another pool
+* owns, that the cache and its key can only be read by their owner, and that primes with
+* prime mod e == 1 are never handed out.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    std::string cacheFilepath = POOL_CACHE_FILEPATH;
+    std::remove(cacheFilepath.c_str());
+    std::remove((cacheFilepath + ".key").c_str());
+    std::vector<int> primeSizes(1, POOL_PRIME_SIZE);
+    mpz_class prime1;
+    mpz_class prime2;
+    std::vector<mpz_class> takenPrimes;
+    {
+        // Depth 4 and threshold 2, so taking one pair leaves 2 primes and does not start a refill.
+        PrimePool primePool(cacheFilepath, primeSizes, 4, 2);
+        primePool.start();
+        if(CoreTests::check(output, "prime pool fills up", CoreTests::waitForPrimes(primePool, POOL_PRIME_SIZE, 4)) != 0){
+            return 1;
+        }
+        failures += CoreTests::check(output, "prime pool does not have other sizes",
+                                     primePool.takePrimePair(2 * POOL_PRIME_SIZE, 65537, prime1.get_mpz_t(), prime2.get_mpz_t()) == false);
+        std::string cacheBefore = CoreTests::readFile(cacheFilepath);
+        bool taken = primePool.takePrimePair(POOL_PRIME_SIZE, 65537, prime1.get_mpz_t(), prime2.get_mpz_t());
+        failures += CoreTests::check(output, "prime pool take",
+                                     taken == true && prime1 != prime2 && mpz_sizeinbase(prime1.get_mpz_t(), 2) == POOL_PRIME_SIZE
+                                     && mpz_probab_prime_p(prime1.get_mpz_t(), 25) != 0 && mpz_probab_prime_p(prime2.get_mpz_t(), 25) != 0
+                                     && mpz_fdiv_ui(prime1.get_mpz_t(), 65537) != 1 && mpz_fdiv_ui(prime2.get_mpz_t(), 65537) != 1);
+        failures += CoreTests::check(output, "prime pool saves the cache before handing out primes",
+                                     cacheBefore.empty() == false && CoreTests::readFile(cacheFilepath) != cacheBefore);
+        failures += CoreTests::check(output, "prime pool keeps the rest", primePool.getNumberOfPrimes(POOL_PRIME_SIZE) == 2);
+        takenPrimes.push_back(prime1);
+        takenPrimes.push_back(prime2);
+#ifndef _WIN32
+        struct stat cacheStatus;
+        struct stat keyStatus;
+        failures += CoreTests::check(output, "prime pool cache and key are private",
+                                     stat(cacheFilepath.c_str(), &cacheStatus) == 0 && (cacheStatus.st_mode & 0777) == 0600
+                                     && stat((cacheFilepath + ".key").c_str(), &keyStatus) == 0 && (keyStatus.st_mode & 0777) == 0600);
+#endif
+
+        // A second copy of the program can't own the cache, so it must never write to it.
+        std::string cacheOwned = CoreTests::readFile(cacheFilepath);
+        PrimePool secondPool(cacheFilepath, primeSizes, 4, 2);
+        secondPool.start();
+        bool secondTaken = CoreTests::waitForPrimes(secondPool, POOL_PRIME_SIZE, 4)
+                && secondPool.takePrimePair(POOL_PRIME_SIZE, 65537, prime1.get_mpz_t(), prime2.get_mpz_t());
+        secondPool.stop();
+        failures += CoreTests::check(output, "second prime pool leaves the owned cache alone",
+                                     secondTaken == true && CoreTests::readFile(cacheFilepath) == cacheOwned);
+        primePool.stop();
+    }
+    {
+        // The two primes left in the cache are loaded, the workers find the rest.
+        PrimePool primePool(cacheFilepath, primeSizes, 4, 2);
+        primePool.start();
+        failures += CoreTests::check(output, "prime pool loads the cache", primePool.getNumberOfPrimes(POOL_PRIME_SIZE) >= 2);
+        bool reused = false;
+        bool taken = CoreTests::waitForPrimes(primePool, POOL_PRIME_SIZE, 4);
+        for(int i = 0; i < 2 && taken == true; i++){
+            taken = primePool.takePrimePair(POOL_PRIME_SIZE, 65537, prime1.get_mpz_t(), prime2.get_mpz_t());
+            for(unsigned int j = 0; j < takenPrimes.size(); j++){
+                reused = reused || prime1 == takenPrimes[j] || prime2 == takenPrimes[j];
+            }
+        }
+        failures += CoreTests::check(output, "prime pool never hands out a prime twice after a restart", taken == true && reused == false);
+
+        // About half of all primes are 1 mod 3, so e = 3 makes the pool throw some away.
+        bool usable = true;
+        int pairsTaken = 0;
+        for(int i = 0; i < 200 && pairsTaken < 4; i++){
+            if(primePool.takePrimePair(POOL_PRIME_SIZE, 3, prime1.get_mpz_t(), prime2.get_mpz_t()) == true){
+                usable = usable && mpz_fdiv_ui(prime1.get_mpz_t(), 3) == 2 && mpz_fdiv_ui(prime2.get_mpz_t(), 3) == 2;
+                pairsTaken++;
+            }
+            else{
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+        failures += CoreTests::check(output, "prime pool only hands out primes where prime mod e != 1", pairsTaken == 4 && usable == true);
+        primePool.stop();
+    }
+    std::remove(cacheFilepath.c_str());
+    std::remove((cacheFilepath + ".key").c_str());
+    std::remove((cacheFilepath + ".lock").c_str());
+    return failures;
+}
+
+int CoreTests::ciphertextContainer(std::ostream &output){
+/***********************************************************************
+* Encrypts blocks into a CiphertextContainer with the EncryptionEngine and checks that the
+* header, the armour and the fixed width blocks all read back, that a short header, short
+* blocks or damaged armour are rejected, and that the '/' separated decimal blocks written
+* by older versions of the program still decrypt.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    testKey key;
+    CoreTests::generateKey(TEST_KEY_SIZE, key);
+    EncryptionEngine encryptionEngine(key.modulus.get_mpz_t(), key.publicExponent.get_mpz_t());
+    DecryptionEngine decryptionEngine(key.modulus.get_mpz_t(), key.privateExponent.get_mpz_t(), key.prime1.get_mpz_t(), key.prime2.get_mpz_t(),
+                                      key.exponent1.get_mpz_t(), key.exponent2.get_mpz_t(), key.coefficient.get_mpz_t());
+    size_t encryptedBlockSize = encryptionEngine.getEncryptedBlockSize();
+    size_t blockSize = encryptedBlockSize - 1;
+    std::string plaintext = CoreTests::randomBytes(7 * blockSize, 1);
+
+    ciphertextHeader header;
+    header.version = CiphertextContainer::BLOCK_VERSION;
+    header.keyFingerprint = CiphertextContainer::keyFingerprint(key.modulus.get_mpz_t(), key.publicExponent.get_mpz_t());
+    header.blockSize = static_cast<unsigned int>(blockSize);
+    header.encryptedBlockSize = static_cast<unsigned int>(encryptedBlockSize);
+    header.numberOfBlocks = 7;
+    std::string container = CiphertextContainer::writeHeader(header);
+    encryptionEngine.encryptBlocks(plaintext, blockSize, container);
+
+    ciphertextHeader readBack;
+    failures += CoreTests::check(output, "container header",
+                                 container.size() == CiphertextContainer::HEADER_SIZE + 7 * encryptedBlockSize
+                                 && CiphertextContainer::readHeader(container, readBack) == true && readBack.version == CiphertextContainer::BLOCK_VERSION
+                                 && readBack.keyFingerprint == header.keyFingerprint && readBack.blockSize == header.blockSize
+                                 && readBack.encryptedBlockSize == header.encryptedBlockSize && readBack.numberOfBlocks == 7);
+    failures += CoreTests::check(output, "container half a header",
+                                 CiphertextContainer::readHeader(container.substr(0, CiphertextContainer::HEADER_SIZE / 2), readBack) == false);
+    std::string decrypted;
+    failures += CoreTests::check(output, "container round trip",
+                                 decryptionEngine.decryptFixedBlocks(container, CiphertextContainer::HEADER_SIZE, 7, blockSize, decrypted) == true
+                                 && decrypted == plaintext);
+    decrypted.clear();
+    failures += CoreTests::check(output, "container missing a byte",
+                                 decryptionEngine.decryptFixedBlocks(container.substr(0, container.size() - 1), CiphertextContainer::HEADER_SIZE,
+                                                                     7, blockSize, decrypted) == false);
+
+    std::string armour = CiphertextContainer::addArmour(container);
+    std::string unarmoured;
+    failures += CoreTests::check(output, "container armour round trip",
+                                 CiphertextContainer::isArmoured(armour) == true && CiphertextContainer::removeArmour(armour, unarmoured) == true
+                                 && unarmoured == container);
+    size_t endLine = armour.rfind("-----END");
+    failures += CoreTests::check(output, "container armour without an end line",
+                                 endLine != std::string::npos && CiphertextContainer::removeArmour(armour.substr(0, endLine), unarmoured) == false);
+    std::string badCharacter = armour;
+    badCharacter[armour.find('\n') + 11] = '*';
+    failures += CoreTests::check(output, "container armour with a character which is not base64",
+                                 CiphertextContainer::removeArmour(badCharacter, unarmoured) == false);
+
+    // Older versions wrote each block as m^e mod n in decimal, followed by a '/'.
+    std::string legacyText = "Written by an older version.";
+    std::string legacyCiphertext;
+    mpz_class value;
+    for(size_t i = 0; i < legacyText.size(); i += 8){
+        std::string block = legacyText.substr(i, 8);
+        mpz_import(value.get_mpz_t(), block.size(), 1, 1, 0, 0, block.data());
+        mpz_powm(value.get_mpz_t(), value.get_mpz_t(), key.publicExponent.get_mpz_t(), key.modulus.get_mpz_t());
+        legacyCiphertext += value.get_str() + "/";
+    }
+    decrypted.clear();
+    failures += CoreTests::check(output, "container older decimal blocks",
+                                 decryptionEngine.decryptBlocks(legacyCiphertext, decrypted) == true && decrypted == legacyText);
+    return failures;
+}
+
+int CoreTests::encryptionStream(std::ostream &output){
+/***********************************************************************
+* Encrypts inputs which are empty, smaller than a chunk and larger than a chunk with the
+* EncryptionStream, and checks that the blocks in each container decrypt to the input followed
+* by the padding, that the armour holds the same container, and that an input which ends
+* before inputSize bytes is rejected.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    testKey key;
+    CoreTests::generateKey(TEST_KEY_SIZE, key);
+    EncryptionStream encryptionStream(key.modulus.get_mpz_t(), key.publicExponent.get_mpz_t());
+    DecryptionEngine decryptionEngine(key.modulus.get_mpz_t(), key.privateExponent.get_mpz_t(), key.prime1.get_mpz_t(), key.prime2.get_mpz_t(),
+                                      key.exponent1.get_mpz_t(), key.exponent2.get_mpz_t(), key.coefficient.get_mpz_t());
+    const size_t plaintextSizes[] = {0, 5000, (1 << 20) + 5000};
+    for(size_t plaintextSize : plaintextSizes){
+        std::string plaintext = CoreTests::randomBytes(plaintextSize, 3);
+        std::istringstream input(plaintext);
+        std::ostringstream containerStream;
+        bool encrypted = encryptionStream.encrypt(input, plaintext.size(), containerStream, false);
+        std::string container = containerStream.str();
+        ciphertextHeader header;
+        std::string decrypted;
+        bool decryptedBlocks = encrypted == true && CiphertextContainer::readHeader(container, header) == true
+                && container.size() == CiphertextContainer::HEADER_SIZE + header.numberOfBlocks * header.encryptedBlockSize
+                && decryptionEngine.decryptFixedBlocks(container, CiphertextContainer::HEADER_SIZE, header.numberOfBlocks,
+                                                       header.blockSize, decrypted) == true;
+        // The padding is a 0x80 byte and then zeros up to a whole number of blocks.
+        failures += CoreTests::check(output, "encryption stream of " + std::to_string(plaintextSize) + " bytes",
+                                     decryptedBlocks == true && decrypted.size() % header.blockSize == 0
+                                     && decrypted.compare(0, plaintext.size(), plaintext) == 0 && decrypted[plaintext.size()] == '\x80'
+                                     && decrypted.find_first_not_of('\0', plaintext.size() + 1) == std::string::npos);
+
+        std::istringstream armouredInput(plaintext);
+        std::ostringstream armourStream;
+        std::string unarmoured;
+        failures += CoreTests::check(output, "encryption stream of " + std::to_string(plaintextSize) + " bytes armoured",
+                                     encryptionStream.encrypt(armouredInput, plaintext.size(), armourStream, true) == true
+                                     && CiphertextContainer::removeArmour(armourStream.str(), unarmoured) == true && unarmoured == container);
+    }
+
+    std::istringstream shortInput(CoreTests::randomBytes(100, 4));
+    std::ostringstream containerStream;
+    failures += CoreTests::check(output, "encryption stream input shorter than its size",
+                                 encryptionStream.encrypt(shortInput, 200, containerStream, false) == false);
+    return failures;
+}
+
+int CoreTests::blockContainer(std::ostream &output){
+/***********************************************************************
+* Round trips a BLOCK_VERSION container, then checks that truncated containers, containers
+* whose header gives the wrong number of blocks and containers for a different key are all
+* rejected rather than decrypted into the wrong plaintext.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    testKey key;
+    testKey otherKey;
+    CoreTests::generateKey(TEST_KEY_SIZE, key);
+    CoreTests::generateKey(TEST_KEY_SIZE, otherKey);
+    std::string plaintext = CoreTests::randomBytes(5000, 1);
+    std::string container;
+    std::string decrypted;
+    if(CoreTests::check(output, "block container encrypt", CoreTests::encrypt(key, plaintext, false, 0, container)) != 0){
+        return 1;
+    }
+    failures += CoreTests::check(output, "block container round trip",
+                                 CoreTests::decrypt(key, container, decrypted) == true && decrypted == plaintext);
+    std::string empty;
+    failures += CoreTests::check(output, "block container empty round trip",
+                                 CoreTests::encrypt(key, "", false, 0, container) == true && CoreTests::decrypt(key, container, empty) == true
+                                 && empty.empty() == true);
+    CoreTests::encrypt(key, plaintext, false, 0, container);
+
+    size_t encryptedBlockSize = (mpz_sizeinbase(key.modulus.get_mpz_t(), 2) + 7) / 8;
+    failures += CoreTests::check(output, "block container missing a byte",
+                                 CoreTests::decrypt(key, container.substr(0, container.size() - 1), decrypted) == false);
+    failures += CoreTests::check(output, "block container missing the last block",
+                                 CoreTests::decrypt(key, container.substr(0, container.size() - encryptedBlockSize), decrypted) == false);
+    failures += CoreTests::check(output, "block container header only",
+                                 CoreTests::decrypt(key, container.substr(0, CiphertextContainer::HEADER_SIZE), decrypted) == false);
+    failures += CoreTests::check(output, "block container half a header",
+                                 CoreTests::decrypt(key, container.substr(0, CiphertextContainer::HEADER_SIZE / 2), decrypted) == false);
+    failures += CoreTests::check(output, "block container with an extra block",
+                                 CoreTests::decrypt(key, container + container.substr(CiphertextContainer::HEADER_SIZE, encryptedBlockSize),
+                                                    decrypted) == false);
+
+    // The number of blocks is the last 8 bytes of the header.
+    std::string moreBlocks = container;
+    moreBlocks[CiphertextContainer::HEADER_SIZE - 1]++;
+    failures += CoreTests::check(output, "block container counting too many blocks", CoreTests::decrypt(key, moreBlocks, decrypted) == false);
+    std::string fewerBlocks = container;
+    fewerBlocks[CiphertextContainer::HEADER_SIZE - 1]--;
+    failures += CoreTests::check(output, "block container counting too few blocks", CoreTests::decrypt(key, fewerBlocks, decrypted) == false);
+    std::string hugeCount = container;
+    hugeCount[CiphertextContainer::HEADER_SIZE - 8] = '\x7F';
+    failures += CoreTests::check(output, "block container counting 2^62 blocks", CoreTests::decrypt(key, hugeCount, decrypted) == false);
+
+    bool differentKey = false;
+    failures += CoreTests::check(output, "block container for a different key",
+                                 CoreTests::decrypt(otherKey, container, decrypted, &differentKey) == false && differentKey == true);
+    // The fingerprint starts at byte 8 of the header.
+    std::string wrongFingerprint = container;
+    wrongFingerprint[8] ^= 0x01;
+    differentKey = false;
+    failures += CoreTests::check(output, "block container with a changed fingerprint",
+                                 CoreTests::decrypt(key, wrongFingerprint, decrypted, &differentKey) == false && differentKey == true);
+
+    std::string changedBlock = container;
+    changedBlock[CiphertextContainer::HEADER_SIZE + encryptedBlockSize / 2] ^= 0x01;
+    failures += CoreTests::check(output, "block container with a changed block",
+                                 CoreTests::decrypt(key, changedBlock, decrypted) == false || decrypted != plaintext);
+    return failures;
+}
+
+int CoreTests::armouredContainer(std::ostream &output){
+/***********************************************************************
+* Round trips an armoured container, then checks that armour which has been cut short,
+* has lost its end line, has characters which are not base64 or holds a container for a
+* different key is rejected.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    testKey key;
+    testKey otherKey;
+    CoreTests::generateKey(TEST_KEY_SIZE, key);
+    CoreTests::generateKey(TEST_KEY_SIZE, otherKey);
+    std::string plaintext = CoreTests::randomBytes(5000, 2);
+    std::string armour;
+    std::string decrypted;
+    if(CoreTests::check(output, "armoured container encrypt", CoreTests::encrypt(key, plaintext, true, 0, armour)) != 0){
+        return 1;
+    }
+    failures += CoreTests::check(output, "armoured container round trip",
+                                 CiphertextContainer::isArmoured(armour) == true && CoreTests::decrypt(key, armour, decrypted) == true
+                                 && decrypted == plaintext);
+
+    size_t endLine = armour.rfind("-----END");
+    size_t bodyStart = armour.find('\n') + 1;
+    failures += CoreTests::check(output, "armoured container without an end line",
+                                 endLine != std::string::npos && CoreTests::decrypt(key, armour.substr(0, endLine), decrypted) == false);
+    failures += CoreTests::check(output, "armoured container cut in half",
+                                 CoreTests::decrypt(key, armour.substr(0, armour.size() / 2), decrypted) == false);
+    std::string shortBody = armour;
+    shortBody.erase(endLine - 70, 64);
+    failures += CoreTests::check(output, "armoured container missing a line", CoreTests::decrypt(key, shortBody, decrypted) == false);
+    std::string badCharacter = armour;
+    badCharacter[bodyStart + 10] = '*';
+    failures += CoreTests::check(output, "armoured container with a character which is not base64",
+                                 CoreTests::decrypt(key, badCharacter, decrypted) == false);
+
+    bool differentKey = false;
+    failures += CoreTests::check(output, "armoured container for a different key",
+                                 CoreTests::decrypt(otherKey, armour, decrypted, &differentKey) == false && differentKey == true);
+    return failures;
+}
+
+int CoreTests::hybridContainer(std::ostream &output, unsigned int cipher){
+/***********************************************************************
+* Round trips a HYBRID_VERSION container of three chunks, the last one short, then checks
+* that changing a tag, changing the final chunk, dropping the final chunk (so a truncated file
+* can't pass as a shorter one), cutting the file short or changing the number of chunks in the
+* header all make the decryption fail.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+* @ cipher: The HybridEngine cipher the payload is encrypted with.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    std::string name = (cipher == HybridEngine::AES_GCM) ? "AES-GCM" : "ChaCha20-Poly1305";
+    testKey key;
+    testKey otherKey;
+    CoreTests::generateKey(TEST_KEY_SIZE, key);
+    CoreTests::generateKey(TEST_KEY_SIZE, otherKey);
+    size_t finalChunkSize = 1000;
+    std::string plaintext = CoreTests::randomBytes(2 * HybridEngine::CHUNK_SIZE + finalChunkSize, 3);
+    std::string container;
+    std::string decrypted;
+    if(CoreTests::check(output, name + " container encrypt", CoreTests::encrypt(key, plaintext, false, cipher, container)) != 0){
+        return 1;
+    }
+    failures += CoreTests::check(output, name + " container round trip",
+                                 CoreTests::decrypt(key, container, decrypted) == true && decrypted == plaintext);
+    std::string armour;
+    failures += CoreTests::check(output, name + " armoured container round trip",
+                                 CoreTests::encrypt(key, plaintext, true, cipher, armour) == true
+                                 && CoreTests::decrypt(key, armour, decrypted) == true && decrypted == plaintext);
+
+    size_t encryptedBlockSize = (mpz_sizeinbase(key.modulus.get_mpz_t(), 2) + 7) / 8;
+    size_t firstChunkStart = CiphertextContainer::HEADER_SIZE + encryptedBlockSize;
+    size_t finalChunkStart = container.size() - finalChunkSize - HybridEngine::TAG_SIZE;
+    std::string changedTag = container;
+    changedTag[container.size() - 1] ^= 0x01;
+    failures += CoreTests::check(output, name + " container with a changed final tag", CoreTests::decrypt(key, changedTag, decrypted) == false);
+    changedTag = container;
+    changedTag[firstChunkStart + HybridEngine::CHUNK_SIZE] ^= 0x01;
+    failures += CoreTests::check(output, name + " container with a changed first tag", CoreTests::decrypt(key, changedTag, decrypted) == false);
+    std::string changedChunk = container;
+    changedChunk[finalChunkStart + finalChunkSize / 2] ^= 0x01;
+    failures += CoreTests::check(output, name + " container with a changed final chunk", CoreTests::decrypt(key, changedChunk, decrypted) == false);
+    std::string changedSecret = container;
+    changedSecret[CiphertextContainer::HEADER_SIZE + encryptedBlockSize / 2] ^= 0x01;
+    failures += CoreTests::check(output, name + " container with a changed secret", CoreTests::decrypt(key, changedSecret, decrypted) == false);
+
+    failures += CoreTests::check(output, name + " container without its final chunk",
+                                 CoreTests::decrypt(key, container.substr(0, finalChunkStart), decrypted) == false);
+    failures += CoreTests::check(output, name + " container missing a byte",
+                                 CoreTests::decrypt(key, container.substr(0, container.size() - 1), decrypted) == false);
+    failures += CoreTests::check(output, name + " container without its tag",
+                                 CoreTests::decrypt(key, container.substr(0, container.size() - HybridEngine::TAG_SIZE), decrypted) == false);
+    failures += CoreTests::check(output, name + " container with only the secret",
+                                 CoreTests::decrypt(key, container.substr(0, firstChunkStart), decrypted) == false);
+
+    // Claiming one chunk fewer turns the second chunk into the final one, which its nonce does not match.
+    std::string fewerChunks = container;
+    fewerChunks[CiphertextContainer::HEADER_SIZE - 1]--;
+    failures += CoreTests::check(output, name + " container counting too few chunks",
+                                 CoreTests::decrypt(key, fewerChunks.substr(0, finalChunkStart), decrypted) == false);
+    std::string moreChunks = container;
+    moreChunks[CiphertextContainer::HEADER_SIZE - 1]++;
+    failures += CoreTests::check(output, name + " container counting too many chunks", CoreTests::decrypt(key, moreChunks, decrypted) == false);
+
+    bool differentKey = false;
+    failures += CoreTests::check(output, name + " container for a different key",
+                                 CoreTests::decrypt(otherKey, container, decrypted, &differentKey) == false && differentKey == true);
+    return failures;
+}
+
+int CoreTests::exponentiation(std::ostream &output){
+/***********************************************************************
+* Checks ExponentiationContext against mpz_powm for odd moduli of each size in
+* KERNEL_MODULUS_SIZES, with e = 65537 (the Fermat path), a small exponent and full and
+* half size exponents (like d, dP and dQ). The bases include the edge cases 0, 1, n - 1,
+* n and values well above n, as the CRT contexts are given ciphertexts larger than their prime.
+* Each base is checked on its own with exponentiate(), and all of them together with
+* exponentiateBatch(), which uses the multi-buffer kernel when the processor has it.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    int failures = 0;
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(12345);
+    for(int sizeOfModulus : KERNEL_MODULUS_SIZES){
+        mpz_class modulus = random.get_z_bits(sizeOfModulus);
+        mpz_setbit(modulus.get_mpz_t(), sizeOfModulus - 1);
+        mpz_setbit(modulus.get_mpz_t(), 0);
+
+        std::vector<mpz_class> exponents;
+        exponents.push_back(ExponentiationContext::FERMAT_EXPONENT);
+        exponents.push_back(3);
+        exponents.push_back(random.get_z_bits(sizeOfModulus));
+        exponents.push_back(random.get_z_bits(sizeOfModulus / 2));
+
+        std::vector<mpz_class> bases;
+        bases.push_back(0);
+        bases.push_back(1);
+        bases.push_back(modulus - 1);
+        bases.push_back(modulus);
+        bases.push_back(modulus + 1);
+        bases.push_back(random.get_z_bits(2 * sizeOfModulus) + modulus);
+        while(bases.size() < 11){
+            bases.push_back(random.get_z_range(modulus));
+        }
+
+        for(unsigned int i = 0; i < exponents.size(); i++){
+            ExponentiationContext context(modulus.get_mpz_t(), exponents[i].get_mpz_t());
+            std::vector<mp_limb_t> scratch(context.getScratchSize());
+            std::vector<mpz_class> expected(bases.size());
+            std::vector<mpz_class> results(bases.size());
+            std::vector<mpz_srcptr> basePointers(bases.size());
+            std::vector<mpz_ptr> resultPointers(bases.size());
+            bool singleMatches = true;
+            for(unsigned int j = 0; j < bases.size(); j++){
+                mpz_powm(expected[j].get_mpz_t(), bases[j].get_mpz_t(), exponents[i].get_mpz_t(), modulus.get_mpz_t());
+                context.exponentiate(results[j].get_mpz_t(), bases[j].get_mpz_t(), scratch);
+                singleMatches = singleMatches && results[j] == expected[j];
+                basePointers[j] = bases[j].get_mpz_t();
+                resultPointers[j] = results[j].get_mpz_t();
+                results[j] = 0;
+            }
+            // 11 bases is one full group of MultiBufferModExp::LANES and a partial one.
+            context.exponentiateBatch(resultPointers.data(), basePointers.data(), static_cast<int>(bases.size()), scratch);
+            bool batchMatches = true;
+            for(unsigned int j = 0; j < bases.size(); j++){
+                batchMatches = batchMatches && results[j] == expected[j];
+            }
+            std::string name = "exponentiation " + std::to_string(sizeOfModulus) + " bits, exponent " + std::to_string(i);
+            failures += CoreTests::check(output, name + ", exponentiate", singleMatches);
+            failures += CoreTests::check(output, name + ", exponentiateBatch", batchMatches);
+        }
+    }
+    return failures;
+}
+int CoreTests::multiBuffer(std::ostream &output){
+/***********************************************************************
+* Checks MultiBufferModExp on its own against mpz_powm, with every number of lanes from
+* 1 to LANES and the same edge case bases as exponentiation(). Skipped (and passed) when
+* the processor does not have AVX-512 IFMA.
+*
+* Arguments:
+* @ output: The stream the PASS and FAIL lines are written to.
+*
+* Returns:
+* @ failures: The number of checks that failed.
+***********************************************************************/
+    if(MultiBufferModExp::isSupported() == false){
+        output << "SKIP multi-buffer kernel, not supported by this processor (needs AVX-512 IFMA)" << std::endl;
+        return 0;
+    }
+    int failures = 0;
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(54321);
+    for(int sizeOfModulus : KERNEL_MODULUS_SIZES){
+        mpz_class modulus = random.get_z_bits(sizeOfModulus);
+        mpz_setbit(modulus.get_mpz_t(), sizeOfModulus - 1);
+        mpz_setbit(modulus.get_mpz_t(), 0);
+        mpz_class exponent = random.get_z_bits(sizeOfModulus);
+        MultiBufferModExp multiBuffer;
+        multiBuffer.setModulus(modulus.get_mpz_t());
+        std::vector<mp_limb_t> scratch(multiBuffer.getScratchSize(exponent.get_mpz_t()));
+
+        mpz_class bases[MultiBufferModExp::LANES] = {0, 1, modulus - 1, modulus, modulus + 1, random.get_z_bits(2 * sizeOfModulus) + modulus,
+                                                     random.get_z_range(modulus), random.get_z_range(modulus)};
+        mpz_class results[MultiBufferModExp::LANES];
+        mpz_srcptr basePointers[MultiBufferModExp::LANES];
+        mpz_ptr resultPointers[MultiBufferModExp::LANES];
+        for(int i = 0; i < MultiBufferModExp::LANES; i++){
+            basePointers[i] = bases[i].get_mpz_t();
+            resultPointers[i] = results[i].get_mpz_t();
+        }
+
+        bool matches = true;
+        mpz_class expected;
+        for(int count = 1; count <= MultiBufferModExp::LANES; count++){
+            multiBuffer.exponentiate(resultPointers, basePointers, count, exponent.get_mpz_t(), scratch);
+            for(int i = 0; i < count; i++){
+                mpz_powm(expected.get_mpz_t(), bases[i].get_mpz_t(), exponent.get_mpz_t(), modulus.get_mpz_t());
+                matches = matches && results[i] == expected;
+            }
+        }
+        failures += CoreTests::check(output, "multi-buffer kernel " + std::to_string(sizeOfModulus) + " bits", matches);
+    }
+    return failures;
+}
+
+int CoreTests::check(std::ostream &output, const std::string &name, bool passed){
+/***********************************************************************
+* Writes one PASS or FAIL line to output.
+*
+* Arguments:
+* @ output: The stream the line is written to.
+* @ name: What was checked.
+* @ passed: Whether the check passed.
+*
+* Returns:
+*  0: If the check passed.
+*  1: If the check failed, so the result can be added onto a count of failures.
+***********************************************************************/
+    output << (passed == true ? "PASS " : "FAIL ") << name << std::endl;
+    return (passed == true) ? 0 : 1;
+}
+
+void CoreTests::generateKey(int sizeOfKey, testKey &key){
+/***********************************************************************
+* Generates a key with e = 65537 and works out the CRT values, the same way as the benchmark.
+*
+* Arguments:
+* @ sizeOfKey: The size of the modulus in bits.
+* @ key: The structure the key is written to.
+***********************************************************************/
+    mpz_class phi;
+    key.publicExponent = 65537;
+    int sizeOfPrimes = sizeOfKey / 2;
+    PrimeSearch primeSearch(sizeOfPrimes, PrimalityTester::getNumberOfChecks(sizeOfPrimes, true, false), 0, true);
+    do{
+        primeSearch.findPrimePair(key.prime1.get_mpz_t(), key.prime2.get_mpz_t());
+        phi = (key.prime1 - 1) * (key.prime2 - 1);
+    } while(mpz_invert(key.privateExponent.get_mpz_t(), key.publicExponent.get_mpz_t(), phi.get_mpz_t()) == 0);
+    key.modulus = key.prime1 * key.prime2;
+    key.exponent1 = key.privateExponent % (key.prime1 - 1);
+    key.exponent2 = key.privateExponent % (key.prime2 - 1);
+    mpz_invert(key.coefficient.get_mpz_t(), key.prime2.get_mpz_t(), key.prime1.get_mpz_t());
+}
+
+bool CoreTests::encrypt(const testKey &key, const std::string &plaintext, bool armoured, unsigned int cipher, std::string &container){
+/***********************************************************************
+* Encrypts the plaintext into a container with an EncryptionStream.
+*
+* Arguments:
+* @ key: The key to encrypt for.
+* @ plaintext: The data to encrypt.
+* @ armoured: Whether the container is written as ASCII armour.
+* @ cipher: The HybridEngine cipher, or 0 for a block container.
+* @ container: The string the container is written to.
+*
+* Returns:
+*  True: If the plaintext was encrypted.
+*  False: Otherwise.
+***********************************************************************/
+    EncryptionStream encryptionStream(key.modulus.get_mpz_t(), key.publicExponent.get_mpz_t());
+    std::istringstream input(plaintext);
+    std::ostringstream containerStream;
+    bool encrypted = (cipher == 0)
+            ? encryptionStream.encrypt(input, plaintext.size(), containerStream, armoured)
+            : encryptionStream.encryptHybrid(input, plaintext.size(), containerStream, armoured, cipher);
+    container = containerStream.str();
+    return encrypted;
+}
+
+bool CoreTests::decrypt(const testKey &key, const std::string &container, std::string &plaintext, bool *differentKey){
+/***********************************************************************
+* Decrypts a container with a DecryptionStream, using the CRT values.
+*
+* Arguments:
+* @ key: The key to decrypt with.
+* @ container: The binary or armoured container.
+* @ plaintext: The string the decrypted data is written to.
+* @ differentKey: Set to whether the container was for a different key, or nullptr.
+*
+* Returns:
+*  True: If the container was decrypted.
+*  False: If the container was rejected.
+***********************************************************************/
+    DecryptionStream decryptionStream(key.modulus.get_mpz_t(), key.publicExponent.get_mpz_t(), key.privateExponent.get_mpz_t(),
+                                      key.prime1.get_mpz_t(), key.prime2.get_mpz_t(), key.exponent1.get_mpz_t(),
+                                      key.exponent2.get_mpz_t(), key.coefficient.get_mpz_t());
+    std::istringstream input(container);
+    std::ostringstream plaintextStream;
+    bool decrypted = decryptionStream.decrypt(input, plaintextStream);
+    plaintext = plaintextStream.str();
+    if(differentKey != nullptr){
+        *differentKey = decryptionStream.wasEncryptedForDifferentKey();
+    }
+    return decrypted;
+}
+
+std::string CoreTests::randomBytes(size_t numberOfBytes, unsigned int seed){
+/***********************************************************************
+* Arguments:
+* @ numberOfBytes: The number of bytes to make.
+* @ seed: The seed, so every run uses the same data.
+*
+* Returns:
+* @ bytes: numberOfBytes pseudorandom bytes.
+***********************************************************************/
+    std::string bytes(numberOfBytes, '\0');
+    std::mt19937 generator(seed);
+    for(size_t i = 0; i < bytes.size(); i++){
+        bytes[i] = static_cast<char>(generator() & 0xFF);
+    }
+    return bytes;
+}
+
+bool CoreTests::waitForPrimes(PrimePool &primePool, int sizeOfPrimes, int numberOfPrimes){
+/***********************************************************************
+* Waits up to a minute for the PrimePool's workers to fill a size.
+*
+* Arguments:
+* @ primePool: The started PrimePool.
+* @ sizeOfPrimes: The size of the primes in bits.
+* @ numberOfPrimes: The number of primes to wait for.
+*
+* Returns:
+*  True: If the pool holds at least numberOfPrimes primes of the size.
+*  False: If it took too long.
+***********************************************************************/
+    std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while(primePool.getNumberOfPrimes(sizeOfPrimes) < numberOfPrimes){
+        if(std::chrono::steady_clock::now() > giveUp){
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+std::string CoreTests::readFile(const std::string &filepath){
+/***********************************************************************
+* Arguments:
+* @ filepath: The file to read.
+*
+* Returns:
+* @ contents: The whole file, or "" if it could not be opened.
+***********************************************************************/
+    std::ifstream file(filepath, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
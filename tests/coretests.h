@@ -0,0 +1,44 @@
+#ifndef CORETESTS_H
+#define CORETESTS_H
+
+#include <gmpxx.h>
+#include <ostream>
+#include <string>
+
+class PrimePool;
+
+struct testKey{
+    mpz_class modulus; // n = p * q.
+    mpz_class publicExponent; // e, always 65537.
+    mpz_class privateExponent; // d = e^-1 mod (p - 1)(q - 1).
+    mpz_class prime1; // p.
+    mpz_class prime2; // q.
+    mpz_class exponent1; // d mod (p - 1).
+    mpz_class exponent2; // d mod (q - 1).
+    mpz_class coefficient; // q^-1 mod p.
+};
+
+class CoreTests
+{
+public:
+    static int primeSearch(std::ostream &output);
+    static int primePool(std::ostream &output);
+    static int ciphertextContainer(std::ostream &output);
+    static int encryptionStream(std::ostream &output);
+    static int blockContainer(std::ostream &output);
+    static int armouredContainer(std::ostream &output);
+    static int hybridContainer(std::ostream &output, unsigned int cipher);
+    static int exponentiation(std::ostream &output);
+    static int multiBuffer(std::ostream &output);
+
+private:
+    static int check(std::ostream &output, const std::string &name, bool passed);
+    static void generateKey(int sizeOfKey, testKey &key);
+    static bool encrypt(const testKey &key, const std::string &plaintext, bool armoured, unsigned int cipher, std::string &container);
+    static bool decrypt(const testKey &key, const std::string &container, std::string &plaintext, bool *differentKey = nullptr);
+    static std::string randomBytes(size_t numberOfBytes, unsigned int seed);
+    static bool waitForPrimes(PrimePool &primePool, int sizeOfPrimes, int numberOfPrimes);
+    static std::string readFile(const std::string &filepath);
+};
+
+#endif // CORETESTS_H
@@ -0,0 +1,29 @@
+#include "coretests.h"
+#include "hybridengine.h"
+
+#include <iostream>
+#include <string>
+
+int main(){
+/***********************************************************************
+* Runs every test in CoreTests and writes a PASS or FAIL line for each check.
+*
+* Returns:
+*  0: If every check passed.
+*  1: If any check failed.
+***********************************************************************/
+    int failures = 0;
+    failures += CoreTests::primeSearch(std::cout);
+    failures += CoreTests::primePool(std::cout);
+    failures += CoreTests::ciphertextContainer(std::cout);
+    failures += CoreTests::encryptionStream(std::cout);
+    failures += CoreTests::blockContainer(std::cout);
+    failures += CoreTests::armouredContainer(std::cout);
+    failures += CoreTests::hybridContainer(std::cout, HybridEngine::AES_GCM);
+    failures += CoreTests::hybridContainer(std::cout, HybridEngine::CHACHA20_POLY1305);
+    failures += CoreTests::exponentiation(std::cout);
+    failures += CoreTests::multiBuffer(std::cout);
+
+    std::cout << std::endl << (failures == 0 ? "All tests passed." : std::to_string(failures) + " test(s) failed.") << std::endl;
+    return (failures == 0) ? 0 : 1;
+}
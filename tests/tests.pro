@@ -0,0 +1,33 @@
+QT -= gui core
+
+# testcase adds a check target, so "make check" builds and runs the tests.
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+TARGET = tests
+
+INCLUDEPATH += $$PWD/.. $$PWD/../rsacore
+DEPENDPATH += $$PWD/../rsacore
+
+SOURCES += \
+    main.cpp \
+    coretests.cpp
+
+HEADERS += \
+    coretests.h
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../rsacore/release/ -lrsacore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../rsacore/debug/ -lrsacore
+else:unix: LIBS += -L$$OUT_PWD/../rsacore/ -lrsacore
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/release/librsacore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/debug/librsacore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/release/rsacore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../rsacore/debug/rsacore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../rsacore/librsacore.a
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../libs/ -lgmp -lcryptopp
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../libs/ -lgmpd -lcryptoppd
+else:unix: LIBS += -L$$PWD/../libs/ -lgmp -lcryptopp
+
+INCLUDEPATH += $$PWD/../libs
+DEPENDPATH += $$PWD/../libs